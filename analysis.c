@@ -0,0 +1,346 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "analysis.h"
+#include "platform.h"
+
+#define ANALYSIS_OUTPUT_SIZE 2048   // Largo máximo de una línea de resultado
+
+// Posición en espera de ser analizada o escrita. Los slots forman un buffer circular de tamaño 'window'
+typedef struct {
+    char fen[ANALYSIS_MAX_LINE];
+    char id[ANALYSIS_MAX_ID];
+    bool valid;                     // false si la línea no es un EPD/FEN válido
+    bool done;                      // El resultado está listo para escribirse
+    uint64_t nodes;
+    char output[ANALYSIS_OUTPUT_SIZE];
+} analysis_slot_t;
+
+// Estado compartido entre el lector (hilo principal) y los hilos de búsqueda
+typedef struct {
+    const analysis_options_t *options;
+    FILE *out;
+    analysis_slot_t *slots;
+    long window;
+    long next_input;                // Posiciones leídas
+    long next_job;                  // Posiciones entregadas a algún hilo
+    long next_output;               // Posiciones escritas (los resultados salen en orden de entrada)
+    bool input_done;
+    int workers_pending;            // Hilos creados que todavía no terminaron de reservar su memoria
+    int workers_ready;              // Hilos que pudieron reservar su memoria y analizan posiciones
+    uint64_t total_nodes;
+    evalcache_t eval_cache;         // Compartida por todos los hilos (todos evalúan con los mismos parámetros)
+    pthread_mutex_t lock;
+    pthread_cond_t job_ready;       // Hay posiciones sin analizar (o la lectura terminó)
+    pthread_cond_t slot_free;       // Hay espacio para leer más posiciones (o un hilo terminó de iniciarse)
+} analysis_t;
+
+void analysis_default_options(analysis_options_t *options) {
+    memset(options, 0, sizeof(analysis_options_t));
+    options->input_path = NULL;
+    options->output_path = NULL;
+    options->limits.depth = 6;
+    options->threads = 0;
+    options->hash_mb = TT_DEFAULT_MB;
+}
+
+// Verifica que el token sea un entero no negativo
+static bool is_number(const char *token, int len) {
+    if (len == 0) return false;
+    for (int i = 0; i < len; i++) {
+        if (!isdigit((unsigned char)token[i])) return false;
+    }
+    return true;
+}
+
+/**
+ * Separa una línea EPD o FEN en la posición y el identificador (operación id "...").
+ * Un EPD solo tiene los primeros 4 campos de un FEN; si la línea trae los contadores de jugadas también se usan.
+ * @param line: línea de entrada (ej: 'r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - bm Bb5; id "test.1";').
+ * @param fen: buffer de ANALYSIS_MAX_LINE caracteres que recibe el FEN.
+ * @param id: buffer de ANALYSIS_MAX_ID caracteres que recibe el id (vacío si no existe).
+ * @return false si la línea no tiene los 4 campos obligatorios.
+ */
+bool analysis_parse_epd(const char *line, char *fen, char *id) {
+    const char *p = line;
+    int fields = 0;
+    int len = 0;
+    fen[0] = '\0';
+    id[0] = '\0';
+
+    // Campos del FEN: posición, turno, enroques, en passant y (opcionalmente) los dos contadores
+    while (fields < 6) {
+        while (*p == ' ' || *p == '\t') p++;
+        const char *start = p;
+        while (*p && !isspace((unsigned char)*p) && *p != ';') p++;
+        int token_len = (int)(p - start);
+        if (token_len == 0) break;
+
+        if (fields == 4) {
+            // Los contadores solo se aceptan si ambos son números (si no, son operaciones EPD)
+            const char *next = p;
+            while (*next == ' ' || *next == '\t') next++;
+            const char *next_end = next;
+            while (*next_end && !isspace((unsigned char)*next_end) && *next_end != ';') next_end++;
+            if (!is_number(start, token_len) || !is_number(next, (int)(next_end - next))) {
+                p = start;
+                break;
+            }
+        }
+
+        if (len + token_len + 2 >= ANALYSIS_MAX_LINE) return false;
+        if (fields > 0) fen[len++] = ' ';
+        memcpy(fen + len, start, token_len);
+        len += token_len;
+        fen[len] = '\0';
+        fields++;
+    }
+    if (fields < 4 || strchr(fen, '/') == NULL) return false;
+
+    // Operación id "..." (el resto de las operaciones se ignora)
+    const char *op = strstr(p, "id \"");
+    if (op) {
+        op += 4;
+        int n = 0;
+        while (*op && *op != '"' && n < ANALYSIS_MAX_ID - 1) id[n++] = *op++;
+        id[n] = '\0';
+    }
+    return true;
+}
+
+// Una posición es analizable si hay exactamente un rey por bando y el rival no está en jaque
+static bool position_is_valid(gamestate_t *game) {
+    int kings[2] = {0, 0};
+    for (int sq = 0; sq < BOARD_SIZE; sq++) {
+        if (!IS_VALID_SQUARE(sq)) continue;
+        int piece = game->board[sq];
+        if (piece != EMPTY && PIECE_TYPE(piece) == KING) kings[COLOR(piece)]++;
+    }
+    if (kings[WHITE] != 1 || kings[BLACK] != 1) return false;
+    return !is_in_check(game, game->to_move == WHITE ? BLACK : WHITE);
+}
+
+// Analiza la posición de un slot y deja la línea de resultado en slot->output
+static void analyze_slot(analysis_t *analysis, search_context_t *ctx, tt_t *tt, pool_t *pool, analysis_slot_t *slot) {
+    char *out = slot->output;
+    size_t size = ANALYSIS_OUTPUT_SIZE;
+    int n = snprintf(out, size, "%s ;", slot->fen);
+    if (slot->id[0]) n += snprintf(out + n, size - n, " id \"%s\";", slot->id);
+    slot->nodes = 0;
+
+    gamestate_t game;
+    memset(&game, 0, sizeof(gamestate_t));
+    game.en_passant_square = -1;
+    if (!slot->valid || init_board_fen(&game, slot->fen) != 0 || !position_is_valid(&game)) {
+        snprintf(out + n, size - n, " error \"posición inválida\";\n");
+        return;
+    }
+
+    search_result_t result;
+    search_init(ctx, &analysis->options->limits, NULL);
+    ctx->tt = tt;
+    ctx->pool = pool;
+    if (analysis->eval_cache.entries) ctx->eval_cache = &analysis->eval_cache;
+    if (!search_run(ctx, &game, &result)) {
+        // Sin movimientos legales: la partida ya terminó
+        bool mated = is_in_check(&game, game.to_move);
+        snprintf(out + n, size - n, " bestmove (none); score %s; depth 0; nodes 0; time 0;\n", mated ? "mate 0" : "cp 0");
+        return;
+    }
+
+    char move_str[6];
+    char score_str[16];
+    move_to_string(&result.best_move, move_str);
+    search_score_to_string(result.score, score_str);
+    n += snprintf(out + n, size - n, " bestmove %s; score %s; depth %d; nodes %" PRIu64 "; time %" PRId64 "; pv",
+                  move_str, score_str, result.depth, result.nodes, result.time_ms);
+    for (int i = 0; i < result.pv_length && n < (int)size - 8; i++) {
+        move_to_string(&result.pv[i], move_str);
+        n += snprintf(out + n, size - n, " %s", move_str);
+    }
+    snprintf(out + n, size - n, ";\n");
+    slot->nodes = result.nodes;
+}
+
+// Escribe los resultados terminados que siguen en el orden de entrada (se llama con el lock tomado)
+static void flush_results(analysis_t *analysis) {
+    bool wrote = false;
+    while (analysis->next_output < analysis->next_input) {
+        analysis_slot_t *slot = &analysis->slots[analysis->next_output % analysis->window];
+        if (!slot->done) break;
+        fputs(slot->output, analysis->out);
+        analysis->total_nodes += slot->nodes;
+        slot->done = false;
+        analysis->next_output++;
+        wrote = true;
+    }
+    if (wrote) {
+        fflush(analysis->out);
+        pthread_cond_signal(&analysis->slot_free);
+    }
+}
+
+// Hilo de búsqueda: toma posiciones en orden, las analiza y escribe los resultados que ya estén en orden
+static void* analysis_worker_main(void *arg) {
+    analysis_t *analysis = arg;
+    // Cada hilo tiene su propia tabla de transposición y su pool de memoria para la búsqueda,
+    // que se reutilizan entre posiciones
+    search_context_t *ctx = malloc(sizeof(search_context_t));
+    tt_t tt;
+    bool ready = ctx && tt_init(&tt, analysis->options->hash_mb);
+    // El lector espera a que todos los hilos se inicien, para no quedarse esperando si ninguno puede analizar
+    pthread_mutex_lock(&analysis->lock);
+    analysis->workers_pending--;
+    if (ready) analysis->workers_ready++;
+    pthread_cond_broadcast(&analysis->slot_free);
+    pthread_mutex_unlock(&analysis->lock);
+    if (!ready) {
+        free(ctx);
+        return NULL;
+    }
+    pool_t pool;
+    pool_init(&pool, ARENA_CHUNK_SIZE, POOL_BLOCKS_PER_CHUNK);
+
+    while (true) {
+        pthread_mutex_lock(&analysis->lock);
+        while (analysis->next_job == analysis->next_input && !analysis->input_done) {
+            pthread_cond_wait(&analysis->job_ready, &analysis->lock);
+        }
+        if (analysis->next_job == analysis->next_input) {
+            pthread_mutex_unlock(&analysis->lock);
+            break;
+        }
+        analysis_slot_t *slot = &analysis->slots[analysis->next_job % analysis->window];
+        analysis->next_job++;
+        pthread_mutex_unlock(&analysis->lock);
+
+        analyze_slot(analysis, ctx, &tt, &pool, slot);
+
+        pthread_mutex_lock(&analysis->lock);
+        slot->done = true;
+        flush_results(analysis);
+        pthread_mutex_unlock(&analysis->lock);
+    }
+
+    pool_destroy(&pool);
+    tt_free(&tt);
+    free(ctx);
+    return NULL;
+}
+
+/**
+ * Analiza todas las posiciones de un archivo EPD/FEN y escribe una línea de resultado por posición.
+ * Solo se mantienen en memoria 4 posiciones por hilo, sin importar el tamaño del archivo.
+ * @param options: archivo de entrada, salida, límites de búsqueda y cantidad de hilos.
+ * @return true si el archivo se procesó completo.
+ */
+bool analysis_run(const analysis_options_t *options) {
+    bool use_stdin = strcmp(options->input_path, "-") == 0;
+    FILE *in = use_stdin ? stdin : fopen(options->input_path, "r");
+    if (!in) {
+        perror("[ ANALYSIS ] Error al abrir el archivo de entrada");
+        return false;
+    }
+    FILE *out = options->output_path ? fopen(options->output_path, "w") : stdout;
+    if (!out) {
+        perror("[ ANALYSIS ] Error al abrir el archivo de salida");
+        if (!use_stdin) fclose(in);
+        return false;
+    }
+
+    int threads = options->threads > 0 ? options->threads : platform_cpu_count();
+    analysis_t analysis;
+    memset(&analysis, 0, sizeof(analysis_t));
+    analysis.options = options;
+    analysis.out = out;
+    analysis.window = 4L * threads;
+    analysis.slots = calloc(analysis.window, sizeof(analysis_slot_t));
+    pthread_t *thread_ids = malloc(threads * sizeof(pthread_t));
+    if (!analysis.slots || !thread_ids) {
+        free(analysis.slots);
+        free(thread_ids);
+        if (!use_stdin) fclose(in);
+        if (options->output_path) fclose(out);
+        return false;
+    }
+    // Sin memoria para la caché de evaluaciones se analiza igual, solo que sin caché
+    evalcache_init(&analysis.eval_cache, EVAL_CACHE_DEFAULT_MB);
+    pthread_mutex_init(&analysis.lock, NULL);
+    pthread_cond_init(&analysis.job_ready, NULL);
+    pthread_cond_init(&analysis.slot_free, NULL);
+
+    int64_t start = platform_time_ms();
+    int started = 0;
+    analysis.workers_pending = threads;
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&thread_ids[started], NULL, analysis_worker_main, &analysis) == 0) started++;
+    }
+    pthread_mutex_lock(&analysis.lock);
+    analysis.workers_pending -= threads - started;
+    while (analysis.workers_pending > 0) {
+        pthread_cond_wait(&analysis.slot_free, &analysis.lock);
+    }
+    bool can_analyze = analysis.workers_ready > 0;
+    pthread_mutex_unlock(&analysis.lock);
+    // Sin hilos que analicen, el lector se quedaría esperando un slot libre para siempre
+    if (!can_analyze) fprintf(stderr, "[ ANALYSIS ] No se pudo iniciar ningún hilo de análisis (falta memoria)\n");
+
+    char line[ANALYSIS_MAX_LINE];
+    while (can_analyze && fgets(line, sizeof(line), in)) {
+        size_t len = strlen(line);
+        // Línea más larga que el buffer: se descarta el resto
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n');
+        }
+        while (len > 0 && isspace((unsigned char)line[len - 1])) line[--len] = '\0';
+        char *text = line;
+        while (isspace((unsigned char)*text)) text++;
+        if (*text == '\0' || *text == '#') continue;
+
+        // Esperar a que haya un slot libre (el resultado más antiguo ya se escribió)
+        pthread_mutex_lock(&analysis.lock);
+        while (analysis.next_input - analysis.next_output >= analysis.window) {
+            pthread_cond_wait(&analysis.slot_free, &analysis.lock);
+        }
+        analysis_slot_t *slot = &analysis.slots[analysis.next_input % analysis.window];
+        pthread_mutex_unlock(&analysis.lock);
+
+        // Ningún hilo usa el slot hasta que se incremente next_input
+        slot->valid = analysis_parse_epd(text, slot->fen, slot->id);
+        if (!slot->valid) snprintf(slot->fen, sizeof(slot->fen), "%s", text);
+        slot->done = false;
+
+        pthread_mutex_lock(&analysis.lock);
+        analysis.next_input++;
+        pthread_cond_signal(&analysis.job_ready);
+        pthread_mutex_unlock(&analysis.lock);
+    }
+
+    pthread_mutex_lock(&analysis.lock);
+    analysis.input_done = true;
+    pthread_cond_broadcast(&analysis.job_ready);
+    pthread_mutex_unlock(&analysis.lock);
+
+    for (int t = 0; t < started; t++) {
+        pthread_join(thread_ids[t], NULL);
+    }
+    bool ok = can_analyze && analysis.next_output == analysis.next_input;
+
+    int64_t elapsed = platform_time_ms() - start;
+    double seconds = elapsed > 0 ? elapsed / 1000.0 : 0.001;
+    fprintf(stderr, "[ ANALYSIS ] Posiciones: %ld | Nodos: %" PRIu64 " | Tiempo: %.2f s | %.0f nodos/s | Hilos: %d\n",
+            analysis.next_output, analysis.total_nodes, seconds, analysis.total_nodes / seconds, threads);
+
+    pthread_mutex_destroy(&analysis.lock);
+    pthread_cond_destroy(&analysis.job_ready);
+    pthread_cond_destroy(&analysis.slot_free);
+    evalcache_free(&analysis.eval_cache);
+    free(analysis.slots);
+    free(thread_ids);
+    if (!use_stdin) fclose(in);
+    if (options->output_path) fclose(out);
+    return ok;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bot.h"
+
+// Análisis por lotes de posiciones en formato EPD o FEN (una posición por línea)
+// Las posiciones se leen de forma secuencial y se reparten entre varios hilos, cada uno con su
+// propio gamestate_t y contexto de búsqueda. Los resultados se escriben en el mismo orden de entrada,
+// una línea por posición:
+//   <fen> ; id "..."; bestmove e2e4; score cp 35; depth 6; nodes 123456; time 250; pv e2e4 e7e5 ...;
+
+#define ANALYSIS_MAX_LINE 1024      // Largo máximo de una línea del archivo de entrada
+#define ANALYSIS_MAX_ID 64          // Largo máximo del campo id de EPD
+
+typedef struct {
+    const char *input_path;         // Archivo EPD/FEN ("-" = entrada estándar)
+    const char *output_path;        // Archivo de salida (NULL = salida estándar)
+    search_limits_t limits;         // Límites de búsqueda por posición
+    int threads;                    // Hilos de búsqueda (0 = todos los núcleos)
+    size_t hash_mb;                 // Tamaño de la tabla de transposición de cada hilo
+} analysis_options_t;
+
+void analysis_default_options(analysis_options_t *options);
+bool analysis_parse_epd(const char *line, char *fen, char *id);
+bool analysis_run(const analysis_options_t *options);
@@ -0,0 +1,173 @@
+#include <stdlib.h>
+#include "arena.h"
+
+struct pool_chunk {
+    pool_chunk_t *next;
+};
+
+struct pool_free {
+    pool_free_t *next;
+};
+
+// Encabezado de cada bloque de una arena; los datos empiezan justo después (alineados)
+struct arena_chunk {
+    arena_chunk_t *next;
+    size_t capacity;
+    size_t offset;
+    bool pooled;                    // Viene del pool (se devuelve con pool_free) o de malloc
+};
+
+#define ALIGN_UP(n, a) (((n) + (a) - 1) & ~((size_t)(a) - 1))
+#define POOL_HEADER ALIGN_UP(sizeof(pool_chunk_t), ARENA_ALIGNMENT)
+#define ARENA_HEADER ALIGN_UP(sizeof(arena_chunk_t), ARENA_ALIGNMENT)
+
+static inline unsigned char* chunk_data(arena_chunk_t *chunk) {
+    return (unsigned char *)chunk + ARENA_HEADER;
+}
+
+/**
+ * Inicializa un pool vacío; la memoria se reserva recién en el primer pool_alloc.
+ * @param pool: pool a inicializar.
+ * @param block_size: tamaño de cada bloque (se redondea a ARENA_ALIGNMENT).
+ * @param blocks_per_chunk: bloques que se reservan con cada malloc.
+ * @return false si los parámetros no son válidos.
+ */
+bool pool_init(pool_t *pool, size_t block_size, int blocks_per_chunk) {
+    pool->block_size = ALIGN_UP(block_size < sizeof(pool_free_t) ? sizeof(pool_free_t) : block_size, ARENA_ALIGNMENT);
+    pool->blocks_per_chunk = blocks_per_chunk > 0 ? blocks_per_chunk : POOL_BLOCKS_PER_CHUNK;
+    pool->chunks = NULL;
+    pool->free_list = NULL;
+    pool->in_use = 0;
+    pool->peak_in_use = 0;
+    return block_size > 0;
+}
+
+void* pool_alloc(pool_t *pool) {
+    if (!pool->free_list) {
+        unsigned char *memory = malloc(POOL_HEADER + (size_t)pool->blocks_per_chunk * pool->block_size);
+        if (!memory) return NULL;
+        pool_chunk_t *chunk = (pool_chunk_t *)memory;
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        // Los bloques nuevos se encadenan en la lista libre
+        for (int i = pool->blocks_per_chunk - 1; i >= 0; i--) {
+            pool_free_t *block = (pool_free_t *)(memory + POOL_HEADER + (size_t)i * pool->block_size);
+            block->next = pool->free_list;
+            pool->free_list = block;
+        }
+    }
+
+    pool_free_t *block = pool->free_list;
+    pool->free_list = block->next;
+    pool->in_use++;
+    if (pool->in_use > pool->peak_in_use) pool->peak_in_use = pool->in_use;
+    return block;
+}
+
+void pool_free(pool_t *pool, void *block) {
+    if (!block) return;
+    pool_free_t *node = block;
+    node->next = pool->free_list;
+    pool->free_list = node;
+    pool->in_use--;
+}
+
+// Libera toda la memoria del pool (los bloques entregados dejan de ser válidos)
+void pool_destroy(pool_t *pool) {
+    while (pool->chunks) {
+        pool_chunk_t *next = pool->chunks->next;
+        free(pool->chunks);
+        pool->chunks = next;
+    }
+    pool->free_list = NULL;
+    pool->in_use = 0;
+}
+
+/**
+ * Inicializa una arena vacía.
+ * @param arena: arena a inicializar.
+ * @param pool: pool del que se sacan los bloques (NULL = se reservan con malloc). Sus bloques deben tener
+ *              espacio para el encabezado, por lo que conviene crearlo con block_size = ARENA_CHUNK_SIZE.
+ */
+void arena_init(arena_t *arena, pool_t *pool) {
+    arena->chunks = NULL;
+    arena->pool = pool;
+    arena->used = 0;
+    arena->peak = 0;
+}
+
+static arena_chunk_t* arena_new_chunk(arena_t *arena, size_t bytes) {
+    arena_chunk_t *chunk;
+    size_t pool_capacity = arena->pool ? arena->pool->block_size - ARENA_HEADER : 0;
+    if (arena->pool && bytes <= pool_capacity) {
+        chunk = pool_alloc(arena->pool);
+        if (!chunk) return NULL;
+        chunk->capacity = pool_capacity;
+        chunk->pooled = true;
+    } else {
+        // Sin pool, o una reserva más grande que un bloque: se pide directo a malloc
+        size_t capacity = bytes > ARENA_CHUNK_SIZE - ARENA_HEADER ? bytes : ARENA_CHUNK_SIZE - ARENA_HEADER;
+        chunk = malloc(ARENA_HEADER + capacity);
+        if (!chunk) return NULL;
+        chunk->capacity = capacity;
+        chunk->pooled = false;
+    }
+    chunk->offset = 0;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    return chunk;
+}
+
+/**
+ * Reserva memoria de la arena (alineada a ARENA_ALIGNMENT, sin inicializar). No se libera por separado:
+ * todo lo reservado se libera con arena_reset o arena_free.
+ * @return NULL si no hay memoria.
+ */
+void* arena_alloc(arena_t *arena, size_t bytes) {
+    bytes = ALIGN_UP(bytes, ARENA_ALIGNMENT);
+    arena_chunk_t *chunk = arena->chunks;
+    if (!chunk || chunk->capacity - chunk->offset < bytes) {
+        chunk = arena_new_chunk(arena, bytes);
+        if (!chunk) return NULL;
+    }
+
+    void *ptr = chunk_data(chunk) + chunk->offset;
+    chunk->offset += bytes;
+    arena->used += bytes;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    return ptr;
+}
+
+static void arena_release_chunk(arena_t *arena, arena_chunk_t *chunk) {
+    if (chunk->pooled) pool_free(arena->pool, chunk);
+    else free(chunk);
+}
+
+// Descarta todo lo reservado, pero conserva el primer bloque para las siguientes reservas (peak no cambia)
+void arena_reset(arena_t *arena) {
+    arena_chunk_t *chunk = arena->chunks;
+    arena_chunk_t *keep = NULL;
+    while (chunk) {
+        arena_chunk_t *next = chunk->next;
+        // El último de la lista es el más antiguo; los anteriores se devuelven
+        if (next == NULL) keep = chunk;
+        else arena_release_chunk(arena, chunk);
+        chunk = next;
+    }
+    if (keep) {
+        keep->offset = 0;
+        keep->next = NULL;
+    }
+    arena->chunks = keep;
+    arena->used = 0;
+}
+
+// Devuelve todos los bloques (al pool o al sistema)
+void arena_free(arena_t *arena) {
+    while (arena->chunks) {
+        arena_chunk_t *next = arena->chunks->next;
+        arena_release_chunk(arena, arena->chunks);
+        arena->chunks = next;
+    }
+    arena->used = 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+// Memoria temporal sin malloc/free en cada uso
+// - arena_t: reserva secuencial ("bump allocator") en bloques grandes; todo se libera de una vez al terminar.
+//   La búsqueda usa una por hilo para sus datos por ply (listas de jugadas, puntajes, variantes, undo).
+// - pool_t: bloques de tamaño fijo que se reciclan en una lista libre. Cada sesión de juego (ej: un hilo de match.c)
+//   tiene su pool, del que sus arenas sacan los bloques, así las búsquedas consecutivas no vuelven a pedir memoria
+//   y varias partidas simultáneas no compiten por el malloc del sistema.
+// Ninguna de las dos es thread-safe: cada hilo debe usar las suyas.
+
+#define ARENA_CHUNK_SIZE (64 * 1024)    // Tamaño de los bloques de una arena (y de los bloques de su pool)
+#define ARENA_ALIGNMENT 16
+#define POOL_BLOCKS_PER_CHUNK 8         // Bloques que se reservan juntos cuando el pool se queda sin bloques libres
+
+typedef struct pool_chunk pool_chunk_t;
+typedef struct pool_free pool_free_t;
+
+typedef struct {
+    size_t block_size;
+    int blocks_per_chunk;
+    pool_chunk_t *chunks;           // Memoria reservada con malloc (se libera en pool_destroy)
+    pool_free_t *free_list;         // Bloques disponibles
+    size_t in_use;                  // Bloques entregados y no devueltos
+    size_t peak_in_use;
+} pool_t;
+
+typedef struct arena_chunk arena_chunk_t;
+
+typedef struct {
+    arena_chunk_t *chunks;          // Bloque actual primero
+    pool_t *pool;                   // De donde salen los bloques (NULL = malloc)
+    size_t used;                    // Bytes entregados desde el último reset
+    size_t peak;                    // Máximo de 'used' desde arena_init
+} arena_t;
+
+bool pool_init(pool_t *pool, size_t block_size, int blocks_per_chunk);
+void* pool_alloc(pool_t *pool);
+void pool_free(pool_t *pool, void *block);
+void pool_destroy(pool_t *pool);
+
+void arena_init(arena_t *arena, pool_t *pool);
+void* arena_alloc(arena_t *arena, size_t bytes);
+void arena_reset(arena_t *arena);
+void arena_free(arena_t *arena);
@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "bench.h"
+
+// Posiciones del benchmark: aperturas, medios juegos tácticos, finales y posiciones de prueba de perft
+static const char *bench_positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+    "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+    "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+    "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+    "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+    "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 0 1",
+    "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+    "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+    "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+    "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+    "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+    "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+    "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+    "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+    "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+    "8/8/8/8/8/6k1/6p1/6K1 w - - 0 1",
+    "7k/7P/6K1/8/3B4/8/8/8 b - - 0 1",
+    "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+    "rnbqk2r/ppppbppp/4pn2/8/2PP4/5NP1/PP2PP1P/RNBQKB1R b KQkq - 0 4",
+    "rnbqkb1r/ppp1pppp/5n2/3p4/3P4/5N2/PPP1PPPP/RNBQKB1R w KQkq - 2 3",
+    "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/2N2N2/PPPP1PPP/R1BQK2R w KQkq - 6 5",
+    "rnbqkbnr/pp1ppppp/8/2p5/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 2",
+    "rnbqkb1r/pppppp1p/5np1/8/2PP4/8/PP2PPPP/RNBQKBNR w KQkq - 0 3",
+    "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 9",
+    "rnbq1rk1/ppp1ppbp/3p1np1/8/2PPP3/2N2N2/PP3PPP/R1BQKB1R w KQ - 1 6",
+    "r1b2rk1/2q1bppp/p2ppn2/1p6/3BPP2/2N2B2/PPPQ2PP/2KR3R w - - 0 13",
+    "2kr3r/ppp2ppp/2n5/2b1p3/4P1b1/2NP1N2/PPP2PPP/R1B1KB1R w KQ - 0 9",
+    "2r3k1/pp3ppp/2n5/8/8/2N5/PP3PPP/2R3K1 w - - 0 1",
+    "8/5pk1/6p1/8/3R4/6P1/5PKP/3r4 w - - 0 40",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "8/8/8/3k4/8/3K4/3P4/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "4k3/8/8/8/8/8/8/4K2R w K - 0 1",
+};
+
+int bench_position_count(void) {
+    return (int)(sizeof(bench_positions) / sizeof(bench_positions[0]));
+}
+
+/**
+ * Busca todas las posiciones del benchmark a profundidad fija y suma los nodos.
+ * @param depth: profundidad de cada búsqueda (0 = BENCH_DEFAULT_DEPTH).
+ * @param verbose: muestra los nodos y la mejor jugada de cada posición.
+ * @param result: recibe la cantidad de posiciones, el total de nodos (la firma) y el tiempo.
+ * @return false si no hay memoria para la tabla de transposición o la caché de evaluaciones.
+ */
+bool bench_run(int depth, bool verbose, bench_result_t *result) {
+    memset(result, 0, sizeof(bench_result_t));
+    search_limits_t limits = {0};
+    limits.depth = depth > 0 ? depth : BENCH_DEFAULT_DEPTH;
+
+    search_context_t *ctx = malloc(sizeof(search_context_t));
+    tt_t tt;
+    if (!ctx || !tt_init(&tt, BENCH_HASH_MB)) {
+        free(ctx);
+        return false;
+    }
+    evalcache_t eval_cache;
+    if (!evalcache_init(&eval_cache, BENCH_EVAL_CACHE_MB)) {
+        tt_free(&tt);
+        free(ctx);
+        return false;
+    }
+
+    // La tabla de peones no se limpia entre posiciones (sus resultados no dependen del orden): solo se cuentan los aciertos
+    uint64_t pawn_probes, pawn_hits;
+    pawn_hash_counters(&pawn_probes, &pawn_hits);
+
+    int count = bench_position_count();
+    for (int i = 0; i < count; i++) {
+        gamestate_t game;
+        memset(&game, 0, sizeof(gamestate_t));
+        game.en_passant_square = -1;
+        init_board_fen(&game, bench_positions[i]);
+
+        // Cada posición empieza con la tabla vacía para que el resultado no dependa del orden
+        tt_clear(&tt);
+        evalcache_clear(&eval_cache);
+        search_init(ctx, &limits, NULL);
+        ctx->tt = &tt;
+        ctx->eval_cache = &eval_cache;
+        search_result_t search;
+        int64_t start = platform_time_ms();
+        bool found = search_run(ctx, &game, &search);
+        int64_t elapsed = platform_time_ms() - start;
+
+        uint64_t nodes = found ? search.nodes : 0;
+        result->nodes += nodes;
+        result->time_ms += elapsed;
+        if (found && search.memory_peak > result->memory_peak) result->memory_peak = search.memory_peak;
+        if (found) {
+            result->eval_cache_probes += search.eval_cache_probes;
+            result->eval_cache_hits += search.eval_cache_hits;
+        }
+        result->positions++;
+        if (verbose) {
+            char move_str[6] = "-";
+            if (found) move_to_string(&search.best_move, move_str);
+            printf("[ BENCH ] Posición %2d/%d: %-5s %12" PRIu64 " nodos  %s\n", i + 1, count, move_str, nodes, bench_positions[i]);
+        }
+    }
+
+    uint64_t probes_end, hits_end;
+    pawn_hash_counters(&probes_end, &hits_end);
+    result->pawn_probes = probes_end - pawn_probes;
+    result->pawn_hits = hits_end - pawn_hits;
+
+    evalcache_free(&eval_cache);
+    tt_free(&tt);
+    free(ctx);
+    return true;
+}
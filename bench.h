@@ -0,0 +1,28 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bot.h"
+
+// Benchmark de la búsqueda sobre un conjunto fijo de posiciones
+// Cada posición se busca a profundidad fija, con un solo hilo y una tabla de transposición y una caché de evaluaciones
+// del mismo tamaño (que se limpian antes de cada posición), así que la cantidad total de nodos es siempre la misma:
+// si un cambio altera ese número, cambió el comportamiento de la búsqueda. Los nodos por segundo miden la velocidad.
+
+#define BENCH_DEFAULT_DEPTH 4
+#define BENCH_HASH_MB 16
+#define BENCH_EVAL_CACHE_MB EVAL_CACHE_DEFAULT_MB
+
+typedef struct {
+    int positions;
+    uint64_t nodes;                 // Firma del benchmark
+    int64_t time_ms;
+    size_t memory_peak;             // Memoria temporal máxima de una búsqueda (bytes)
+    uint64_t pawn_probes;           // Consultas y aciertos de la tabla de peones
+    uint64_t pawn_hits;
+    uint64_t eval_cache_probes;     // Consultas y aciertos de la caché de evaluaciones
+    uint64_t eval_cache_hits;
+} bench_result_t;
+
+int bench_position_count(void);
+bool bench_run(int depth, bool verbose, bench_result_t *result);
@@ -0,0 +1,273 @@
+#include "book.h"
+
+// Entrada temporal usada durante la construcción del libro
+typedef struct {
+    uint64_t key;
+    book_move_t move;
+} book_build_entry_t;
+
+// Ordena por clave y, dentro de una misma clave, por peso descendente
+static int compare_build_entries(const void *a, const void *b) {
+    const book_build_entry_t *ea = a;
+    const book_build_entry_t *eb = b;
+    if (ea->key != eb->key) return (ea->key < eb->key) ? -1 : 1;
+    return (int)eb->move.weight - (int)ea->move.weight;
+}
+
+// Construye el libro compacto a partir de un arreglo de entradas ya ordenadas
+static compact_book_t* book_build(book_build_entry_t *entries, int count) {
+    compact_book_t *book = malloc(sizeof(compact_book_t));
+    if (!book) return NULL;
+
+    // Contar posiciones distintas
+    int positions = 0;
+    for (int i = 0; i < count; i++) {
+        if (i == 0 || entries[i].key != entries[i - 1].key) positions++;
+    }
+
+    book->keys = malloc((positions > 0 ? positions : 1) * sizeof(uint64_t));
+    book->offsets = malloc((positions + 1) * sizeof(uint32_t));
+    book->moves = malloc((count > 0 ? count : 1) * sizeof(book_move_t));
+    if (!book->keys || !book->offsets || !book->moves) {
+        book_destroy(book);
+        return NULL;
+    }
+
+    int p = 0;
+    for (int i = 0; i < count; i++) {
+        if (i == 0 || entries[i].key != entries[i - 1].key) {
+            book->keys[p] = entries[i].key;
+            book->offsets[p] = (uint32_t)i;
+            p++;
+        }
+        book->moves[i] = entries[i].move;
+    }
+    book->offsets[positions] = (uint32_t)count;
+    book->position_count = positions;
+    book->move_count = count;
+    return book;
+}
+
+/**
+ * Convierte la tabla hash del libro de aperturas a su representación compacta.
+ * Las jugadas conservan su prioridad (acotada a 16 bits) como peso.
+ * @param ht: tabla hash con el libro cargado (por ejemplo, con load_polyglot_book).
+ * @return libro compacto, o NULL si no hay memoria suficiente.
+ */
+compact_book_t* book_create_from_hashtable(hashtable_t *ht) {
+    if (!ht) return NULL;
+
+    int total = 0;
+    for (int i = 0; i < HASHTABLE_SIZE; i++) {
+        if (ht->entries[i].occupied) total += ht->entries[i].move_count;
+    }
+
+    book_build_entry_t *entries = malloc((total > 0 ? total : 1) * sizeof(book_build_entry_t));
+    if (!entries) return NULL;
+
+    int n = 0;
+    for (int i = 0; i < HASHTABLE_SIZE; i++) {
+        hashtable_entry_t *entry = &ht->entries[i];
+        if (!entry->occupied) continue;
+        for (int j = 0; j < entry->move_count; j++) {
+            int priority = entry->moves[j].priority;
+            if (priority < 0) priority = 0;
+            if (priority > UINT16_MAX) priority = UINT16_MAX;
+            entries[n].key = entry->key;
+            entries[n].move.move = book_encode_move(entry->moves[j].move);
+            entries[n].move.weight = (uint16_t)priority;
+            n++;
+        }
+    }
+
+    qsort(entries, n, sizeof(book_build_entry_t), compare_build_entries);
+    compact_book_t *book = book_build(entries, n);
+    free(entries);
+    return book;
+}
+
+// Lee un entero big-endian de n bytes desde un buffer
+static uint64_t read_be(const unsigned char *buf, int n) {
+    uint64_t r = 0;
+    for (int i = 0; i < n; i++) r = (r << 8) | buf[i];
+    return r;
+}
+
+// PolyGlot codifica el enroque como "rey captura torre" (e1h1). Se normaliza a e1g1, igual que en hashtable.c
+static uint16_t normalize_castle(uint16_t move) {
+    int from = (move >> 6) & 0x3F;
+    int to = move & 0x3F;
+    if (from == 4 && to == 7) to = 6;           // e1h1 -> e1g1
+    else if (from == 4 && to == 0) to = 2;      // e1a1 -> e1c1
+    else if (from == 60 && to == 63) to = 62;   // e8h8 -> e8g8
+    else if (from == 60 && to == 56) to = 58;   // e8a8 -> e8c8
+    return (uint16_t)((move & ~0x3F) | to);
+}
+
+/**
+ * Carga un libro PolyGlot (book.bin) directamente en formato compacto.
+ * A diferencia de load_polyglot_book, no existe límite de jugadas por posición.
+ * @param filename: ruta del archivo .bin.
+ * @return libro compacto, o NULL si no se pudo leer el archivo.
+ */
+compact_book_t* book_load_polyglot(const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f) {
+        perror("[ BOOK ] Error al abrir el archivo");
+        return NULL;
+    }
+
+    // Cada entrada PolyGlot ocupa 16 bytes, así que el tamaño del archivo determina la cantidad
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    int count = (int)(size / 16);
+
+    book_build_entry_t *entries = malloc((count > 0 ? count : 1) * sizeof(book_build_entry_t));
+    if (!entries) {
+        fclose(f);
+        return NULL;
+    }
+
+    unsigned char buf[16];
+    bool sorted = true;
+    int n = 0;
+    while (n < count && fread(buf, 1, sizeof(buf), f) == sizeof(buf)) {
+        entries[n].key = read_be(buf, 8);
+        entries[n].move.move = normalize_castle((uint16_t)read_be(buf + 8, 2));
+        entries[n].move.weight = (uint16_t)read_be(buf + 10, 2);
+        if (n > 0 && compare_build_entries(&entries[n - 1], &entries[n]) > 0) sorted = false;
+        n++;
+    }
+    fclose(f);
+
+    // Los libros PolyGlot ya vienen ordenados por clave, pero no se asume
+    if (!sorted) qsort(entries, n, sizeof(book_build_entry_t), compare_build_entries);
+
+    compact_book_t *book = book_build(entries, n);
+    free(entries);
+    return book;
+}
+
+void book_destroy(compact_book_t *book) {
+    if (!book) return;
+    free(book->keys);
+    free(book->offsets);
+    free(book->moves);
+    free(book);
+}
+
+/**
+ * Busca las jugadas de una posición mediante búsqueda binaria sobre las claves.
+ * @param book: libro compacto.
+ * @param key: clave Zobrist (PolyGlot) de la posición.
+ * @param moves_out: recibe un puntero a la primera jugada de la posición (ordenadas por peso descendente).
+ * @return cantidad de jugadas encontradas (0 si la posición no está en el libro).
+ */
+int book_get_moves(const compact_book_t *book, uint64_t key, const book_move_t **moves_out) {
+    if (!book || book->position_count == 0) return 0;
+
+    int lo = 0, hi = book->position_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (book->keys[mid] == key) {
+            if (moves_out) *moves_out = &book->moves[book->offsets[mid]];
+            return (int)(book->offsets[mid + 1] - book->offsets[mid]);
+        }
+        if (book->keys[mid] < key) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return 0;
+}
+
+// Equivalente a hashtable_lookup_best_move, pero sobre el libro compacto
+bool book_lookup_best_move(const compact_book_t *book, uint64_t key, char *move_out) {
+    const book_move_t *moves;
+    int count = book_get_moves(book, key, &moves);
+    if (count == 0) return false;
+
+    int best_idx = 0;
+    for (int i = 1; i < count; i++) {
+        if (moves[i].weight > moves[best_idx].weight) best_idx = i;
+    }
+    book_decode_move(moves[best_idx].move, move_out);
+    return true;
+}
+
+// Convierte un string como "e2e4" o "e7e8q" a una jugada de 16 bits
+uint16_t book_encode_move(const char *move) {
+    int from = (move[1] - '1') * 8 + (move[0] - 'a');
+    int to = (move[3] - '1') * 8 + (move[2] - 'a');
+    int prom = 0;
+    switch (move[4]) {
+        case 'n': prom = 1; break;
+        case 'b': prom = 2; break;
+        case 'r': prom = 3; break;
+        case 'q': prom = 4; break;
+    }
+    return (uint16_t)((prom << 12) | (from << 6) | to);
+}
+
+// Convierte una jugada de 16 bits a string (move_out debe tener espacio para MAX_MOVE_STR caracteres)
+void book_decode_move(uint16_t move, char *move_out) {
+    const char *promote_pieces = " nbrq";
+    int from = (move >> 6) & 0x3F;
+    int to = move & 0x3F;
+    int prom = (move >> 12) & 0x7;
+
+    move_out[0] = 'a' + (from & 7);
+    move_out[1] = '1' + (from >> 3);
+    move_out[2] = 'a' + (to & 7);
+    move_out[3] = '1' + (to >> 3);
+    if (prom) {
+        move_out[4] = promote_pieces[prom];
+        move_out[5] = '\0';
+    } else {
+        move_out[4] = '\0';
+    }
+}
+
+/**
+ * Codifica un move_t en el formato exacto de un archivo PolyGlot (para escribir libros).
+ * En PolyGlot el enroque se representa como el rey capturando su propia torre (e1h1, e1a1, etc).
+ */
+uint16_t book_polyglot_move(const move_t *move) {
+    int from = RANK(move->from) * 8 + FILE(move->from);
+    int to = RANK(move->to) * 8 + FILE(move->to);
+    int prom = 0;
+
+    if (move->flags == MOVE_CASTLE_KING) {
+        to = from + 3;
+    } else if (move->flags == MOVE_CASTLE_QUEEN) {
+        to = from - 4;
+    } else if (move->flags == MOVE_PROMOTION) {
+        switch (move->promotion) {
+            case KNIGHT: prom = 1; break;
+            case BISHOP: prom = 2; break;
+            case ROOK:   prom = 3; break;
+            case QUEEN:  prom = 4; break;
+        }
+    }
+    return (uint16_t)((prom << 12) | (from << 6) | to);
+}
+
+size_t book_memory_usage(const compact_book_t *book) {
+    if (!book) return 0;
+    return sizeof(compact_book_t)
+         + (size_t)book->position_count * sizeof(uint64_t)
+         + (size_t)(book->position_count + 1) * sizeof(uint32_t)
+         + (size_t)book->move_count * sizeof(book_move_t);
+}
+
+// Muestra la memoria usada por la tabla hash y por el libro compacto
+void book_print_memory_report(hashtable_t *ht, const compact_book_t *book) {
+    size_t before = hashtable_memory_usage(ht);
+    size_t after = book_memory_usage(book);
+
+    printf("[ BOOK ] Memoria tabla hash:    %10zu bytes (%d posiciones)\n", before, hashtable_get_size(ht));
+    printf("[ BOOK ] Memoria libro compacto: %10zu bytes (%d posiciones, %d jugadas)\n",
+           after, book ? book->position_count : 0, book ? book->move_count : 0);
+    if (after > 0) {
+        printf("[ BOOK ] Reducción: %.1fx\n", (double)before / (double)after);
+    }
+}
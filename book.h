@@ -0,0 +1,47 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "hashtable.h"
+#include "chess.h"
+
+// Representación compacta del libro de aperturas.
+// En vez de reservar MAX_MOVES_PER_POSITION strings por posición (hashtable_entry_t),
+// se guardan tres arreglos planos:
+//   keys[i]                       -> clave Zobrist de la posición i (ordenadas de menor a mayor)
+//   offsets[i] .. offsets[i + 1]  -> rango de jugadas de la posición i dentro de moves
+//   moves[j]                      -> par empaquetado (jugada de 16 bits, peso de 16 bits)
+// La búsqueda es binaria sobre keys, y no existe límite de jugadas por posición.
+
+// Jugada del libro: mismo formato de bits que PolyGlot
+// bits 0-5: casilla destino, bits 6-11: casilla origen, bits 12-14: promoción (0 = ninguna, 1 = n, 2 = b, 3 = r, 4 = q)
+// A diferencia de PolyGlot, el enroque se guarda como movimiento del rey a su casilla final (e1g1 y no e1h1)
+typedef struct {
+    uint16_t move;
+    uint16_t weight;
+} book_move_t;
+
+typedef struct {
+    uint64_t *keys;         // Claves Zobrist ordenadas
+    uint32_t *offsets;      // position_count + 1 elementos
+    book_move_t *moves;     // Todas las jugadas, agrupadas por posición
+    int position_count;
+    int move_count;
+} compact_book_t;
+
+// Construcción y destrucción
+compact_book_t* book_create_from_hashtable(hashtable_t *ht);
+compact_book_t* book_load_polyglot(const char *filename);
+void book_destroy(compact_book_t *book);
+// Consultas
+int book_get_moves(const compact_book_t *book, uint64_t key, const book_move_t **moves_out);
+bool book_lookup_best_move(const compact_book_t *book, uint64_t key, char *move_out);
+// Conversión entre string ("e2e4", "e7e8q") y jugada de 16 bits
+uint16_t book_encode_move(const char *move);
+void book_decode_move(uint16_t move, char *move_out);
+uint16_t book_polyglot_move(const move_t *move);
+// Memoria utilizada
+size_t book_memory_usage(const compact_book_t *book);
+void book_print_memory_report(hashtable_t *ht, const compact_book_t *book);
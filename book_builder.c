@@ -0,0 +1,459 @@
+#include "book_builder.h"
+#include <pthread.h>
+#include "pgn.h"
+#include "book.h"
+#include "zobrist.h"
+#include "platform.h"
+
+#define BATCH_GAMES 256     // Partidas por lote que el lector entrega a los hilos
+
+// Estadísticas de una jugada en una posición, desde el punto de vista del jugador que mueve
+typedef struct {
+    uint64_t key;
+    uint16_t move;
+    uint32_t wins;
+    uint32_t draws;
+    uint32_t losses;
+} book_record_t;
+
+// Lote de partidas leídas del PGN (las partidas se reutilizan entre lotes para no reservar memoria)
+typedef struct {
+    pgn_game_t games[BATCH_GAMES];
+    int count;
+} game_batch_t;
+
+// Estado compartido entre el lector y los hilos que reproducen partidas
+typedef struct {
+    const book_builder_options_t *options;
+    size_t records_per_worker;
+
+    pthread_mutex_t lock;
+    pthread_cond_t batch_ready;     // Hay lotes con partidas (o la lectura terminó)
+    pthread_cond_t batch_free;      // Hay lotes vacíos disponibles para el lector
+    game_batch_t **free_batches;
+    int free_count;
+    game_batch_t **full_batches;
+    int full_count;
+    bool reading_done;
+
+    // Runs ordenados volcados a disco
+    FILE **runs;
+    int run_count;
+    int run_capacity;
+
+    // Estadísticas
+    long games_replayed;
+    long games_rejected;            // Partidas con alguna jugada SAN inválida
+    long positions_recorded;
+} builder_t;
+
+static int compare_records(const void *a, const void *b) {
+    const book_record_t *ra = a;
+    const book_record_t *rb = b;
+    if (ra->key != rb->key) return (ra->key < rb->key) ? -1 : 1;
+    return (int)ra->move - (int)rb->move;
+}
+
+// Ordena los registros y junta los que tienen la misma (posición, jugada). Retorna la nueva cantidad
+static size_t compact_records(book_record_t *records, size_t count) {
+    if (count == 0) return 0;
+    qsort(records, count, sizeof(book_record_t), compare_records);
+
+    size_t write = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (records[i].key == records[write].key && records[i].move == records[write].move) {
+            records[write].wins += records[i].wins;
+            records[write].draws += records[i].draws;
+            records[write].losses += records[i].losses;
+        } else {
+            records[++write] = records[i];
+        }
+    }
+    return write + 1;
+}
+
+// Escribe un run ordenado a un archivo temporal y lo registra en el estado compartido
+static bool spill_run(builder_t *builder, book_record_t *records, size_t count) {
+    count = compact_records(records, count);
+    FILE *run = tmpfile();
+    if (!run) {
+        perror("[ BOOK ] No se pudo crear archivo temporal");
+        return false;
+    }
+    if (fwrite(records, sizeof(book_record_t), count, run) != count) {
+        perror("[ BOOK ] Error al escribir archivo temporal");
+        fclose(run);
+        return false;
+    }
+    rewind(run);
+
+    pthread_mutex_lock(&builder->lock);
+    if (builder->run_count == builder->run_capacity) {
+        int capacity = builder->run_capacity ? builder->run_capacity * 2 : 16;
+        FILE **runs = realloc(builder->runs, capacity * sizeof(FILE *));
+        if (!runs) {
+            pthread_mutex_unlock(&builder->lock);
+            fclose(run);
+            return false;
+        }
+        builder->runs = runs;
+        builder->run_capacity = capacity;
+    }
+    builder->runs[builder->run_count++] = run;
+    pthread_mutex_unlock(&builder->lock);
+    return true;
+}
+
+// Buffer de registros propio de cada hilo
+typedef struct {
+    builder_t *builder;
+    book_record_t *records;
+    size_t count;
+    bool ok;
+    pgn_result_t result;        // Resultado de la partida que se está reproduciendo
+    long positions;
+} builder_worker_t;
+
+static void add_record(builder_worker_t *worker, uint64_t key, uint16_t move, pgn_result_t result, int color) {
+    size_t capacity = worker->builder->records_per_worker;
+    if (worker->count == capacity) {
+        // Primero se intenta juntar registros repetidos en memoria; solo si no alcanza se vuelca a disco
+        worker->count = compact_records(worker->records, worker->count);
+        if (worker->count > capacity / 2) {
+            if (!spill_run(worker->builder, worker->records, worker->count)) worker->ok = false;
+            worker->count = 0;
+        }
+    }
+
+    book_record_t *record = &worker->records[worker->count++];
+    record->key = key;
+    record->move = move;
+    record->wins = record->draws = record->losses = 0;
+    if (result == PGN_RESULT_DRAW) {
+        record->draws = 1;
+    } else if ((result == PGN_RESULT_WHITE_WINS) == (color == WHITE)) {
+        record->wins = 1;
+    } else {
+        record->losses = 1;
+    }
+}
+
+// Registra la posición y la jugada de cada ply, deteniendo la partida al llegar a max_ply
+static bool record_move(const gamestate_t *position, const move_t *move, int ply, void *user) {
+    builder_worker_t *worker = user;
+    if (ply >= worker->builder->options->max_ply) return false;
+    add_record(worker, polyglot_hash_position(position), book_polyglot_move(move), worker->result, position->to_move);
+    worker->positions++;
+    return true;
+}
+
+static void* builder_worker_main(void *arg) {
+    builder_worker_t *worker = arg;
+    builder_t *builder = worker->builder;
+    gamestate_t game;
+    memset(&game, 0, sizeof(game));
+    pgn_callbacks_t callbacks = { .on_move = record_move };
+
+    long replayed = 0, rejected = 0;
+    while (true) {
+        pthread_mutex_lock(&builder->lock);
+        while (builder->full_count == 0 && !builder->reading_done) {
+            pthread_cond_wait(&builder->batch_ready, &builder->lock);
+        }
+        if (builder->full_count == 0) {
+            pthread_mutex_unlock(&builder->lock);
+            break;
+        }
+        game_batch_t *batch = builder->full_batches[--builder->full_count];
+        pthread_mutex_unlock(&builder->lock);
+
+        for (int i = 0; i < batch->count; i++) {
+            // Las partidas sin resultado no aportan estadísticas
+            if (batch->games[i].result == PGN_RESULT_UNKNOWN) continue;
+            worker->result = batch->games[i].result;
+            if (pgn_replay_game(&batch->games[i], &game, &callbacks, worker, NULL)) replayed++;
+            else rejected++;
+        }
+
+        pthread_mutex_lock(&builder->lock);
+        builder->free_batches[builder->free_count++] = batch;
+        pthread_cond_signal(&builder->batch_free);
+        pthread_mutex_unlock(&builder->lock);
+    }
+
+    if (worker->count > 0 && !spill_run(builder, worker->records, worker->count)) worker->ok = false;
+    worker->count = 0;
+
+    pthread_mutex_lock(&builder->lock);
+    builder->games_replayed += replayed;
+    builder->games_rejected += rejected;
+    builder->positions_recorded += worker->positions;
+    pthread_mutex_unlock(&builder->lock);
+    return NULL;
+}
+
+// Escribe un entero big-endian de n bytes
+static void write_be(FILE *f, uint64_t value, int n) {
+    for (int i = n - 1; i >= 0; i--) fputc((int)((value >> (8 * i)) & 0xFF), f);
+}
+
+static int compare_weight_desc(const void *a, const void *b) {
+    const book_move_t *ma = a;
+    const book_move_t *mb = b;
+    if (ma->weight != mb->weight) return (int)mb->weight - (int)ma->weight;
+    return (int)ma->move - (int)mb->move;
+}
+
+// Calcula los pesos de todas las jugadas de una posición y las escribe en el libro
+// peso = 2 * victorias + tablas (escalado por posición para que quepa en 16 bits)
+static long write_position(FILE *out, const book_builder_options_t *options, const book_record_t *group, int count, book_move_t *scratch) {
+    uint64_t max_score = 0;
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        uint64_t games = (uint64_t)group[i].wins + group[i].draws + group[i].losses;
+        if (games < (uint64_t)options->min_games) continue;
+        uint64_t score = 2 * (uint64_t)group[i].wins + group[i].draws;
+        if (score > max_score) max_score = score;
+    }
+    for (int i = 0; i < count; i++) {
+        uint64_t games = (uint64_t)group[i].wins + group[i].draws + group[i].losses;
+        if (games < (uint64_t)options->min_games) continue;
+        uint64_t score = 2 * (uint64_t)group[i].wins + group[i].draws;
+        if (max_score > UINT16_MAX) score = score * UINT16_MAX / max_score;
+        if (score == 0) continue;   // Jugadas que solo perdieron no se recomiendan
+        scratch[n].move = group[i].move;
+        scratch[n].weight = (uint16_t)score;
+        n++;
+    }
+
+    qsort(scratch, n, sizeof(book_move_t), compare_weight_desc);
+    for (int i = 0; i < n; i++) {
+        write_be(out, group[0].key, 8);
+        write_be(out, scratch[i].move, 2);
+        write_be(out, scratch[i].weight, 2);
+        write_be(out, 0, 4);    // learn
+    }
+    return n;
+}
+
+// Une todos los runs (k-way merge con un heap) y escribe el libro ordenado por clave
+static long merge_runs(builder_t *builder, FILE *out) {
+    int k = builder->run_count;
+    book_record_t *heads = malloc((k > 0 ? k : 1) * sizeof(book_record_t));
+    int *heap = malloc((k > 0 ? k : 1) * sizeof(int));
+    int heap_size = 0;
+
+    // Grupo de jugadas de la posición actual (crece si una posición tiene muchas jugadas)
+    int group_capacity = 64, group_count = 0;
+    book_record_t *group = malloc(group_capacity * sizeof(book_record_t));
+    book_move_t *scratch = malloc(group_capacity * sizeof(book_move_t));
+    long written = 0;
+
+    if (!heads || !heap || !group || !scratch) {
+        free(heads); free(heap); free(group); free(scratch);
+        return -1;
+    }
+
+    #define HEAP_LESS(a, b) (compare_records(&heads[heap[a]], &heads[heap[b]]) < 0)
+    for (int r = 0; r < k; r++) {
+        if (fread(&heads[r], sizeof(book_record_t), 1, builder->runs[r]) != 1) continue;
+        // Insertar y subir en el heap
+        int i = heap_size++;
+        heap[i] = r;
+        while (i > 0 && HEAP_LESS(i, (i - 1) / 2)) {
+            int tmp = heap[i]; heap[i] = heap[(i - 1) / 2]; heap[(i - 1) / 2] = tmp;
+            i = (i - 1) / 2;
+        }
+    }
+
+    while (heap_size > 0) {
+        int r = heap[0];
+        book_record_t record = heads[r];
+
+        // Avanzar el run del tope y restaurar el heap
+        if (fread(&heads[r], sizeof(book_record_t), 1, builder->runs[r]) != 1) {
+            heap[0] = heap[--heap_size];
+        }
+        int i = 0;
+        while (true) {
+            int smallest = i, left = 2 * i + 1, right = 2 * i + 2;
+            if (left < heap_size && HEAP_LESS(left, smallest)) smallest = left;
+            if (right < heap_size && HEAP_LESS(right, smallest)) smallest = right;
+            if (smallest == i) break;
+            int tmp = heap[i]; heap[i] = heap[smallest]; heap[smallest] = tmp;
+            i = smallest;
+        }
+
+        // Cambió la posición: escribir la anterior
+        if (group_count > 0 && group[0].key != record.key) {
+            written += write_position(out, builder->options, group, group_count, scratch);
+            group_count = 0;
+        }
+        // Misma jugada en distintos runs: sumar estadísticas
+        if (group_count > 0 && group[group_count - 1].move == record.move) {
+            group[group_count - 1].wins += record.wins;
+            group[group_count - 1].draws += record.draws;
+            group[group_count - 1].losses += record.losses;
+            continue;
+        }
+        if (group_count == group_capacity) {
+            group_capacity *= 2;
+            group = realloc(group, group_capacity * sizeof(book_record_t));
+            scratch = realloc(scratch, group_capacity * sizeof(book_move_t));
+            if (!group || !scratch) {
+                written = -1;
+                break;
+            }
+        }
+        group[group_count++] = record;
+    }
+    #undef HEAP_LESS
+
+    if (written >= 0 && group_count > 0) {
+        written += write_position(out, builder->options, group, group_count, scratch);
+    }
+
+    free(heads);
+    free(heap);
+    free(group);
+    free(scratch);
+    return written;
+}
+
+void book_builder_default_options(book_builder_options_t *options) {
+    options->pgn_path = NULL;
+    options->book_path = "book.bin";
+    options->max_ply = 30;
+    options->min_games = 1;
+    options->threads = 0;
+    options->memory_mb = 256;
+}
+
+/**
+ * Genera un libro PolyGlot a partir de un archivo PGN.
+ * @param options: archivos de entrada/salida y límites (ver book_builder_options_t).
+ * @return true si el libro se escribió correctamente.
+ */
+bool book_builder_run(const book_builder_options_t *options) {
+    int64_t start = platform_time_ms();
+    int threads = options->threads > 0 ? options->threads : platform_cpu_count();
+
+    pgn_reader_t reader;
+    if (!pgn_reader_open(&reader, options->pgn_path)) return false;
+
+    builder_t builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.options = options;
+    builder.records_per_worker = options->memory_mb * 1024 * 1024 / sizeof(book_record_t) / threads;
+    if (builder.records_per_worker < 1024) builder.records_per_worker = 1024;
+    pthread_mutex_init(&builder.lock, NULL);
+    pthread_cond_init(&builder.batch_ready, NULL);
+    pthread_cond_init(&builder.batch_free, NULL);
+
+    // Cantidad acotada de lotes: el lector se bloquea si los hilos van más lento que la lectura
+    int batch_count = 2 * threads + 1;
+    game_batch_t *batches = calloc(batch_count, sizeof(game_batch_t));
+    builder.free_batches = malloc(batch_count * sizeof(game_batch_t *));
+    builder.full_batches = malloc(batch_count * sizeof(game_batch_t *));
+    builder_worker_t *workers = calloc(threads, sizeof(builder_worker_t));
+    pthread_t *thread_ids = malloc(threads * sizeof(pthread_t));
+    if (!batches || !builder.free_batches || !builder.full_batches || !workers || !thread_ids) {
+        fprintf(stderr, "[ BOOK ] No hay memoria suficiente\n");
+        pgn_reader_close(&reader);
+        return false;
+    }
+    for (int i = 0; i < batch_count; i++) {
+        for (int j = 0; j < BATCH_GAMES; j++) pgn_game_init(&batches[i].games[j]);
+        builder.free_batches[builder.free_count++] = &batches[i];
+    }
+
+    bool ok = true;
+    for (int t = 0; t < threads; t++) {
+        workers[t].builder = &builder;
+        workers[t].records = malloc(builder.records_per_worker * sizeof(book_record_t));
+        workers[t].ok = true;
+        ok = ok && workers[t].records != NULL;
+    }
+    // Los hilos que se crean quedan al principio de workers; sin ninguno, el lector esperaría lotes libres para siempre
+    int started = 0;
+    if (!ok) {
+        fprintf(stderr, "[ BOOK ] No hay memoria suficiente para los registros de los hilos\n");
+    } else {
+        for (int t = 0; t < threads; t++) {
+            if (pthread_create(&thread_ids[started], NULL, builder_worker_main, &workers[started]) == 0) started++;
+        }
+        if (started == 0) {
+            fprintf(stderr, "[ BOOK ] No se pudo crear ningún hilo\n");
+            ok = false;
+        }
+    }
+
+    // El hilo principal lee el PGN y reparte lotes
+    bool eof = !ok;
+    while (!eof) {
+        pthread_mutex_lock(&builder.lock);
+        while (builder.free_count == 0) pthread_cond_wait(&builder.batch_free, &builder.lock);
+        game_batch_t *batch = builder.free_batches[--builder.free_count];
+        pthread_mutex_unlock(&builder.lock);
+
+        batch->count = 0;
+        while (batch->count < BATCH_GAMES) {
+            if (!pgn_next_game(&reader, &batch->games[batch->count])) {
+                eof = true;
+                break;
+            }
+            batch->count++;
+        }
+
+        pthread_mutex_lock(&builder.lock);
+        builder.full_batches[builder.full_count++] = batch;
+        if (eof) builder.reading_done = true;
+        pthread_cond_broadcast(&builder.batch_ready);
+        pthread_mutex_unlock(&builder.lock);
+    }
+
+    for (int t = 0; t < started; t++) {
+        pthread_join(thread_ids[t], NULL);
+        ok = ok && workers[t].ok;
+    }
+    for (int t = 0; t < threads; t++) free(workers[t].records);
+    int64_t replay_end = platform_time_ms();
+
+    long written = -1;
+    if (ok) {
+        FILE *out = fopen(options->book_path, "wb");
+        if (out) {
+            written = merge_runs(&builder, out);
+            fclose(out);
+        } else {
+            perror("[ BOOK ] Error al crear el libro");
+        }
+    }
+    ok = ok && written >= 0;
+
+    if (ok) {
+        printf("[ BOOK ] Partidas leídas: %ld (reproducidas: %ld, descartadas: %ld)\n",
+               reader.games_read, builder.games_replayed, builder.games_rejected);
+        printf("[ BOOK ] Posiciones registradas: %ld en %d runs (%d hilos)\n",
+               builder.positions_recorded, builder.run_count, started);
+        printf("[ BOOK ] Entradas escritas en %s: %ld\n", options->book_path, written);
+        printf("[ BOOK ] Tiempo: %.2f s reproducción + %.2f s merge\n",
+               (replay_end - start) / 1000.0, (platform_time_ms() - replay_end) / 1000.0);
+    }
+
+    for (int r = 0; r < builder.run_count; r++) fclose(builder.runs[r]);
+    free(builder.runs);
+    for (int i = 0; i < batch_count; i++) {
+        for (int j = 0; j < BATCH_GAMES; j++) pgn_game_free(&batches[i].games[j]);
+    }
+    free(batches);
+    free(builder.free_batches);
+    free(builder.full_batches);
+    free(workers);
+    free(thread_ids);
+    pthread_mutex_destroy(&builder.lock);
+    pthread_cond_destroy(&builder.batch_ready);
+    pthread_cond_destroy(&builder.batch_free);
+    pgn_reader_close(&reader);
+    return ok;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Generador de libros de apertura PolyGlot (book.bin) a partir de una colección de partidas PGN
+// El archivo PGN se lee de forma secuencial, las partidas se reproducen en paralelo y las
+// estadísticas de cada (posición, jugada) se ordenan con un ordenamiento externo (runs en disco + merge),
+// por lo que la memoria usada está acotada sin importar el tamaño del PGN.
+
+typedef struct {
+    const char *pgn_path;       // Archivo PGN de entrada
+    const char *book_path;      // Archivo .bin de salida
+    int max_ply;                // Solo se registran las primeras max_ply jugadas de cada partida
+    int min_games;              // Jugadas con menos partidas que este valor se descartan
+    int threads;                // Hilos que reproducen partidas (0 = todos los núcleos)
+    size_t memory_mb;           // Memoria máxima para registros antes de volcar a disco
+} book_builder_options_t;
+
+void book_builder_default_options(book_builder_options_t *options);
+bool book_builder_run(const book_builder_options_t *options);
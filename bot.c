@@ -1,75 +1,21 @@
 #include "bot.h"
+#include "mcts.h"
 
-// Valores de las piezas para evaluación material
-static const int piece_values[7] = {
-    0,    // EMPTY
-    100,  // PAWN
-    320,  // KNIGHT
-    330,  // BISHOP
-    500,  // ROOK
-    900,  // QUEEN
-    20000 // KING
+// Configuración de la búsqueda por defecto
+const search_params_t search_default_params = {
+    .use_tt = true,
+    .use_pvs = true,
+    .mobility_weight = EVAL_DEFAULT_MOBILITY_WEIGHT,
+    .use_nnue = true,
+    .use_mcts = false,
+    .mcts_exploration = MCTS_DEFAULT_EXPLORATION,
+    .mcts_leaf_depth = MCTS_DEFAULT_LEAF_DEPTH,
+    .mcts_rollout_plies = 0
 };
 
 // Función auxiliar que filtra los movimientos pseudo-legales de generate_moves(...)
 void filter_legal_moves(gamestate_t *game, move_list_t *moves) {
-    int write_idx = 0;
-    for (int i = 0; i < moves->count; i++) {
-        if (is_legal_move(&moves->moves[i], game)) {
-            moves->moves[write_idx++] = moves->moves[i];
-        }
-    }
-    moves->count = write_idx;
-}
-
-// Función de evaluación simple: material + movilidad
-int evaluate_position(gamestate_t *game) {
-    int score = 0;
-    int white_material = 0, black_material = 0;
-    int white_mobility = 0, black_mobility = 0;
-    
-    // Evaluación material
-    for (int sq = 0; sq < BOARD_SIZE; sq++) {
-        if (!IS_VALID_SQUARE(sq)) continue;
-        
-        int piece = game->board[sq];
-        if (piece == EMPTY) continue;
-        
-        int piece_type = PIECE_TYPE(piece);
-        int piece_color = COLOR(piece);
-        
-        if (piece_color == WHITE) {
-            white_material += piece_values[piece_type];
-        } else {
-            black_material += piece_values[piece_type];
-        }
-    }
-    
-    // Evaluación de movilidad (número de movimientos legales)
-    move_list_t moves;
-    
-    // Contar movimientos para las blancas
-    int original_turn = game->to_move;
-    game->to_move = WHITE;
-    generate_moves(game, &moves);
-    filter_legal_moves(game, &moves);
-    white_mobility = moves.count;
-    
-    // Contar movimientos para las negras
-    game->to_move = BLACK;
-    generate_moves(game, &moves);
-    filter_legal_moves(game, &moves);
-    black_mobility = moves.count;
-    
-    // Restaurar turno original
-    game->to_move = original_turn;
-    
-    // Calcular puntuación final
-    score = (white_material - black_material) + 
-            (white_mobility - black_mobility) * 2; // Peso menor para movilidad
-    
-    // Devolver desde perspectiva del jugador actual
-    return (game->to_move == WHITE) ? score : -score;
+    remove_illegal_moves(game, moves);
 }
 
 // Verifica si el juego ha terminado (jaque mate, ahogado, etc.)
@@ -83,13 +29,13 @@ int score_move(gamestate_t *game, move_t *move) {
     
     // Priorizar capturas
     if (move->captured != EMPTY) {
-        score += piece_values[PIECE_TYPE(move->captured)] - 
-                 piece_values[PIECE_TYPE(move->piece)];
+        score += eval_params.piece_values[PIECE_TYPE(move->captured)] - 
+                 eval_params.piece_values[PIECE_TYPE(move->piece)];
     }
     
     // Priorizar promociones
     if (move->flags == MOVE_PROMOTION) {
-        score += piece_values[move->promotion];
+        score += eval_params.piece_values[move->promotion];
     }
     
     // Priorizar movimientos hacia el centro
@@ -102,144 +48,643 @@ int score_move(gamestate_t *game, move_t *move) {
 }
 
 // Ordenar movimientos por puntuación (insertion sort simple)
-void sort_moves(gamestate_t *game, move_list_t *moves) {
+// Ordena por inserción usando los puntajes ya calculados (score_move se llama una sola vez por jugada)
+static void sort_scored_moves(gamestate_t *game, move_list_t *moves, int *scores) {
+    for (int i = 0; i < moves->count; i++) {
+        scores[i] = score_move(game, &moves->moves[i]);
+    }
     for (int i = 1; i < moves->count; i++) {
         move_t key = moves->moves[i];
-        int key_score = score_move(game, &key);
+        int key_score = scores[i];
         int j = i - 1;
-        
-        while (j >= 0 && score_move(game, &moves->moves[j]) < key_score) {
+
+        while (j >= 0 && scores[j] < key_score) {
             moves->moves[j + 1] = moves->moves[j];
+            scores[j + 1] = scores[j];
             j--;
         }
         moves->moves[j + 1] = key;
+        scores[j + 1] = key_score;
     }
 }
 
-// Algoritmo minimax con poda alpha-beta
-int alpha_beta(gamestate_t *game, int depth, int alpha, int beta, int maximizing_player) {
-    // Caso base: profundidad 0 o juego terminado
-    if (depth == 0 || is_game_over(game)) {
-        return evaluate_position(game);
+void sort_moves(gamestate_t *game, move_list_t *moves) {
+    int scores[256];
+    sort_scored_moves(game, moves, scores);
+}
+
+// Cantidad de nodos buscados por todos los hilos (los hilos suman sus nodos al contador compartido cada 1024 nodos)
+static uint64_t search_total_nodes(const search_context_t *ctx) {
+    if (!ctx->shared_nodes) return ctx->nodes;
+    return atomic_load(ctx->shared_nodes) + (ctx->nodes & 1023);
+}
+
+// Revisa si la búsqueda se debe detener (señal externa, límite de nodos de todos los hilos o de tiempo)
+// El reloj solo se consulta cada 1024 nodos, ya que es relativamente costoso
+static bool search_should_stop(search_context_t *ctx) {
+    if (ctx->stopped) return true;
+    if (ctx->limits.nodes && search_total_nodes(ctx) >= ctx->limits.nodes) {
+        ctx->stopped = true;
+    } else if ((ctx->nodes & 1023) == 0) {
+        if (ctx->shared_nodes) atomic_fetch_add(ctx->shared_nodes, 1024);
+        if (ctx->stop && atomic_load(ctx->stop)) ctx->stopped = true;
+        else {
+            int64_t deadline = atomic_load_explicit(&ctx->deadline, memory_order_relaxed);
+            if (!deadline && ctx->shared_deadline) deadline = atomic_load_explicit(ctx->shared_deadline, memory_order_relaxed);
+            if (deadline && platform_time_ms() >= deadline) ctx->stopped = true;
+        }
     }
-    
-    move_list_t moves;
-    generate_moves(game, &moves);
-    filter_legal_moves(game, &moves);
-    
-    // Ordenar movimientos para mejorar la poda
-    sort_moves(game, &moves);
-    
-    if (maximizing_player) {
-        int max_eval = INT_MIN;
-        gamestate_t backup;
-        
-        for (int i = 0; i < moves.count; i++) {
-            // Hacer el movimiento
-            fast_undo_t undo_info;
-            prepare_fast_undo(game, &moves.moves[i], &undo_info);
-            make_move(&moves.moves[i], game, false);
-            
-            // Llamada recursiva
-            int eval = alpha_beta(game, depth - 1, alpha, beta, 0);
-            
-            // Deshacer el movimiento
-            fast_unmake_move(game, &moves.moves[i], &undo_info);
-            
-            max_eval = (eval > max_eval) ? eval : max_eval;
-            alpha = (alpha > eval) ? alpha : eval;
-            
-            // Poda beta
-            if (beta <= alpha) {
-                break;
-            }
+    return ctx->stopped;
+}
+
+// Verifica si la posición actual ya ocurrió antes (en la búsqueda o en la partida), desde el último movimiento irreversible
+static bool is_repetition(const search_context_t *ctx, const gamestate_t *game, int ply) {
+    for (int back = 2; back <= game->halfmove_clock; back += 2) {
+        int index = ply - back;
+        uint64_t key;
+        if (index >= 0) {
+            key = ctx->path_keys[index];
+        } else {
+            int history_index = ctx->history_count + index;
+            if (history_index < 0) break;
+            key = ctx->history_keys[history_index];
         }
-        
-        return max_eval;
+        if (key == game->key) return true;
+    }
+    return false;
+}
+
+// Los puntajes de mate se guardan en la tabla relativos a la posición (y no a la raíz)
+static int score_to_tt(int score, int ply) {
+    if (score >= MATE_SCORE - MAX_PLY) return score + ply;
+    if (score <= -MATE_SCORE + MAX_PLY) return score - ply;
+    return score;
+}
+
+static int score_from_tt(int score, int ply) {
+    if (score >= MATE_SCORE - MAX_PLY) return score - ply;
+    if (score <= -MATE_SCORE + MAX_PLY) return score + ply;
+    return score;
+}
+
+// Mueve la jugada 'index' al comienzo de la lista, manteniendo el orden del resto
+static void move_to_front(move_list_t *moves, int index) {
+    if (index <= 0) return;
+    move_t tmp = moves->moves[index];
+    memmove(&moves->moves[1], &moves->moves[0], index * sizeof(move_t));
+    moves->moves[0] = tmp;
+}
+
+// Datos del ply: la primera vez que la búsqueda llega a un ply se reservan en la arena del hilo
+static search_frame_t* search_frame(search_context_t *ctx, int ply) {
+    if (!ctx->frames[ply]) ctx->frames[ply] = arena_alloc(&ctx->arena, sizeof(search_frame_t));
+    return ctx->frames[ply];
+}
+
+// Evaluación estática de la posición, consultando primero la caché de evaluaciones
+static int search_evaluate(search_context_t *ctx, gamestate_t *game) {
+    int score;
+    if (ctx->eval_cache) {
+        ctx->eval_cache_probes++;
+        if (evalcache_probe(ctx->eval_cache, game->key, &score)) {
+            ctx->eval_cache_hits++;
+            return score;
+        }
+    }
+    if (ctx->params.use_nnue && nnue_ready()) {
+        score = evaluate_position_nnue(game);
     } else {
-        int min_eval = INT_MAX;
-        gamestate_t backup;
-        
-        for (int i = 0; i < moves.count; i++) {
-            // Hacer el movimiento
-            fast_undo_t undo_info;
-            prepare_fast_undo(game, &moves.moves[i], &undo_info);
-            make_move(&moves.moves[i], game, false);
-            
-            // Llamada recursiva
-            int eval = alpha_beta(game, depth - 1, alpha, beta, 1);
-            
-            // Deshacer el movimiento
-            fast_unmake_move(game, &moves.moves[i], &undo_info);
-            
-            min_eval = (eval < min_eval) ? eval : min_eval;
-            beta = (beta < eval) ? beta : eval;
-            
-            // Poda alpha
-            if (beta <= alpha) {
-                break;
+        score = evaluate_position_weighted(game, ctx->params.mobility_weight);
+    }
+    evalcache_store(ctx->eval_cache, game->key, score);
+    return score;
+}
+
+// Algoritmo negamax con poda alpha-beta, búsqueda de variante principal (PVS) y tabla de transposición
+// Los puntajes siempre son desde la perspectiva del jugador que mueve en 'game'
+int alpha_beta(search_context_t *ctx, gamestate_t *game, int depth, int alpha, int beta, int ply) {
+    bool pv_node = beta - alpha > 1;
+    search_frame_t *frame = search_frame(ctx, ply);
+    if (!frame) {
+        // Sin memoria: se detiene la búsqueda y se usa la última iteración completa
+        ctx->stopped = true;
+        return 0;
+    }
+    frame->pv_length = 0;
+    ctx->nodes++;
+    STATS_INC(nodes);
+    if (search_should_stop(ctx)) return 0;
+    ctx->path_keys[ply] = game->key;
+
+    // Tablas por regla de 50 movimientos, material insuficiente o repetición
+    if (ply > 0 && (game->halfmove_clock >= 100 || is_insufficient_material(game) || is_repetition(ctx, game, ply))) {
+        return 0;
+    }
+    // Rey y peón contra rey (se reconoce por la clave de material): las tablas del bitbase son exactas y cortan
+    // el subárbol (las posiciones ganadas se siguen buscando para encontrar el camino a la coronación)
+    if (ply > 0 && material_probe(game)->evaluator == ENDGAME_KPK) {
+        int pawn = kpk_find_pawn(game);
+        if (pawn >= 0 && !kpk_probe(game, pawn)) return 0;
+    }
+    // Tablas de finales: el resultado es exacto, así que corta el subárbol. Se consultan solo después de una captura
+    // o un movimiento de peón (como el material ya no cambia, las posiciones siguientes no necesitan otra consulta)
+    if (ply > 0 && game->halfmove_clock == 0 && tb_max_pieces() > 0) {
+        int wdl;
+        if (tb_probe_wdl(game, &wdl)) return wdl == TB_DRAW ? 0 : wdl * (TB_WIN_SCORE - ply);
+    }
+    if (ply >= MAX_PLY - 1) {
+        return search_evaluate(ctx, game);
+    }
+
+    // Consultar la tabla de transposición. Fuera de la variante principal, un resultado suficientemente profundo corta la búsqueda
+    tt_data_t entry;
+    uint16_t tt_move = 0;
+    tt_t *tt = ctx->params.use_tt ? ctx->tt : NULL;
+    if (tt) STATS_INC(tt_probes);
+    if (tt_probe(tt, game->key, &entry)) {
+        STATS_INC(tt_hits);
+        tt_move = entry.move;
+        if (!pv_node && entry.depth >= depth) {
+            int score = score_from_tt(entry.score, ply);
+            if (entry.bound == TT_BOUND_EXACT ||
+                (entry.bound == TT_BOUND_LOWER && score >= beta) ||
+                (entry.bound == TT_BOUND_UPPER && score <= alpha)) {
+                STATS_INC(tt_cutoffs);
+                return score;
             }
         }
-        
-        return min_eval;
     }
-}
 
-// Función principal para encontrar el mejor movimiento
-move_t find_best_move(gamestate_t *game, int depth) {
-    move_list_t moves;
-    generate_moves(game, &moves);
-    filter_legal_moves(game, &moves);
-    
-    if (moves.count == 0) {
-        // No hay movimientos legales
-        move_t null_move = {0};
-        return null_move;
+    // Caso base: profundidad 0
+    if (depth == 0) {
+        return search_evaluate(ctx, game);
+    }
+
+    move_list_t *moves = &frame->moves;
+    generate_moves(game, moves);
+    filter_legal_moves(game, moves);
+
+    // Sin movimientos legales: jaque mate (se prefiere el mate más corto) o ahogado
+    if (moves->count == 0) {
+        return is_in_check(game, game->to_move) ? -MATE_SCORE + ply : 0;
     }
-    
-    // Ordenar movimientos
-    sort_moves(game, &moves);
-    
-    move_t best_move = moves.moves[0];
-    int best_score = INT_MIN;
-    int alpha = INT_MIN;
-    int beta = INT_MAX;
-    gamestate_t backup;
-    
-    printf("Explorando estados con profunidad = %d...\n", depth);
 
-    for (int i = 0; i < moves.count; i++) {
+    // Ordenar movimientos para mejorar la poda: primero la jugada de la tabla (o de la iteración anterior en la raíz)
+    sort_scored_moves(game, moves, frame->scores);
+    for (int i = 0; i < moves->count; i++) {
+        if (tt_move ? tt_move_matches(tt_move, &moves->moves[i])
+                    : (ply == 0 && ctx->root_pv_length > 0 &&
+                       tt_pack_move(&moves->moves[i]) == tt_pack_move(&ctx->root_pv[0]))) {
+            move_to_front(moves, i);
+            break;
+        }
+    }
+
+    int original_alpha = alpha;
+    int best_score = -INFINITE_SCORE;
+    uint16_t best_move = 0;
+    for (int i = 0; i < moves->count; i++) {
         // Hacer el movimiento
-        fast_undo_t undo_info;
-        prepare_fast_undo(game, &moves.moves[i], &undo_info);
-        make_move(&moves.moves[i], game, false);
-        
-        // Evaluar la posición resultante
-        int score = alpha_beta(game, depth - 1, alpha, beta, 0);
-        
+        prepare_fast_undo(game, &moves->moves[i], &frame->undo);
+        make_move(&moves->moves[i], game, false);
+
+        // Llamada recursiva (el puntaje del rival, con signo invertido)
+        // La primera jugada se busca con ventana completa; el resto con ventana nula, y solo se repite si supera alpha
+        int score;
+        if (i == 0 || !ctx->params.use_pvs) {
+            score = -alpha_beta(ctx, game, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            score = -alpha_beta(ctx, game, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta) {
+                score = -alpha_beta(ctx, game, depth - 1, -beta, -alpha, ply + 1);
+            }
+        }
+
         // Deshacer el movimiento
-        fast_unmake_move(game, &moves.moves[i], &undo_info);
-        
-        // Imprimir información de cada movimiento candidato
-        /*printf("Movimiento %d: %c%d%c%d, Evaluación: %d\n", 
-               i + 1,
-               'a' + FILE(moves.moves[i].from), RANK(moves.moves[i].from) + 1,
-               'a' + FILE(moves.moves[i].to), RANK(moves.moves[i].to) + 1,
-               score);*/
-        
-        // Actualizar mejor movimiento si es necesario
+        fast_unmake_move(game, &moves->moves[i], &frame->undo);
+
+        if (ctx->stopped) return 0;
+
         if (score > best_score) {
             best_score = score;
-            best_move = moves.moves[i];
+            best_move = tt_pack_move(&moves->moves[i]);
+            if (score > alpha) {
+                alpha = score;
+                // Actualizar la variante principal: esta jugada + la variante del hijo
+                search_frame_t *child = ctx->frames[ply + 1];
+                frame->pv[0] = moves->moves[i];
+                memcpy(&frame->pv[1], child->pv, child->pv_length * sizeof(move_t));
+                frame->pv_length = child->pv_length + 1;
+            }
+        }
+
+        // Poda beta
+        if (alpha >= beta) {
+            STATS_CUTOFF(i);
+            break;
         }
-        
-        alpha = (alpha > score) ? alpha : score;
     }
-    
+
+    int bound = best_score >= beta ? TT_BOUND_LOWER : (best_score > original_alpha ? TT_BOUND_EXACT : TT_BOUND_UPPER);
+    tt_store(tt, game->key, best_move, score_to_tt(best_score, ply), depth, bound);
+    return best_score;
+}
+
+/**
+ * Inicializa un contexto de búsqueda. Cada hilo que busca debe tener su propio contexto.
+ * Después de llamar a esta función se pueden asignar los campos opcionales: params, tt, eval_cache, pool,
+ * history_keys/history_count y on_iteration.
+ * @param ctx: contexto a inicializar.
+ * @param limits: límites de profundidad, tiempo y nodos (0 = sin límite).
+ * @param stop: señal externa para detener la búsqueda (puede ser NULL).
+ */
+void search_init(search_context_t *ctx, const search_limits_t *limits, atomic_bool *stop) {
+    memset(ctx, 0, sizeof(search_context_t));
+    ctx->limits = *limits;
+    ctx->params = search_default_params;
+    ctx->stop = stop;
+}
+
+/**
+ * Búsqueda con profundización iterativa: busca a profundidad 1, 2, 3, ... hasta alcanzar algún límite.
+ * Si la búsqueda se detiene a mitad de una iteración, se usa el resultado de la última iteración completa.
+ * Con ctx->params.use_mcts se busca con MCTS en vez de alfa-beta (ver mcts.h).
+ * @param ctx: contexto inicializado con search_init.
+ * @param game: posición a analizar (se restaura al terminar).
+ * @param result: mejor jugada, puntaje, variante principal y estadísticas.
+ * @return false si la posición no tiene movimientos legales.
+ */
+bool search_run(search_context_t *ctx, gamestate_t *game, search_result_t *result) {
+    if (ctx->params.use_mcts) return mcts_run(ctx, game, 1, result);
+    memset(result, 0, sizeof(search_result_t));
+    ctx->start_time = platform_time_ms();
+    STATS_RESET();
+    // search_init deja los tiempos límite en 0; durante un pondering se pueden fijar después con search_set_deadline
+    if (ctx->limits.movetime_ms > 0) search_set_deadline(ctx, ctx->limits.movetime_ms);
+    // Con varios hilos, search_run_threads ya inició la búsqueda en la tabla
+    if (!ctx->shared_nodes) tt_new_search(ctx->tt);
+
+    // Por si el tablero se modificó directamente (sin make_move): el acumulador de la red se recalcula al evaluar
+    game->key = polyglot_hash_position(game);
+    game->pawn_key = zobrist_pawn_key(game);
+    game->material_key = compute_material_key(game);
+    game->nnue.generation = 0;
+
+    move_list_t moves;
+    generate_moves(game, &moves);
+    filter_legal_moves(game, &moves);
+    if (moves.count == 0) return false;
+
+    // Si la búsqueda se detiene antes de terminar la primera iteración, al menos hay una jugada legal
+    sort_moves(game, &moves);
+    result->best_move = moves.moves[0];
+
+    // La memoria por ply se reserva a medida que la búsqueda profundiza, y se libera toda junta al terminar
+    arena_init(&ctx->arena, ctx->pool);
+    memset(ctx->frames, 0, sizeof(ctx->frames));
+
+    int max_depth = ctx->limits.depth > 0 ? ctx->limits.depth : MAX_PLY - 1;
+    if (max_depth > MAX_PLY - 1) max_depth = MAX_PLY - 1;
+
+    // Posición ganada o perdida según las tablas de finales: la jugada sale de ellas (la que gana más rápido o la
+    // que más resiste) y no hace falta buscar. Si son tablas se busca igual, para elegir entre las que las mantienen
+    move_t tb_move;
+    int tb_wdl, tb_dtz;
+    if (tb_max_pieces() > 0 && tb_probe_root(game, &tb_move, &tb_wdl, &tb_dtz) && tb_wdl != TB_DRAW) {
+        result->best_move = tb_move;
+        result->score = tb_wdl * TB_WIN_SCORE;
+        result->depth = 1;
+        result->pv[0] = tb_move;
+        result->pv_length = 1;
+        result->time_ms = platform_time_ms() - ctx->start_time;
+        if (ctx->on_iteration) ctx->on_iteration(result, ctx->callback_user);
+        max_depth = 0;
+    }
+
+    // Los hilos auxiliares impares comienzan una profundidad más adelante, para no repetir el mismo trabajo
+    for (int depth = 1 + (ctx->thread_id & 1); depth <= max_depth; depth++) {
+        int score = alpha_beta(ctx, game, depth, -INFINITE_SCORE, INFINITE_SCORE, 0);
+        if (ctx->stopped) break;
+
+        // Iteración completa: guardar su variante principal
+        ctx->root_pv_length = ctx->frames[0]->pv_length;
+        memcpy(ctx->root_pv, ctx->frames[0]->pv, ctx->root_pv_length * sizeof(move_t));
+
+        result->score = score;
+        result->depth = depth;
+        result->pv_length = ctx->root_pv_length;
+        memcpy(result->pv, ctx->root_pv, result->pv_length * sizeof(move_t));
+        if (result->pv_length > 0) result->best_move = result->pv[0];
+        result->nodes = search_total_nodes(ctx);
+        result->time_ms = platform_time_ms() - ctx->start_time;
+        if (ctx->on_iteration) ctx->on_iteration(result, ctx->callback_user);
+
+        // Si se encontró un mate, buscar más profundo no cambia el resultado
+        if (abs(score) >= MATE_SCORE - MAX_PLY) break;
+        // Si ya se usó más de la mitad del tiempo, la siguiente iteración no alcanzaría a terminar
+        int64_t soft_deadline = atomic_load(&ctx->soft_deadline);
+        if (soft_deadline && platform_time_ms() >= soft_deadline) break;
+    }
+
+    if (ctx->shared_nodes) atomic_fetch_add(ctx->shared_nodes, ctx->nodes & 1023);
+    result->nodes = search_total_nodes(ctx);
+    result->time_ms = platform_time_ms() - ctx->start_time;
+    result->memory_peak = ctx->arena.peak;
+    result->eval_cache_probes = ctx->eval_cache_probes;
+    result->eval_cache_hits = ctx->eval_cache_hits;
+    arena_free(&ctx->arena);
+    memset(ctx->frames, 0, sizeof(ctx->frames));
+    STATS_COLLECT(&ctx->stats);
+#ifdef FORTUNA_STATS
+    ctx->stats.memory_peak = result->memory_peak;
+#endif
+    result->stats = ctx->stats;
+#ifdef FORTUNA_STATS
+    // En una búsqueda paralela el reporte lo escribe search_run_threads, con los contadores de todos los hilos
+    if (!ctx->shared_nodes) stats_report("total", -1, result->depth, result->time_ms, &result->stats);
+#endif
+    return true;
+}
+
+// Hilo auxiliar de la búsqueda paralela: busca la misma posición con su propia copia del tablero
+typedef struct {
+    search_context_t ctx;
+    gamestate_t game;
+    search_result_t result;
+} search_helper_t;
+
+static void* search_helper_main(void *arg) {
+    search_helper_t *helper = arg;
+    search_run(&helper->ctx, &helper->game, &helper->result);
+    return NULL;
+}
+
+/**
+ * Búsqueda en paralelo (Lazy SMP): todos los hilos buscan la misma posición y comparten la tabla de transposición,
+ * así que cada uno aprovecha los resultados de los demás. El resultado es el del hilo principal (ctx).
+ * Con ctx->params.use_mcts todos los hilos comparten el árbol de MCTS (ver mcts_run).
+ * https://www.chessprogramming.org/Lazy_SMP
+ * @param ctx: contexto del hilo principal (con sus límites, tabla y callbacks).
+ * @param game: posición a analizar.
+ * @param threads: cantidad total de hilos (1 = equivalente a search_run).
+ * @param result: resultado de la búsqueda (nodes incluye los nodos de todos los hilos).
+ */
+bool search_run_threads(search_context_t *ctx, gamestate_t *game, int threads, search_result_t *result) {
+    if (ctx->params.use_mcts) return mcts_run(ctx, game, threads, result);
+    if (threads <= 1) return search_run(ctx, game, result);
+
+    search_helper_t *helpers = malloc((threads - 1) * sizeof(search_helper_t));
+    pthread_t *thread_ids = malloc((threads - 1) * sizeof(pthread_t));
+    if (!helpers || !thread_ids) {
+        free(helpers);
+        free(thread_ids);
+        return search_run(ctx, game, result);
+    }
+
+    atomic_uint_fast64_t nodes = 0;
+    atomic_bool helpers_stop = false;
+    search_limits_t no_limits = {0};
+    tt_new_search(ctx->tt);
+    ctx->shared_nodes = &nodes;
+
+    // Los hilos auxiliares no tienen límites: se detienen cuando termina el hilo principal.
+    // Si no se puede crear un hilo, se busca con los que ya están
+    int started = 0;
+    for (int i = 0; i < threads - 1; i++) {
+        search_helper_t *helper = &helpers[started];
+        search_init(&helper->ctx, &no_limits, &helpers_stop);
+        helper->ctx.tt = ctx->tt;
+        helper->ctx.eval_cache = ctx->eval_cache;
+        helper->ctx.params = ctx->params;
+        helper->ctx.history_keys = ctx->history_keys;
+        helper->ctx.history_count = ctx->history_count;
+        helper->ctx.shared_nodes = &nodes;
+        helper->ctx.thread_id = started + 1;
+        helper->game = *game;
+        if (pthread_create(&thread_ids[started], NULL, search_helper_main, helper) == 0) started++;
+    }
+
+    bool found = search_run(ctx, game, result);
+
+    atomic_store(&helpers_stop, true);
+    for (int i = 0; i < started; i++) {
+        pthread_join(thread_ids[i], NULL);
+    }
+    result->nodes = atomic_load(&nodes);
+    ctx->shared_nodes = NULL;
+    for (int i = 0; i < started; i++) {
+        stats_merge(&result->stats, &helpers[i].ctx.stats);
+        if (helpers[i].result.memory_peak > result->memory_peak) result->memory_peak = helpers[i].result.memory_peak;
+        result->eval_cache_probes += helpers[i].result.eval_cache_probes;
+        result->eval_cache_hits += helpers[i].result.eval_cache_hits;
+    }
+#ifdef FORTUNA_STATS
+    stats_report("thread", 0, result->depth, result->time_ms, &ctx->stats);
+    for (int i = 0; i < started; i++) {
+        stats_report("thread", i + 1, helpers[i].result.depth, helpers[i].result.time_ms, &helpers[i].ctx.stats);
+    }
+    stats_report("total", -1, result->depth, result->time_ms, &result->stats);
+#endif
+
+    free(helpers);
+    free(thread_ids);
+    return found;
+}
+
+/**
+ * Fija el tiempo máximo de la búsqueda, contado desde ahora. Se puede llamar desde otro hilo mientras la búsqueda
+ * corre: así una búsqueda sin límite (pondering) se convierte en una búsqueda con tiempo sin perder lo ya calculado.
+ * @param ctx: contexto de la búsqueda.
+ * @param movetime_ms: tiempo disponible desde este momento.
+ */
+void search_set_deadline(search_context_t *ctx, int64_t movetime_ms) {
+    int64_t now = platform_time_ms();
+    atomic_store(&ctx->soft_deadline, now + movetime_ms / 2);
+    atomic_store(&ctx->deadline, now + movetime_ms);
+}
+
+/**
+ * Calcula cuánto tiempo usar en una jugada a partir del reloj de la partida.
+ * @param time_left: tiempo restante en el reloj (ms).
+ * @param increment: incremento por jugada (ms).
+ * @param moves_to_go: jugadas hasta el próximo control de tiempo (0 = muerte súbita).
+ * @return tiempo máximo para la jugada (ms).
+ */
+int64_t search_time_for_move(int64_t time_left, int64_t increment, int moves_to_go) {
+    if (moves_to_go <= 0) moves_to_go = 30;
+    int64_t time = time_left / moves_to_go + increment * 3 / 4;
+    // Margen de seguridad para no perder por tiempo (comunicación con la interfaz, etc.)
+    int64_t max_time = time_left - 50;
+    if (time > max_time) time = max_time;
+    if (time < 1) time = 1;
+    return time;
+}
+
+/**
+ * Convierte un puntaje a la notación de UCI: "cp 35" (centipeones) o "mate 3" / "mate -2" (jugadas hasta el mate).
+ * @param score: puntaje desde la perspectiva del jugador que mueve.
+ * @param str: buffer de al menos 16 caracteres.
+ */
+void search_score_to_string(int score, char *str) {
+    if (score >= MATE_SCORE - MAX_PLY) {
+        sprintf(str, "mate %d", (MATE_SCORE - score + 1) / 2);
+    } else if (score <= -MATE_SCORE + MAX_PLY) {
+        sprintf(str, "mate %d", -(MATE_SCORE + score) / 2);
+    } else {
+        sprintf(str, "cp %d", score);
+    }
+}
+
+/**
+ * Claves de las posiciones anteriores de la partida, tomadas del historial de jugadas (para ctx->history_keys):
+ * así la búsqueda ve las repeticiones con las jugadas ya hechas, igual que en UCI y en los matches.
+ * @param include_current: agrega al final la clave de la posición actual (si la búsqueda empieza una jugada después).
+ * @param count: recibe la cantidad de claves.
+ * @return las claves (se liberan con free), o NULL si no hay claves o no hay memoria.
+ */
+static uint64_t* game_history_keys(const gamestate_t *game, bool include_current, int *count) {
+    int size = game->move_history ? stack_size(game->move_history) : 0;
+    *count = 0;
+    if (size == 0 && !include_current) return NULL;
+    uint64_t *keys = malloc((size + 1) * sizeof(uint64_t));
+    if (!keys) return NULL;
+    for (int i = 0; i < size; i++) {
+        const history_entry_t *entry = stack_get(game->move_history, i);
+        keys[i] = entry->undo.key;
+    }
+    if (include_current) keys[size++] = game->key;
+    *count = size;
+    return keys;
+}
+
+/**
+ * Busca la mejor jugada con los límites dados e imprime el resultado (usada en el modo Jugador vs CPU).
+ * @param game: posición actual.
+ * @param limits: límites de la búsqueda.
+ * @param tt: tabla de transposición (puede ser NULL).
+ * @param result: resultado de la búsqueda (incluye la variante principal, usada para el pondering).
+ * @return false si no hay movimientos legales.
+ */
+bool bot_search(gamestate_t *game, const search_limits_t *limits, tt_t *tt, search_result_t *result) {
+    search_context_t *ctx = malloc(sizeof(search_context_t));
+    if (!ctx) return false;
+
+    search_init(ctx, limits, NULL);
+    ctx->tt = tt;
+    uint64_t *history_keys = game_history_keys(game, false, &ctx->history_count);
+    ctx->history_keys = history_keys;
+    bool found = search_run(ctx, game, result);
+    free(history_keys);
+    free(ctx);
+
     // Imprimir el mejor movimiento encontrado
-    print_search_info(game, depth, best_score, &best_move);
-    
-    return best_move;
+    if (found) print_search_info(game, result->depth, result->score, &result->best_move);
+    return found;
+}
+
+// Tabla de transposición de find_best_move (se conserva entre llamadas)
+static tt_t bot_tt;
+
+// Función principal para encontrar el mejor movimiento a una profundidad fija
+move_t find_best_move(gamestate_t *game, int depth) {
+    search_limits_t limits = { .depth = depth };
+    search_result_t result;
+    move_t null_move = {0};
+
+    printf("Explorando estados con profunidad = %d...\n", depth);
+    if (!bot_tt.entries) tt_init(&bot_tt, TT_DEFAULT_MB);
+    if (!bot_search(game, &limits, &bot_tt, &result)) {
+        // No hay movimientos legales
+        return null_move;
+    }
+    return result.best_move;
+}
+
+static void* ponder_thread_main(void *arg) {
+    ponder_t *ponder = arg;
+    ponder->found = search_run(ponder->ctx, &ponder->game, &ponder->result);
+    return NULL;
+}
+
+/**
+ * Comienza a buscar (en otro hilo y sin límite de tiempo) la posición que resultaría si el rival juega 'expected'.
+ * @param ponder: estado del pondering.
+ * @param game: posición actual (le toca al rival).
+ * @param expected: jugada esperada del rival (normalmente la segunda jugada de la variante principal).
+ * @param tt: tabla de transposición, compartida con la búsqueda normal.
+ * @return false si no se pudo iniciar.
+ */
+bool ponder_start(ponder_t *ponder, const gamestate_t *game, const move_t *expected, tt_t *tt) {
+    search_limits_t no_limits = {0};
+    memset(ponder, 0, sizeof(ponder_t));
+    ponder->ctx = malloc(sizeof(search_context_t));
+    if (!ponder->ctx) return false;
+
+    ponder->game = *game;
+    ponder->expected = *expected;
+    make_move(&ponder->expected, &ponder->game, false);
+
+    // El contexto se inicializa antes de crear el hilo, para que ponder_hit pueda fijar el tiempo en cualquier momento
+    atomic_store(&ponder->stop, false);
+    search_init(ponder->ctx, &no_limits, &ponder->stop);
+    ponder->ctx->tt = tt;
+    // La posición de la búsqueda viene después de la jugada esperada: la actual también cuenta para las repeticiones
+    ponder->history_keys = game_history_keys(game, true, &ponder->ctx->history_count);
+    ponder->ctx->history_keys = ponder->history_keys;
+    if (pthread_create(&ponder->thread, NULL, ponder_thread_main, ponder) != 0) {
+        free(ponder->history_keys);
+        free(ponder->ctx);
+        ponder->history_keys = NULL;
+        ponder->ctx = NULL;
+        return false;
+    }
+    ponder->running = true;
+    return true;
+}
+
+/**
+ * Informa la jugada real del rival. Si coincide con la esperada (ponder hit), la búsqueda sigue con todo lo
+ * calculado y pasa a tener 'movetime_ms' desde ahora. Si no coincide, la búsqueda se cancela (la tabla queda con
+ * las posiciones ya analizadas, que se aprovechan en la siguiente búsqueda).
+ * @return true si fue un ponder hit (el resultado se obtiene con ponder_wait).
+ */
+bool ponder_hit(ponder_t *ponder, const move_t *played, int64_t movetime_ms) {
+    if (!ponder->running) return false;
+    if (tt_pack_move(played) != tt_pack_move(&ponder->expected)) {
+        ponder_stop(ponder);
+        return false;
+    }
+    search_set_deadline(ponder->ctx, movetime_ms);
+    return true;
+}
+
+// Cancela el pondering en curso (si existe)
+void ponder_stop(ponder_t *ponder) {
+    if (!ponder->running) return;
+    atomic_store(&ponder->stop, true);
+    pthread_join(ponder->thread, NULL);
+    free(ponder->history_keys);
+    free(ponder->ctx);
+    ponder->history_keys = NULL;
+    ponder->ctx = NULL;
+    ponder->running = false;
+}
+
+/**
+ * Espera a que termine la búsqueda después de un ponder hit.
+ * @param result: resultado de la búsqueda (desde la posición después de la jugada esperada).
+ * @return false si la búsqueda no encontró jugadas legales.
+ */
+bool ponder_wait(ponder_t *ponder, search_result_t *result) {
+    if (!ponder->running) return false;
+    pthread_join(ponder->thread, NULL);
+    free(ponder->history_keys);
+    free(ponder->ctx);
+    ponder->history_keys = NULL;
+    ponder->ctx = NULL;
+    ponder->running = false;
+    *result = ponder->result;
+    return ponder->found;
 }
 
 // Función auxiliar para imprimir información de búsqueda
@@ -1,13 +1,139 @@
 #pragma once
 #include <stdio.h>
 #include <limits.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
 #include "chess.h"
+#include "platform.h"
+#include "tt.h"
+#include "evalcache.h"
+#include "zobrist.h"
+#include "stats.h"
+#include "arena.h"
+#include "pawns.h"
+#include "eval.h"
+#include "kpk.h"
+#include "material.h"
+#include "tablebase.h"
+
+#define MAX_PLY 64                  // Profundidad máxima de búsqueda (en medios movimientos)
+#define INFINITE_SCORE 32000
+#define MATE_SCORE 30000            // Puntaje de jaque mate (se le resta la distancia en plies a la raíz)
+#define TB_WIN_SCORE (MATE_SCORE - 2 * MAX_PLY)    // Victoria según las tablas de finales (por debajo de los mates)
+#define SEARCH_MAX_THREADS 64       // Hilos de una búsqueda paralela con estadísticas por hilo (ver search_result_t)
+
+// Límites de una búsqueda. Un valor 0 significa "sin límite"
+typedef struct {
+    int depth;                      // Profundidad máxima
+    int64_t movetime_ms;            // Tiempo máximo en milisegundos
+    uint64_t nodes;                 // Cantidad máxima de nodos
+} search_limits_t;
+
+// Parámetros de la búsqueda. Permiten comparar configuraciones entre sí (ver match.c)
+typedef struct {
+    bool use_tt;                    // Usar la tabla de transposición para cortes y orden de jugadas
+    bool use_pvs;                   // Búsqueda de variante principal (ventana nula después de la primera jugada)
+    int mobility_weight;            // Peso de cada jugada legal en la evaluación
+    bool use_nnue;                  // Evaluar con la red neuronal si hay una cargada (ver nnue.h)
+    bool use_mcts;                  // Búsqueda de árbol Monte Carlo en vez de alfa-beta (ver mcts.h)
+    int mcts_exploration;           // Constante de exploración de UCT, en centésimas
+    int mcts_leaf_depth;            // Profundidad de la búsqueda que estima cada hoja de MCTS (0 = evaluación estática)
+    int mcts_rollout_plies;         // Jugadas al azar antes de estimar una hoja de MCTS (0 = sin rollout)
+} search_params_t;
+
+extern const search_params_t search_default_params;
+
+// Resultado de una búsqueda
+typedef struct {
+    move_t best_move;
+    int score;                      // Desde la perspectiva del jugador que mueve
+    int depth;                      // Última profundidad completada
+    uint64_t nodes;
+    int64_t time_ms;
+    move_t pv[MAX_PLY];             // Variante principal
+    int pv_length;
+    search_stats_t stats;           // Contadores de todos los hilos (solo con FORTUNA_STATS, ver stats.h)
+    size_t memory_peak;             // Memoria temporal máxima usada por un hilo de la búsqueda (bytes)
+    uint64_t eval_cache_probes;     // Consultas y aciertos de la caché de evaluaciones (todos los hilos)
+    uint64_t eval_cache_hits;
+    uint64_t playouts;              // Simulaciones de MCTS de todos los hilos (0 con alfa-beta)
+    int threads;                    // Hilos de MCTS, con sus simulaciones en thread_playouts
+    uint64_t thread_playouts[SEARCH_MAX_THREADS];
+} search_result_t;
+
+// Datos de la búsqueda en un ply. Se reservan en la arena del hilo la primera vez que se llega a ese ply
+typedef struct {
+    move_list_t moves;
+    int scores[256];                // Puntaje de orden de cada jugada de 'moves'
+    fast_undo_t undo;
+    move_t pv[MAX_PLY];             // Variante principal desde este ply (tabla triangular)
+    int pv_length;
+} search_frame_t;
+
+// Estado de una búsqueda en curso (uno por hilo)
+typedef struct {
+    search_limits_t limits;
+    search_params_t params;         // search_init usa search_default_params
+    atomic_bool *stop;              // Señal externa para detener la búsqueda (puede ser NULL)
+    bool stopped;
+    uint64_t nodes;
+    int64_t start_time;
+    // Tiempos límite absolutos (0 = sin límite). Son atómicos porque otro hilo puede fijarlos durante la búsqueda (pondering)
+    atomic_int_least64_t deadline;      // La búsqueda se corta al llegar a este tiempo
+    atomic_int_least64_t soft_deadline; // No se comienza una nueva iteración después de este tiempo
+    // Tiempo límite de otro contexto que también corta esta búsqueda, aunque se fije después (opcional, ej: MCTS)
+    atomic_int_least64_t *shared_deadline;
+    int thread_id;                  // 0 = hilo principal
+    tt_t *tt;                       // Tabla de transposición (opcional, puede compartirse entre hilos)
+    evalcache_t *eval_cache;        // Caché de evaluaciones (opcional, puede compartirse entre hilos con los mismos params)
+    uint64_t eval_cache_probes;
+    uint64_t eval_cache_hits;
+    atomic_uint_fast64_t *shared_nodes; // Contador de nodos de todos los hilos (solo en búsquedas paralelas)
+    // Claves de las posiciones anteriores a la raíz, en orden (opcional, para detectar repeticiones)
+    const uint64_t *history_keys;
+    int history_count;
+    // Se llama al completar cada iteración (opcional, ej: para las líneas "info" de UCI)
+    void (*on_iteration)(const search_result_t *result, void *user);
+    void *callback_user;
+    uint64_t path_keys[MAX_PLY];    // Claves de las posiciones desde la raíz hasta el nodo actual
+    search_frame_t *frames[MAX_PLY];    // Datos por ply (en 'arena', válidos solo durante search_run)
+    arena_t arena;                  // Memoria temporal de la búsqueda: se reserva en search_run y se libera al terminar
+    pool_t *pool;                   // Pool de la sesión del que la arena saca sus bloques (opcional, no se comparte entre hilos)
+    move_t root_pv[MAX_PLY];        // Variante principal de la última iteración completa
+    int root_pv_length;
+    search_stats_t stats;           // Contadores de este hilo al terminar la búsqueda (solo con FORTUNA_STATS)
+} search_context_t;
+
+// Pondering: búsqueda en segundo plano de la posición esperada mientras el rival piensa
+// https://www.chessprogramming.org/Pondering
+typedef struct {
+    search_context_t *ctx;
+    uint64_t *history_keys;         // Claves de la partida hasta la posición actual (las usa ctx)
+    gamestate_t game;               // Posición después de la jugada esperada
+    move_t expected;                // Jugada esperada del rival
+    search_result_t result;
+    bool found;
+    bool running;
+    atomic_bool stop;
+    pthread_t thread;
+} ponder_t;
 
 void filter_legal_moves(gamestate_t *game, move_list_t *moves);
-int evaluate_position(gamestate_t *game);
 int is_game_over(gamestate_t *game);
 int score_move(gamestate_t *game, move_t *move);
 void sort_moves(gamestate_t *game, move_list_t *moves);
-int alpha_beta(gamestate_t *game, int depth, int alpha, int beta, int maximizing_player);
+int alpha_beta(search_context_t *ctx, gamestate_t *game, int depth, int alpha, int beta, int ply);
+void search_init(search_context_t *ctx, const search_limits_t *limits, atomic_bool *stop);
+bool search_run(search_context_t *ctx, gamestate_t *game, search_result_t *result);
+bool search_run_threads(search_context_t *ctx, gamestate_t *game, int threads, search_result_t *result);
+void search_set_deadline(search_context_t *ctx, int64_t movetime_ms);
+int64_t search_time_for_move(int64_t time_left, int64_t increment, int moves_to_go);
+void search_score_to_string(int score, char *str);
+bool bot_search(gamestate_t *game, const search_limits_t *limits, tt_t *tt, search_result_t *result);
 move_t find_best_move(gamestate_t *game, int depth);
+bool ponder_start(ponder_t *ponder, const gamestate_t *game, const move_t *expected, tt_t *tt);
+bool ponder_hit(ponder_t *ponder, const move_t *played, int64_t movetime_ms);
+void ponder_stop(ponder_t *ponder);
+bool ponder_wait(ponder_t *ponder, search_result_t *result);
 void print_search_info(gamestate_t *game, int depth, int score, move_t *move);
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "chess.h"
+#include "zobrist.h"
+#include "stats.h"
 
 // Añade un movimiento a la lista de movimientos
 void add_move(move_list_t *list, int from, int to, int piece, int captured, int promotion, int flags) {
@@ -67,6 +69,10 @@ void init_board(gamestate_t *game) {
     // Inicializar pila de historial de movimientos y contador de jugadas
     game->move_history = stack_create(sizeof(history_entry_t));
     game->move_count = 0;
+    game->key = polyglot_hash_position(game);
+    game->pawn_key = zobrist_pawn_key(game);
+    game->material_key = compute_material_key(game);
+    game->nnue.generation = 0;
 }
 
 // Se tuvo que implementar para evitar problemas de compilación cuando se usan algunas versiones de MINGW64-gcc en Windows
@@ -242,6 +248,10 @@ int init_board_fen(gamestate_t *game, const char *fen) {
     
     // Inicializar contador de movimientos
     game->move_count = 0;
+    game->key = polyglot_hash_position(game);
+    game->pawn_key = zobrist_pawn_key(game);
+    game->material_key = compute_material_key(game);
+    game->nnue.generation = 0;
     
     free(fen_copy);
     return 0;  // Éxito
@@ -278,6 +288,25 @@ void square_to_algebraic(int square, char *algebraic) {
     algebraic[2] = '\0';
 }
 
+/**
+ * Convierte un movimiento a notación de coordenadas (ej: "e2e4", "e7e8q"), la misma que usa UCI.
+ * @param move: movimiento a convertir.
+ * @param str: buffer de al menos 6 caracteres.
+ */
+void move_to_string(const move_t *move, char *str) {
+    square_to_algebraic(move->from, str);
+    square_to_algebraic(move->to, str + 2);
+    if (move->flags == MOVE_PROMOTION) {
+        switch (move->promotion) {
+            case KNIGHT: str[4] = 'n'; break;
+            case BISHOP: str[4] = 'b'; break;
+            case ROOK:   str[4] = 'r'; break;
+            default:     str[4] = 'q'; break;
+        }
+        str[5] = '\0';
+    }
+}
+
 /**
  * Convierte un estado de juego en una cadena FEN (Forsyth-Edwards Notation).
  * @param gs Puntero al estado actual del juego
@@ -677,15 +706,129 @@ bool is_legal_move(move_t *move, gamestate_t *game) {
         }
     }
     
-    // Simular jugada y verificar jaque
-    gamestate_t temp_game = *game;
-    make_move(move, &temp_game, false);
-    if (is_in_check(&temp_game, piece_color)) 
-        return false;
+    // Simular jugada y verificar jaque (sobre el mismo tablero, que se restaura después, sin copiar la posición)
+    fast_undo_t undo_info;
+    prepare_fast_undo(game, move, &undo_info);
+    make_move(move, game, false);
+    bool in_check = is_in_check(game, piece_color);
+    fast_unmake_move(game, move, &undo_info);
     
+    return !in_check;
+}
+
+// Piezas clavadas del bando que mueve: no pueden salir de la línea entre su rey y la pieza que las clava
+typedef struct {
+    int count;
+    int square[8];
+    int dir[8];                     // Dirección desde el rey hacia la pieza clavada
+    int pinner[8];                  // Casilla de la pieza que clava
+} pin_info_t;
+
+// Busca en las 8 direcciones del rey una pieza propia seguida de un alfil, torre o reina rival
+static void find_pins(gamestate_t *game, int color, int king, pin_info_t *pins) {
+    pins->count = 0;
+    for (int i = 0; i < 8; i++) {
+        int dir = king_moves[i];
+        bool diagonal = i == 0 || i == 2 || i == 5 || i == 7;
+        int pinned = -1;
+        for (int sq = king + dir; IS_VALID_SQUARE(sq); sq += dir) {
+            int piece = game->board[sq];
+            if (piece == EMPTY) continue;
+            if (COLOR(piece) == color) {
+                if (pinned >= 0) break;
+                pinned = sq;
+                continue;
+            }
+            int type = PIECE_TYPE(piece);
+            if (pinned >= 0 && (type == QUEEN || type == (diagonal ? BISHOP : ROOK))) {
+                pins->square[pins->count] = pinned;
+                pins->dir[pins->count] = dir;
+                pins->pinner[pins->count] = sq;
+                pins->count++;
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * Legalidad de un movimiento generado por generate_moves, sin simular la jugada en los casos comunes.
+ * Solo se revisa que el rey propio no quede en jaque: las reglas de movimiento ya las cumple el generador.
+ * Los jaques, capturas en passant y enroques (poco frecuentes) usan la validación completa de is_legal_move.
+ */
+static bool is_generated_move_legal(gamestate_t *game, move_t *move, int king, bool in_check, const pin_info_t *pins) {
+    STATS_INC(legality_checks);
+    if (in_check || move->flags == MOVE_EN_PASSANT || move->flags == MOVE_CASTLE_KING || move->flags == MOVE_CASTLE_QUEEN) {
+        return is_legal_move(move, game);
+    }
+    if (move->from == king) {
+        // La casilla de destino no puede estar atacada (sin el rey, para que no tape los ataques en línea)
+        int piece = game->board[king];
+        game->board[king] = EMPTY;
+        bool attacked = is_square_attacked(game, move->to, COLOR(piece) ^ BLACK);
+        game->board[king] = piece;
+        return !attacked;
+    }
+    for (int i = 0; i < pins->count; i++) {
+        if (pins->square[i] != move->from) continue;
+        // Una pieza clavada solo puede moverse sobre la línea entre el rey y la pieza que la clava
+        for (int sq = king + pins->dir[i]; sq != pins->pinner[i]; sq += pins->dir[i]) {
+            if (sq == move->to) return true;
+        }
+        return move->to == pins->pinner[i];
+    }
     return true;
 }
 
+/**
+ * Elimina de la lista los movimientos que dejan al rey propio en jaque.
+ * Las clavadas y el jaque se calculan una sola vez para toda la lista.
+ * @param game: posición en la que se generaron los movimientos (con generate_moves).
+ * @param list: lista de movimientos pseudo-legales; queda solo con los legales, en el mismo orden.
+ */
+void remove_illegal_moves(gamestate_t *game, move_list_t *list) {
+    int color = game->to_move;
+    int king = game->king_square[color];
+    bool in_check = is_square_attacked(game, king, color ^ BLACK);
+    pin_info_t pins;
+    find_pins(game, color, king, &pins);
+
+    int write_idx = 0;
+    for (int i = 0; i < list->count; i++) {
+        if (is_generated_move_legal(game, &list->moves[i], king, in_check, &pins)) {
+            list->moves[write_idx++] = list->moves[i];
+        }
+    }
+    list->count = write_idx;
+}
+
+// Genera solo los movimientos legales del jugador en turno
+void generate_legal_moves(gamestate_t *game, move_list_t *list) {
+    generate_moves(game, list);
+    remove_illegal_moves(game, list);
+}
+
+// Piezas que salen y entran al tablero con una jugada, para actualizar el acumulador de la red (ver nnue.h)
+// @param captured: pieza que estaba en la casilla de destino antes de la jugada.
+static void move_features(const move_t *move, int captured, int *removed, int *removed_count, int *added, int *added_count) {
+    int color = COLOR(move->piece);
+    int placed = move->flags == MOVE_PROMOTION ? MAKE_PIECE(move->promotion, color) : move->piece;
+    *removed_count = 0;
+    *added_count = 0;
+    removed[(*removed_count)++] = NNUE_FEATURE(move->piece, move->from);
+    added[(*added_count)++] = NNUE_FEATURE(placed, move->to);
+    if (captured != EMPTY) removed[(*removed_count)++] = NNUE_FEATURE(captured, move->to);
+    if (move->flags == MOVE_EN_PASSANT) {
+        int captured_pawn_square = move->to + (color == WHITE ? -16 : 16);
+        removed[(*removed_count)++] = NNUE_FEATURE(MAKE_PIECE(PAWN, 1 - color), captured_pawn_square);
+    } else if (move->flags == MOVE_CASTLE_KING || move->flags == MOVE_CASTLE_QUEEN) {
+        int rook = MAKE_PIECE(ROOK, color);
+        bool king_side = move->flags == MOVE_CASTLE_KING;
+        removed[(*removed_count)++] = NNUE_FEATURE(rook, king_side ? move->from + 3 : move->from - 4);
+        added[(*added_count)++] = NNUE_FEATURE(rook, king_side ? move->from + 1 : move->from - 1);
+    }
+}
+
 /**
  * Realiza un movimiento en el tablero y actualiza el estado del juego.
  * Esta función asume que el movimiento ha sido validado como legal.
@@ -694,16 +837,13 @@ bool is_legal_move(move_t *move, gamestate_t *game) {
  * @param committed: determina si el movimiento se deberia guardar en el historial (stack *move_history).
  */
 void make_move(move_t *move, gamestate_t *game, bool committed) {
+    STATS_INC(make_moves);
 
     if (committed) {
         // Guardar estado actual en el historial (stack) antes de realizar el movimiento
         history_entry_t history;
         history.move = *move;
-        memcpy(history.old_board, game->board, sizeof(game->board));
-        history.old_castling_rights = game->castling_rights;
-        history.old_en_passant_square = game->en_passant_square;
-        history.old_halfmove_clock = game->halfmove_clock;
-        history.old_fullmove_number = game->fullmove_number;
+        prepare_fast_undo(game, move, &history.undo);
         // Agregar a la pila
         stack_push(game->move_history, &history);
         game->move_count++;
@@ -712,6 +852,29 @@ void make_move(move_t *move, gamestate_t *game, bool committed) {
     int moving_piece = move->piece;
     int piece_type = PIECE_TYPE(moving_piece);
     int piece_color = COLOR(moving_piece);
+
+    // La clave se actualiza de forma incremental: se quitan enroques y en passant anteriores,
+    // y al final se agregan los nuevos
+    uint64_t key = game->key ^ zobrist_castling_key(game->castling_rights) ^ zobrist_en_passant_key(game);
+    key ^= zobrist_piece_key(moving_piece, move->from);
+    if (game->board[move->to] != EMPTY) {
+        key ^= zobrist_piece_key(game->board[move->to], move->to);
+    }
+    // La clave de peones solo cambia si se mueve o se captura un peón
+    uint64_t pawn_key = game->pawn_key;
+    if (piece_type == PAWN) pawn_key ^= zobrist_piece_key(moving_piece, move->from);
+    if (game->board[move->to] != EMPTY && PIECE_TYPE(game->board[move->to]) == PAWN) {
+        pawn_key ^= zobrist_piece_key(game->board[move->to], move->to);
+    }
+    // La clave de material solo cambia con capturas y promociones
+    uint64_t material_key = game->material_key;
+    if (game->board[move->to] != EMPTY) material_key -= MATERIAL_KEY_PIECE(game->board[move->to]);
+    // El acumulador de la red solo se actualiza si ya estaba calculado (si no, se calcula al evaluar)
+    if (nnue_valid(&game->nnue)) {
+        int removed[4], added[4], removed_count, added_count;
+        move_features(move, game->board[move->to], removed, &removed_count, added, &added_count);
+        nnue_update(&game->nnue, removed, removed_count, added, added_count);
+    }
     
     // Mueve la pieza
     game->board[move->from] = EMPTY;
@@ -720,11 +883,17 @@ void make_move(move_t *move, gamestate_t *game, bool committed) {
     // Promoción
     if (move->flags == MOVE_PROMOTION) {
         game->board[move->to] = MAKE_PIECE(move->promotion, piece_color);
+        material_key += MATERIAL_KEY_PIECE(game->board[move->to]) - MATERIAL_KEY_PIECE(moving_piece);
     }
+    key ^= zobrist_piece_key(game->board[move->to], move->to);
+    if (PIECE_TYPE(game->board[move->to]) == PAWN) pawn_key ^= zobrist_piece_key(game->board[move->to], move->to);
     
     // Captura al paso
     if (move->flags == MOVE_EN_PASSANT) {
         int captured_pawn_square = move->to + (piece_color == WHITE ? -16 : 16);
+        key ^= zobrist_piece_key(game->board[captured_pawn_square], captured_pawn_square);
+        pawn_key ^= zobrist_piece_key(game->board[captured_pawn_square], captured_pawn_square);
+        material_key -= MATERIAL_KEY_PIECE(game->board[captured_pawn_square]);
         game->board[captured_pawn_square] = EMPTY;
     }
     
@@ -740,6 +909,7 @@ void make_move(move_t *move, gamestate_t *game, bool committed) {
             rook_to = move->from - 1;
         }
         
+        key ^= zobrist_piece_key(game->board[rook_from], rook_from) ^ zobrist_piece_key(game->board[rook_from], rook_to);
         game->board[rook_to] = game->board[rook_from];
         game->board[rook_from] = EMPTY;
     }
@@ -808,6 +978,11 @@ void make_move(move_t *move, gamestate_t *game, bool committed) {
     
     // Cambia el turno
     game->to_move = (game->to_move == WHITE) ? BLACK : WHITE;
+
+    // Nuevos derechos de enroque, en passant (depende del turno) y turno
+    game->key = key ^ zobrist_castling_key(game->castling_rights) ^ zobrist_en_passant_key(game) ^ zobrist_turn_key();
+    game->pawn_key = pawn_key;
+    game->material_key = material_key;
 }
 
 /**
@@ -827,26 +1002,9 @@ void unmake_move(gamestate_t *game) {
         return;
     }
     game->move_count--;
-    
-    move_t *move = &history.move;
-    
-    // Restaurar turno
-    game->to_move = 1 - game->to_move;
-    
-    // Restaurar tablero. Se podría hacer con la información que se guarda en history.move
-    // Pero restaurar todo el tablero es más fácil/directo, aunque un poco más lento
-    // No se necesitan restaurar las piezas manualmente en caso de enroque, etc.
-    memcpy(game->board, history.old_board, sizeof(game->board));
-    
-    // Restaurar la posición de los reyes
-    if (PIECE_TYPE(move->piece) == KING)
-        game->king_square[COLOR(move->piece)] = move->from;
 
-    // Restaurar estado de juego
-    game->castling_rights = history.old_castling_rights;
-    game->en_passant_square = history.old_en_passant_square;
-    game->halfmove_clock = history.old_halfmove_clock;
-    game->fullmove_number = history.old_fullmove_number;
+    // El historial guarda la misma información que usa la búsqueda para deshacer jugadas
+    fast_unmake_move(game, &history.move, &history.undo);
 }
 
 // Función auxiliar que guarda el estado necesario en fast_undo_t para un deshacer rápido.
@@ -859,6 +1017,9 @@ void prepare_fast_undo(gamestate_t *game, move_t *move, fast_undo_t *undo_info)
     undo_info->king_square[WHITE] = game->king_square[WHITE];
     undo_info->king_square[BLACK] = game->king_square[BLACK];
     undo_info->captured_piece = game->board[move->to];
+    undo_info->key = game->key;
+    undo_info->pawn_key = game->pawn_key;
+    undo_info->material_key = game->material_key;
 }
 
 /**
@@ -873,6 +1034,7 @@ void prepare_fast_undo(gamestate_t *game, move_t *move, fast_undo_t *undo_info)
  * @param undo_info: puntero a la estructura que contiene la información para revertir el estado.
  */
 void fast_unmake_move(gamestate_t *game, move_t *move, fast_undo_t *undo_info) {
+    STATS_INC(unmake_moves);
     // Restaurar flags del estado de juego
     game->castling_rights = undo_info->castling_rights;
     game->en_passant_square = undo_info->en_passant_square;
@@ -880,6 +1042,15 @@ void fast_unmake_move(gamestate_t *game, move_t *move, fast_undo_t *undo_info) {
     game->fullmove_number = undo_info->fullmove_number;
     game->king_square[WHITE] = undo_info->king_square[WHITE];
     game->king_square[BLACK] = undo_info->king_square[BLACK];
+    game->key = undo_info->key;
+    game->pawn_key = undo_info->pawn_key;
+    game->material_key = undo_info->material_key;
+    if (nnue_valid(&game->nnue)) {
+        // Las mismas piezas de make_move, al revés
+        int removed[4], added[4], removed_count, added_count;
+        move_features(move, undo_info->captured_piece, removed, &removed_count, added, &added_count);
+        nnue_update(&game->nnue, added, added_count, removed, removed_count);
+    }
     
     // Devolver el turno al jugador correspondiente
     game->to_move = 1 - game->to_move;
@@ -1113,6 +1284,7 @@ void generate_king_moves(gamestate_t *game, move_list_t *list, int from) {
  * @param list: puntero a la lista donde se agregarán todos los movimientos válidos.
  */
 void generate_moves(gamestate_t *game, move_list_t *list) {
+    STATS_INC(movegen_calls);
     list->count = 0;
     
     for (int square = 0; square < BOARD_SIZE; square++) {
@@ -1169,9 +1341,14 @@ const char* get_game_result_name(game_result_t result) {
 bool has_legal_moves(gamestate_t *game) {
     move_list_t list;
     generate_moves(game, &list);
-    
+
+    int color = game->to_move;
+    int king = game->king_square[color];
+    bool in_check = is_square_attacked(game, king, color ^ BLACK);
+    pin_info_t pins;
+    find_pins(game, color, king, &pins);
     for (int i = 0; i < list.count; i++) {
-        if (is_legal_move(&list.moves[i], game)) {
+        if (is_generated_move_legal(game, &list.moves[i], king, in_check, &pins)) {
             return true;
         }
     }
@@ -1211,6 +1388,15 @@ void count_material(gamestate_t *game, int white_material[5], int black_material
     }
 }
 
+// Clave de material calculada desde el tablero (make_move la mantiene de forma incremental)
+uint64_t compute_material_key(const gamestate_t *game) {
+    uint64_t key = 0;
+    for (int sq = 0; sq < BOARD_SIZE; sq = (sq + 9) & ~8) {
+        if (game->board[sq] != EMPTY) key += MATERIAL_KEY_PIECE(game->board[sq]);
+    }
+    return key;
+}
+
 /**
  * Verifica si hay material insuficiente para dar jaque mate.
  * @param game: puntero al estado del juego actual.
@@ -1300,15 +1486,35 @@ game_result_t evaluate_game_state(gamestate_t *game) {
         }
     }
     
-    // TODO: Implementar detección de repetición de posiciones (regla de Triple Repetición)
-    
+    if (is_threefold_repetition(game)) {
+        return GAME_DRAW_REPETITION;
+    }
+
     return GAME_ONGOING;
 }
 
+/**
+ * Verifica si la posición actual ya ocurrió dos veces antes en la partida (triple repetición).
+ * Usa las claves guardadas en el historial, solo desde la última captura o movimiento de peón.
+ * @param game: puntero al estado del juego actual (las jugadas deben haberse hecho con make_move(..., true)).
+ * @return true si la posición se repitió tres veces.
+ */
+bool is_threefold_repetition(gamestate_t *game) {
+    int count = stack_size(game->move_history);
+    int repetitions = 0;
+    // La entrada i guarda la clave de la posición anterior a la jugada i; solo se comparan posiciones con el mismo turno
+    for (int back = 2; back <= game->halfmove_clock && back <= count; back += 2) {
+        history_entry_t *entry = stack_get(game->move_history, count - back);
+        if (entry->undo.key == game->key && ++repetitions >= 2) return true;
+    }
+    return false;
+}
+
 /**
  * Realiza un conteo recursivo de nodos a partir del estado actual del juego.
  * Utilizado para pruebas (perft) de generación de movimientos.
  *  Se usa para verificar que todas las reglas de movimiento estén implementadas correctamente.
+ * En el último nivel no se juegan las jugadas: basta con contar las jugadas legales (bulk counting).
  * @param game: puntero al estado actual del juego.
  * @param depth: profundidad máxima a explorar.
  * @return el número total de nodos generados hasta esa profundidad.
@@ -1318,14 +1524,12 @@ uint64_t perft(gamestate_t *game, int depth) {
     if (depth == 0) return 1;
 
     move_list_t list;
-    generate_moves(game, &list);
+    generate_legal_moves(game, &list);
+    if (depth == 1) return (uint64_t)list.count;
 
     uint64_t total = 0;
-    gamestate_t backup;
-
     for (int i = 0; i < list.count; i++) {
         move_t move = list.moves[i];
-        if (!is_legal_move(&move, game)) continue;
 
         // Guardar el estado del juego
         fast_undo_t undo_info;
@@ -1340,6 +1544,45 @@ uint64_t perft(gamestate_t *game, int depth) {
     return total;
 }
 
+/**
+ * Perft que además clasifica las jugadas del último nivel (capturas, en passant, enroques, promociones,
+ * jaques y jaques mate), como en las tablas de https://www.chessprogramming.org/Perft_Results.
+ * Las capturas, en passant, enroques y promociones se cuentan sin jugar la jugada; solo los jaques requieren simularla.
+ * @param game: posición inicial (se restaura al terminar).
+ * @param depth: profundidad (>= 1).
+ * @param stats: se le suman los conteos (debe inicializarse en 0).
+ */
+void perft_detailed(gamestate_t *game, int depth, perft_stats_t *stats) {
+    move_list_t list;
+    generate_legal_moves(game, &list);
+
+    for (int i = 0; i < list.count; i++) {
+        move_t move = list.moves[i];
+        fast_undo_t undo_info;
+        if (depth > 1) {
+            prepare_fast_undo(game, &move, &undo_info);
+            make_move(&move, game, false);
+            perft_detailed(game, depth - 1, stats);
+            fast_unmake_move(game, &move, &undo_info);
+            continue;
+        }
+
+        stats->nodes++;
+        if (move.captured != EMPTY) stats->captures++;
+        if (move.flags == MOVE_EN_PASSANT) stats->en_passant++;
+        if (move.flags == MOVE_CASTLE_KING || move.flags == MOVE_CASTLE_QUEEN) stats->castles++;
+        if (move.flags == MOVE_PROMOTION) stats->promotions++;
+
+        prepare_fast_undo(game, &move, &undo_info);
+        make_move(&move, game, false);
+        if (is_in_check(game, game->to_move)) {
+            stats->checks++;
+            if (!has_legal_moves(game)) stats->checkmates++;
+        }
+        fast_unmake_move(game, &move, &undo_info);
+    }
+}
+
 /**
  * Ejecuta pruebas de rendimiento de generación de movimientos (perft) hasta cierta profundidad.
  * Muestra en consola el tiempo que toma y el número de nodos por segundo.
@@ -7,6 +7,7 @@
 // TDAs
 #include "stack.h"
 #include "hashtable.h"
+#include "nnue.h"
 
 // La representación 0x88 usa un array de 128 elementos donde solo 64 son válidos
 // Permite detección rápida de casillas válidas usando operación AND con 0x88
@@ -17,6 +18,9 @@
 #define SQUARE(rank, file) (((rank) << 4) | (file))     // Crea una casilla desde fila y columna
 #define IS_VALID_SQUARE(sq) (!((sq) & 0x88))            // Verifica si una casilla es válida en el tablero
 
+// Posición inicial estándar en formato FEN
+#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
 // Definiciones de piezas
 #define EMPTY 0      // Casilla vacía
 #define PAWN 1       // Peón
@@ -33,6 +37,10 @@
 #define PIECE_TYPE(piece) ((piece) & 7)                     // Extrae el tipo de una pieza
 #define MAKE_PIECE(type, color) ((type) | ((color) << 3))   // Crea una pieza dado un tipo y color
 
+// Clave de material: cantidad de piezas de cada tipo y color, 4 bits por pieza (ver material.h)
+#define MATERIAL_KEY_PIECE(piece) (1ULL << (4 * (piece)))                   // Lo que suma una pieza a la clave
+#define MATERIAL_COUNT(key, piece) ((int)(((key) >> (4 * (piece))) & 15))    // Cantidad de piezas iguales a 'piece'
+
 // Flags para tipos especiales de movimientos
 #define MOVE_NORMAL 0        // Movimiento normal
 #define MOVE_CAPTURE 1       // Captura
@@ -83,19 +91,12 @@ typedef struct {
     int king_square[2];             // Posiciones de los reyes en formato [WHITE, BLACK]
     chess_stack_t *move_history;    // Pila que almacena el historial de movimientos realizados
     int move_count;                 // Contador de movimientos realizados
+    uint64_t key;                   // Clave Zobrist (PolyGlot) de la posición, actualizada por make_move
+    uint64_t pawn_key;              // Clave Zobrist solo de los peones (para la tabla de peones, ver pawns.h)
+    uint64_t material_key;          // Cantidad de piezas de cada tipo y color (ver MATERIAL_KEY_PIECE), actualizada por make_move
+    nnue_accumulator_t nnue;        // Primera capa de la red neuronal, actualizada por make_move (ver nnue.h)
 } gamestate_t;
 
-// Estructura que representa una entrada en el historial de movimientos
-typedef struct {
-    move_t move;                    // El movimiento que se realizó
-    // Información adicional que debe ser restaurada (tablero, derechos de enroque, contadores de turnos, etc.)
-    int old_board[BOARD_SIZE];
-    int old_castling_rights;
-    int old_en_passant_square;
-    int old_halfmove_clock;
-    int old_fullmove_number;
-} history_entry_t;
-
 // Estructura que guarda información acerca del estado de juego, menos el tablero
 // Se utiliza para almacenar la información del turno anterior, y poder deshacer de manera rápida
 typedef struct {
@@ -105,8 +106,19 @@ typedef struct {
     int fullmove_number;
     int captured_piece;
     int king_square[2];
+    uint64_t key;
+    uint64_t pawn_key;
+    uint64_t material_key;
 } fast_undo_t;
 
+// Estructura que representa una entrada en el historial de movimientos
+// Solo guarda la jugada y lo necesario para deshacerla (sin copiar el tablero), así el historial ocupa poco
+// y se recorre rápido al buscar repeticiones
+typedef struct {
+    move_t move;                    // El movimiento que se realizó
+    fast_undo_t undo;               // Estado anterior a la jugada (enroques, en passant, contadores, clave, etc.)
+} history_entry_t;
+
 // Declaración de los vectores externos de movimiento
 // Se definen en chess.c
 extern int knight_moves[8];
@@ -121,16 +133,28 @@ typedef enum {
     GAME_CHECKMATE_BLACK,   // Jaque mate - ganan las negras
     GAME_STALEMATE,         // Tablas por ahogado
     GAME_DRAW_50_MOVES,     // Tablas por regla de 50 movimientos
-    GAME_DRAW_REPETITION,   // Tablas por repetición (implementación futura)
+    GAME_DRAW_REPETITION,   // Tablas por triple repetición (ver is_threefold_repetition)
     GAME_DRAW_MATERIAL      // Tablas por material insuficiente
 } game_result_t;
 
+// Conteos de perft_detailed para las jugadas del último nivel
+typedef struct {
+    uint64_t nodes;
+    uint64_t captures;              // Incluye las capturas en passant
+    uint64_t en_passant;
+    uint64_t castles;
+    uint64_t promotions;
+    uint64_t checks;
+    uint64_t checkmates;
+} perft_stats_t;
+
 // Inicialización
 void init_board(gamestate_t *game);
 int init_board_fen(gamestate_t *game, const char *fen);
 // Funciones auxiliares para FEN
 char piece_to_fen_char(int piece);
 void square_to_algebraic(int square, char *notation);
+void move_to_string(const move_t *move, char *str);
 void gamestate_to_fen(gamestate_t *gs, char *fen_string);
 // Lógica del juego (legalidad, generación de movimientos, etc.)
 bool is_slide_valid(move_t *move, gamestate_t *game, int dir);
@@ -148,12 +172,17 @@ void generate_knight_moves(gamestate_t *game, move_list_t *list, int from);
 void generate_sliding_moves(gamestate_t *game, move_list_t *list, int from, int *directions, int num_dirs);
 void generate_king_moves(gamestate_t *game, move_list_t *list, int from);
 void generate_moves(gamestate_t *game, move_list_t *list);
+void generate_legal_moves(gamestate_t *game, move_list_t *list);
+void remove_illegal_moves(gamestate_t *game, move_list_t *list);
 // Condiciones de fin de partida
 const char* get_game_result_name(game_result_t result);
 bool has_legal_moves(gamestate_t *game);
 void count_material(gamestate_t *game, int white_material[5], int black_material[5]);
+uint64_t compute_material_key(const gamestate_t *game);
 bool is_insufficient_material(gamestate_t *game);
+bool is_threefold_repetition(gamestate_t *game);
 game_result_t evaluate_game_state(gamestate_t *game);
 // Benchmarking y testing
 uint64_t perft(gamestate_t *game, int depth);
+void perft_detailed(gamestate_t *game, int depth, perft_stats_t *stats);
 void perft_benchmark(gamestate_t *game, int max_depth); // output detallado (sólo para debuggear)
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "eval.h"
+#include "pawns.h"
+#include "material.h"
+#include "stats.h"
+
+// Parámetros por defecto (ajustados a mano)
+const eval_params_t eval_default_params = {
+    // Material: vacío, peón, caballo, alfil, torre, dama, rey
+    .piece_values = {0, 100, 320, 330, 500, 900, 20000},
+    // Movilidad: una casilla de caballo o alfil vale el peso completo, una de dama solo un cuarto
+    .mobility = {0, 0, 4, 4, 2, 1, 0},
+    // Seguridad del rey: https://www.chessprogramming.org/King_Safety#Attacking_King_Zone
+    .king_attack = {0, 0, 2, 2, 3, 5, 0},
+    .pawn_threat = 40,
+    .hanging = 30,
+    .doubled_mg = 10,
+    .doubled_eg = 20,
+    .isolated_mg = 10,
+    .isolated_eg = 15,
+    .backward_mg = 8,
+    .backward_eg = 10,
+    .passed_mg = {0, 5, 10, 15, 25, 40, 60, 0},
+    .passed_eg = {0, 10, 15, 25, 45, 70, 110, 0},
+};
+
+// Parámetros en uso (los por defecto, o los de un archivo cargado con eval_params_load)
+eval_params_t eval_params = eval_default_params;
+
+#define PARAM_INFO(field, first, count, taper) {#field, offsetof(eval_params_t, field), first, count, taper}
+
+// Parámetros que se guardan en el archivo y que ajusta el tuner (el valor del rey y los extremos de los
+// arreglos que no se usan quedan fijos)
+const eval_param_info_t eval_param_info[] = {
+    PARAM_INFO(piece_values, PAWN, 5, EVAL_TAPER_NONE),
+    PARAM_INFO(mobility, KNIGHT, 4, EVAL_TAPER_NONE),
+    PARAM_INFO(king_attack, KNIGHT, 4, EVAL_TAPER_KING),
+    PARAM_INFO(pawn_threat, 0, 1, EVAL_TAPER_NONE),
+    PARAM_INFO(hanging, 0, 1, EVAL_TAPER_NONE),
+    PARAM_INFO(doubled_mg, 0, 1, EVAL_TAPER_MG),
+    PARAM_INFO(doubled_eg, 0, 1, EVAL_TAPER_EG),
+    PARAM_INFO(isolated_mg, 0, 1, EVAL_TAPER_MG),
+    PARAM_INFO(isolated_eg, 0, 1, EVAL_TAPER_EG),
+    PARAM_INFO(backward_mg, 0, 1, EVAL_TAPER_MG),
+    PARAM_INFO(backward_eg, 0, 1, EVAL_TAPER_EG),
+    PARAM_INFO(passed_mg, 1, 6, EVAL_TAPER_MG),
+    PARAM_INFO(passed_eg, 1, 6, EVAL_TAPER_EG),
+};
+const int eval_param_info_count = (int)(sizeof(eval_param_info) / sizeof(eval_param_info[0]));
+
+// Fase de la partida según el material sin peones (ver EVAL_PHASE_MAX)
+static const int phase_weights[7] = {0, 0, 1, 1, 2, 4, 0};
+
+// Casillas ocupadas de la posición (se recorre el tablero una sola vez por evaluación)
+typedef struct {
+    int square[32];
+    int count;
+} piece_list_t;
+
+// Mapa de ataques de una posición (bitboards con el formato de pawns.h)
+typedef struct {
+    uint64_t attacks[2];            // Casillas atacadas o defendidas por las piezas de cada color (sin contar peones)
+    int mobility[2];                // En unidades de eval_params.mobility
+    int king_attackers[2];          // Piezas de cada color que atacan la zona del rey rival
+    int king_units[2];
+} attack_map_t;
+
+// Casilla 0x88 -> bit de los bitboards de pawns.h (fila * 8 + columna = (casilla + columna) / 2)
+static inline uint64_t square_bit(int square) {
+    return 1ULL << ((square + (square & 7)) >> 1);
+}
+
+// Cantidad de bits en 1 (versión portable, sin instrucciones especiales)
+static inline int popcount64(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+// Zona del rey: su casilla y las casillas vecinas
+static uint64_t king_zone(int king_square) {
+    uint64_t zone = square_bit(king_square);
+    for (int i = 0; i < 8; i++) {
+        int square = king_square + king_moves[i];
+        if (IS_VALID_SQUARE(square)) zone |= square_bit(square);
+    }
+    return zone;
+}
+
+// Casillas atacadas por la pieza en 'from' (las piezas deslizantes se detienen en la primera pieza que encuentran)
+static uint64_t piece_attacks(const gamestate_t *game, int from, int type) {
+    uint64_t attacks = 0;
+    switch (type) {
+        case KNIGHT:
+        case KING: {
+            const int *offsets = type == KNIGHT ? knight_moves : king_moves;
+            for (int i = 0; i < 8; i++) {
+                int to = from + offsets[i];
+                if (IS_VALID_SQUARE(to)) attacks |= square_bit(to);
+            }
+            break;
+        }
+        default:
+            for (int i = 0; i < 8; i++) {
+                // La reina usa las 8 direcciones; el alfil solo las diagonales y la torre solo las ortogonales
+                if ((type == BISHOP && i >= 4) || (type == ROOK && i < 4)) continue;
+                int dir = i < 4 ? bishop_dirs[i] : rook_dirs[i - 4];
+                for (int to = from + dir; IS_VALID_SQUARE(to); to += dir) {
+                    attacks |= square_bit(to);
+                    if (game->board[to] != EMPTY) break;
+                }
+            }
+            break;
+    }
+    return attacks;
+}
+
+/**
+ * Recorre las piezas (sin peones, cuyos ataques ya están en la tabla de peones) y arma el mapa de ataques.
+ * La movilidad cuenta las casillas atacadas sin piezas propias y no controladas por peones rivales.
+ * @param occupied: casillas ocupadas por cada color.
+ * @param trace: recibe los coeficientes de movilidad y los atacantes del rey (NULL si no se necesitan).
+ */
+static void build_attack_map(const gamestate_t *game, const piece_list_t *pieces, const pawn_entry_t *pawns,
+                             const uint64_t occupied[2], attack_map_t *map, eval_trace_t *trace) {
+    memset(map, 0, sizeof(attack_map_t));
+    uint64_t zone[2] = {king_zone(game->king_square[WHITE]), king_zone(game->king_square[BLACK])};
+    uint64_t mobility_area[2] = {~(occupied[WHITE] | pawns->attacks[BLACK]), ~(occupied[BLACK] | pawns->attacks[WHITE])};
+
+    for (int p = 0; p < pieces->count; p++) {
+        int from = pieces->square[p];
+        int piece = game->board[from];
+        int type = PIECE_TYPE(piece);
+        int color = COLOR(piece);
+        if (type == PAWN) continue;
+
+        uint64_t attacks = piece_attacks(game, from, type);
+        map->attacks[color] |= attacks;
+        if (type == KING) continue;
+
+        int mobility = popcount64(attacks & mobility_area[color]);
+        map->mobility[color] += mobility * eval_params.mobility[type];
+        int zone_hits = popcount64(attacks & zone[1 - color]);
+        if (zone_hits > 0) {
+            map->king_attackers[color]++;
+            map->king_units[color] += eval_params.king_attack[type] + zone_hits;
+        }
+        if (trace) {
+            trace->coefs.mobility[type] += color == WHITE ? mobility : -mobility;
+            if (zone_hits > 0) {
+                trace->king_attackers[color]++;
+                trace->king_pieces[color][type]++;
+                trace->king_hits[color] += zone_hits;
+            }
+        }
+    }
+}
+
+// Penalización por ataque al rey de 'color': crece con el cuadrado de las unidades de ataque,
+// y solo se aplica con al menos dos atacantes (un atacante solo rara vez es peligroso)
+static int king_danger(const attack_map_t *map, int color) {
+    int attacker = 1 - color;
+    if (map->king_attackers[attacker] < 2) return 0;
+    int units = map->king_units[attacker];
+    int danger = units * units / 2;
+    return danger < EVAL_KING_DANGER_MAX ? danger : EVAL_KING_DANGER_MAX;
+}
+
+// Penalización por las piezas de 'color' amenazadas por peones o colgadas (atacadas y sin defensa)
+static int threats_against(const gamestate_t *game, const piece_list_t *pieces, const pawn_entry_t *pawns,
+                           const attack_map_t *map, int color, eval_trace_t *trace) {
+    int sign = color == WHITE ? -1 : 1;     // Coeficiente de la penalización desde el punto de vista de las blancas
+    int enemy = 1 - color;
+    uint64_t attacked = map->attacks[enemy] | pawns->attacks[enemy];
+    uint64_t defended = map->attacks[color] | pawns->attacks[color];
+    int penalty = 0;
+    for (int p = 0; p < pieces->count; p++) {
+        int square = pieces->square[p];
+        int piece = game->board[square];
+        if (COLOR(piece) != color || PIECE_TYPE(piece) == KING) continue;
+
+        uint64_t bit = square_bit(square);
+        if (!(attacked & bit)) continue;
+        if ((pawns->attacks[enemy] & bit) && PIECE_TYPE(piece) != PAWN) {
+            penalty += eval_params.pawn_threat;
+            if (trace) trace->coefs.pawn_threat += sign;
+        } else if (!(defended & bit)) {
+            penalty += eval_params.hanging;
+            if (trace) trace->coefs.hanging += sign;
+        }
+    }
+    return penalty;
+}
+
+/**
+ * Evalúa la posición desde la perspectiva de las blancas.
+ * @param trace: si no es NULL, recibe el aporte de cada parámetro (la posición se evalúa sin la tabla de peones).
+ */
+static int evaluate(gamestate_t *game, int mobility_weight, eval_trace_t *trace) {
+    STATS_INC(eval_calls);
+    // Finales conocidos según el material (el tuner usa siempre la evaluación general, sin escalar)
+    const material_entry_t *endgame = NULL;
+    if (!trace) {
+        int score;
+        endgame = material_probe(game);
+        if (material_evaluate(endgame, game, &score)) return score;
+    }
+    int material = 0;
+    int phase = 0;
+    piece_list_t pieces;
+    pieces.count = 0;
+    uint64_t occupied[2] = {0, 0};
+
+    // Evaluación material
+    // Solo las 64 casillas válidas: al pasar la columna h se salta a la columna a de la fila siguiente
+    for (int sq = 0; sq < BOARD_SIZE; sq = (sq + 9) & ~8) {
+        int piece = game->board[sq];
+        if (piece == EMPTY) continue;
+        if (pieces.count < 32) pieces.square[pieces.count++] = sq;
+        occupied[COLOR(piece)] |= square_bit(sq);
+        int piece_type = PIECE_TYPE(piece);
+        phase += phase_weights[piece_type];
+        material += COLOR(piece) == WHITE ? eval_params.piece_values[piece_type] : -eval_params.piece_values[piece_type];
+        if (trace) trace->coefs.piece_values[piece_type] += COLOR(piece) == WHITE ? 1 : -1;
+    }
+    if (phase > EVAL_PHASE_MAX) phase = EVAL_PHASE_MAX;
+
+    // Estructura de peones (desde la tabla de peones), interpolada entre medio juego y final según la fase
+    pawn_entry_t traced_pawns;
+    const pawn_entry_t *pawns;
+    if (trace) {
+        trace->phase = phase;
+        pawn_evaluate_traced(game, &traced_pawns, &trace->coefs);
+        pawns = &traced_pawns;
+    } else {
+        pawns = pawn_probe(game);
+    }
+    int pawn_score = (pawns->mg * phase + pawns->eg * (EVAL_PHASE_MAX - phase)) / EVAL_PHASE_MAX;
+
+    attack_map_t map;
+    build_attack_map(game, &pieces, pawns, occupied, &map, trace);
+    int mobility = (map.mobility[WHITE] - map.mobility[BLACK]) * mobility_weight / 4;
+    // El ataque al rey importa sobre todo con piezas en el tablero
+    int king_safety = (king_danger(&map, BLACK) - king_danger(&map, WHITE)) * phase / EVAL_PHASE_MAX;
+    int threats = threats_against(game, &pieces, pawns, &map, BLACK, trace) -
+                  threats_against(game, &pieces, pawns, &map, WHITE, trace);
+
+    int score = material + pawn_score + mobility + king_safety + threats;
+    if (endgame && score != 0) score = score * material_scale(endgame, game, score > 0 ? WHITE : BLACK) / MATERIAL_SCALE_NORMAL;
+    return score;
+}
+
+// Función de evaluación con el peso de movilidad por defecto
+int evaluate_position(gamestate_t *game) {
+    return evaluate_position_weighted(game, EVAL_DEFAULT_MOBILITY_WEIGHT);
+}
+
+/**
+ * Evalúa la posición desde la perspectiva del jugador que mueve.
+ * @param game: posición a evaluar (con game->pawn_key actualizado).
+ * @param mobility_weight: centipeones por casilla de movilidad de un caballo o alfil (ver search_params_t).
+ * @return puntaje en centipeones.
+ */
+int evaluate_position_weighted(gamestate_t *game, int mobility_weight) {
+    int score = evaluate(game, mobility_weight, NULL);
+    // Devolver desde perspectiva del jugador actual
+    return (game->to_move == WHITE) ? score : -score;
+}
+
+/**
+ * Evaluación con el peso de movilidad por defecto que además anota el aporte de cada parámetro (para el tuner).
+ * @param trace: recibe los coeficientes (se inicializa acá).
+ * @return puntaje en centipeones desde la perspectiva de las blancas.
+ */
+int evaluate_position_traced(gamestate_t *game, eval_trace_t *trace) {
+    memset(trace, 0, sizeof(eval_trace_t));
+    return evaluate(game, EVAL_DEFAULT_MOBILITY_WEIGHT, trace);
+}
+
+// Evaluación con la red neuronal cargada (ver nnue.h), desde la perspectiva del jugador que mueve
+int evaluate_position_nnue(gamestate_t *game) {
+    STATS_INC(eval_calls);
+    const material_entry_t *endgame = material_probe(game);
+    int score;
+    if (material_evaluate(endgame, game, &score)) return game->to_move == WHITE ? score : -score;
+    score = nnue_evaluate(&game->nnue, game->board, game->to_move);
+    if (score != 0) {
+        int winner = score > 0 ? game->to_move : 1 - game->to_move;
+        score = score * material_scale(endgame, game, winner) / MATERIAL_SCALE_NORMAL;
+    }
+    return score;
+}
+
+/**
+ * Carga los parámetros de la evaluación desde un archivo de texto con una línea por parámetro:
+ * nombre y sus valores separados por espacios (ver eval_param_info). Las líneas que empiezan con '#' se ignoran
+ * y los parámetros que no aparecen conservan su valor por defecto.
+ * No se debe llamar mientras hay búsquedas en curso.
+ * @return false si el archivo no existe o tiene un parámetro desconocido o incompleto (no se cambia nada).
+ */
+bool eval_params_load(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    eval_params_t loaded = eval_default_params;
+    char line[512];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        char name[64];
+        int consumed;
+        if (line[0] == '#' || sscanf(line, "%63s%n", name, &consumed) != 1) continue;
+        const eval_param_info_t *info = NULL;
+        for (int i = 0; i < eval_param_info_count; i++) {
+            if (strcmp(eval_param_info[i].name, name) == 0) info = &eval_param_info[i];
+        }
+        if (!info) {
+            ok = false;
+            break;
+        }
+        int *values = eval_param_values(&loaded, info);
+        const char *p = line + consumed;
+        for (int k = 0; k < info->count && ok; k++) {
+            ok = sscanf(p, "%d%n", &values[k], &consumed) == 1;
+            p += consumed;
+        }
+    }
+    fclose(file);
+    if (!ok) return false;
+
+    eval_params = loaded;
+    // Las entradas de las tablas de peones se calcularon con los parámetros anteriores
+    pawn_hash_clear();
+    return true;
+}
+
+/**
+ * Escribe parámetros en el formato que lee eval_params_load.
+ * @return false si no se pudo escribir el archivo.
+ */
+bool eval_params_save(const eval_params_t *params, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "# Parámetros de la evaluación de Fortuna Chess (nombre y valores)\n");
+    for (int i = 0; i < eval_param_info_count; i++) {
+        const int *values = eval_param_values((eval_params_t *)params, &eval_param_info[i]);
+        fprintf(file, "%s", eval_param_info[i].name);
+        for (int k = 0; k < eval_param_info[i].count; k++) fprintf(file, " %d", values[k]);
+        fprintf(file, "\n");
+    }
+    bool ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <stddef.h>
+#include "chess.h"
+
+// Evaluación estática de una posición: material, estructura de peones (ver pawns.h), movilidad,
+// seguridad del rey y amenazas. Todos los términos salen de un solo recorrido del tablero que arma un mapa
+// de ataques (casillas atacadas por cada color), sin generar jugadas ni verificar legalidad.
+// Los finales conocidos se evalúan aparte o se escalan según el material (ver material.h).
+// https://www.chessprogramming.org/Evaluation
+
+#define EVAL_DEFAULT_MOBILITY_WEIGHT 2
+#define EVAL_PHASE_MAX 24           // Fase con todas las piezas (medio juego); 0 = solo reyes y peones (final)
+#define EVAL_KING_DANGER_MAX 500    // Penalización máxima por ataque al rey (en medio juego)
+#define EVAL_KPK_RANK_STEP 50       // Final KPK ganado: lo que se descuenta del valor de la dama por cada fila que le falta al peón
+#define EVAL_KNOWN_WIN 10000        // Base de los finales ganados conocidos (ver material.h), lejos de los puntajes de mate
+#define EVAL_MOPUP_EDGE 20          // Rey solo: por cada paso (columna o fila) que lo separa del centro
+#define EVAL_MOPUP_CORNER 40        // Alfil y caballo: por cada paso hacia la esquina del color del alfil
+#define EVAL_MOPUP_CLOSE 10         // Por cada casilla que se acerca el rey fuerte al rey débil
+#define EVAL_DEFAULT_PARAMS_FILE "fortuna.params"
+
+// Parámetros de la evaluación, en centipeones. Los valores por defecto están en eval.c y se pueden reemplazar
+// con un archivo generado por el tuner (ver tuner.h)
+typedef struct {
+    int piece_values[7];            // Por tipo de pieza (también se usan para ordenar jugadas)
+    int mobility[7];                // Por casilla alcanzable, en cuartos del peso de movilidad de la búsqueda
+    int king_attack[7];             // Unidades de ataque de cada pieza que ataca la zona del rey rival
+    int pawn_threat;                // Pieza (no peón) atacada por un peón rival
+    int hanging;                    // Pieza atacada y sin defensa
+    int doubled_mg;                 // Estructura de peones, en medio juego y en el final (ver pawns.c)
+    int doubled_eg;
+    int isolated_mg;
+    int isolated_eg;
+    int backward_mg;
+    int backward_eg;
+    int passed_mg[8];               // Peón pasado según su fila, contada desde su propio lado
+    int passed_eg[8];
+} eval_params_t;
+
+// Cómo influye la fase de la partida en cada parámetro
+typedef enum {
+    EVAL_TAPER_NONE,                // Igual en toda la partida
+    EVAL_TAPER_MG,                  // Proporcional a la fase (medio juego)
+    EVAL_TAPER_EG,                  // Proporcional a EVAL_PHASE_MAX - fase (final)
+    EVAL_TAPER_KING                 // Unidades de ataque al rey (término cuadrático, ver eval_king_danger)
+} eval_taper_t;
+
+// Un parámetro, o un grupo de valores consecutivos de un arreglo, con su nombre en el archivo de parámetros
+typedef struct {
+    const char *name;
+    size_t offset;                  // Posición del campo en eval_params_t
+    int first;                      // Primer índice del arreglo que se guarda y se ajusta (0 en campos simples)
+    int count;
+    eval_taper_t taper;
+} eval_param_info_t;
+
+// Aporte de cada parámetro a una evaluación (blancas - negras), para el tuner
+typedef struct {
+    eval_params_t coefs;            // Cantidad de veces que se suma cada parámetro
+    int phase;
+    int king_attackers[2];          // Piezas de cada color que atacan la zona del rey rival
+    int king_pieces[2][7];          // Las mismas, por tipo
+    int king_hits[2];               // Casillas de la zona del rey rival atacadas (sumadas por pieza)
+} eval_trace_t;
+
+extern eval_params_t eval_params;
+extern const eval_params_t eval_default_params;
+extern const eval_param_info_t eval_param_info[];
+extern const int eval_param_info_count;
+
+// Valores de un parámetro dentro de un eval_params_t (o de sus coeficientes en eval_trace_t)
+static inline int* eval_param_values(eval_params_t *params, const eval_param_info_t *info) {
+    return (int *)((char *)params + info->offset) + info->first;
+}
+
+bool eval_params_load(const char *path);
+bool eval_params_save(const eval_params_t *params, const char *path);
+int evaluate_position(gamestate_t *game);
+int evaluate_position_weighted(gamestate_t *game, int mobility_weight);
+int evaluate_position_nnue(gamestate_t *game);
+int evaluate_position_traced(gamestate_t *game, eval_trace_t *trace);
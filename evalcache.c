@@ -0,0 +1,47 @@
+#include <stdlib.h>
+#include "evalcache.h"
+
+#define KEY_MASK 0xFFFFFFFFFFFF0000ULL
+
+/**
+ * Reserva la caché con el tamaño indicado (se redondea hacia abajo a una potencia de 2 de entradas).
+ * @param cache: caché a inicializar (si ya tenía memoria, se debe liberar antes con evalcache_free).
+ * @param mb: tamaño en megabytes.
+ * @return false si no hay memoria suficiente.
+ */
+bool evalcache_init(evalcache_t *cache, size_t mb) {
+    size_t bytes = (mb > 0 ? mb : 1) * 1024 * 1024;
+    size_t count = 1;
+    while (count * 2 * sizeof(atomic_uint_least64_t) <= bytes) count *= 2;
+
+    cache->entries = calloc(count, sizeof(atomic_uint_least64_t));
+    cache->mask = cache->entries ? count - 1 : 0;
+    return cache->entries != NULL;
+}
+
+void evalcache_free(evalcache_t *cache) {
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->mask = 0;
+}
+
+void evalcache_clear(evalcache_t *cache) {
+    for (size_t i = 0; cache->entries && i <= cache->mask; i++) {
+        atomic_store_explicit(&cache->entries[i], 0, memory_order_relaxed);
+    }
+}
+
+// Una entrada vacía (0) nunca coincide: las claves cuyos 48 bits altos son 0 simplemente no se guardan
+bool evalcache_probe(evalcache_t *cache, uint64_t key, int *score) {
+    if (!cache || !cache->entries || (key & KEY_MASK) == 0) return false;
+    uint64_t entry = atomic_load_explicit(&cache->entries[key & cache->mask], memory_order_relaxed);
+    if ((entry & KEY_MASK) != (key & KEY_MASK)) return false;
+    *score = (int16_t)(entry & 0xFFFF);
+    return true;
+}
+
+void evalcache_store(evalcache_t *cache, uint64_t key, int score) {
+    if (!cache || !cache->entries) return;
+    uint64_t entry = (key & KEY_MASK) | (uint16_t)(int16_t)score;
+    atomic_store_explicit(&cache->entries[key & cache->mask], entry, memory_order_relaxed);
+}
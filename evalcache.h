@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Caché de evaluaciones: guarda la evaluación estática de las posiciones ya evaluadas (indexadas por su clave Zobrist),
+// para no repetirla cuando se llega a la misma posición por otro orden de jugadas o en una re-búsqueda (PVS).
+// https://www.chessprogramming.org/Evaluation_Hash_Table
+// Es de acceso directo (una entrada por índice, siempre se reemplaza) y se comparte entre hilos sin locks:
+// cada entrada es una sola palabra de 64 bits con los 48 bits altos de la clave y el puntaje, que se lee y
+// escribe de forma atómica, así que nunca se ve una entrada a medias.
+// El puntaje depende de los parámetros de evaluación, así que configuraciones distintas no deben compartir caché.
+
+#define EVAL_CACHE_DEFAULT_MB 2
+#define EVAL_CACHE_MAX_MB 1024
+
+typedef struct {
+    atomic_uint_least64_t *entries;
+    size_t mask;                    // Cantidad de entradas - 1 (potencia de 2)
+} evalcache_t;
+
+bool evalcache_init(evalcache_t *cache, size_t mb);
+void evalcache_free(evalcache_t *cache);
+void evalcache_clear(evalcache_t *cache);
+bool evalcache_probe(evalcache_t *cache, uint64_t key, int *score);
+void evalcache_store(evalcache_t *cache, uint64_t key, int score);
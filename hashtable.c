@@ -111,6 +111,11 @@ int hashtable_get_size(hashtable_t *ht) {
     return ht->size;
 }
 
+// La tabla reserva todas sus entradas de antemano, así que su tamaño no depende de cuántas estén ocupadas
+size_t hashtable_memory_usage(hashtable_t *ht) {
+    return ht ? sizeof(hashtable_t) : 0;
+}
+
 bool hashtable_resize(hashtable_t *ht, int new_capacity) {
     return false;
 }
@@ -38,6 +38,7 @@ bool hashtable_lookup_best_move(hashtable_t *ht, uint64_t key, char *move_out);
 void hashtable_remove(hashtable_t *ht, uint64_t key);
 void hashtable_clear(hashtable_t *ht);
 int hashtable_get_size(hashtable_t *ht);
+size_t hashtable_memory_usage(hashtable_t *ht);
 
 // Las siguientes funciones se obtuvieron del código que se provee en
 // http://hgm.nubati.net/book_format.html
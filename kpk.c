@@ -0,0 +1,179 @@
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "kpk.h"
+#include "platform.h"
+
+// Resultados durante la generación (combinables con OR para resumir las sucesoras de una posición)
+#define KPK_INVALID 0
+#define KPK_UNKNOWN 1
+#define KPK_DRAW 2
+#define KPK_WIN 4
+
+// En este archivo las casillas van de 0 a 63 (fila * 8 + columna)
+#define SQ64(square) (((square) + ((square) & 7)) >> 1)
+
+static uint8_t kpk_bits[KPK_BYTES];
+static pthread_once_t kpk_once = PTHREAD_ONCE_INIT;
+static double kpk_time_ms;
+
+// Casillas vecinas de cada casilla (movimientos del rey)
+static uint64_t king_attacks[64];
+static uint8_t king_targets[64][8];
+static int king_target_count[64];
+
+// Índice de una posición con el bando fuerte como blancas y el peón en las columnas a-d, filas 2 a 7
+static inline int kpk_index(int white_to_move, int strong_king, int weak_king, int pawn) {
+    return strong_king | (weak_king << 6) | (white_to_move << 12) | ((pawn & 7) << 13) | (((pawn >> 3) - 1) << 15);
+}
+
+static inline int distance(int a, int b) {
+    int files = (a & 7) - (b & 7), ranks = (a >> 3) - (b >> 3);
+    if (files < 0) files = -files;
+    if (ranks < 0) ranks = -ranks;
+    return files > ranks ? files : ranks;
+}
+
+// Casillas atacadas por un peón blanco
+static inline uint64_t pawn_attacks(int pawn) {
+    uint64_t attacks = 0;
+    if ((pawn & 7) > 0) attacks |= 1ULL << (pawn + 7);
+    if ((pawn & 7) < 7) attacks |= 1ULL << (pawn + 9);
+    return attacks;
+}
+
+// Resultado que no depende de las sucesoras (posición ilegal, coronación segura, ahogado o captura del peón)
+static uint8_t initial_result(int white_to_move, int strong_king, int weak_king, int pawn) {
+    if (distance(strong_king, weak_king) <= 1 || strong_king == pawn || weak_king == pawn) return KPK_INVALID;
+    if (white_to_move && (pawn_attacks(pawn) & (1ULL << weak_king))) return KPK_INVALID;
+
+    int queen = pawn + 8;
+    if (white_to_move && (pawn >> 3) == 6 && strong_king != queen && weak_king != queen &&
+        (distance(weak_king, queen) > 1 || distance(strong_king, queen) <= 1)) {
+        return KPK_WIN;
+    }
+    if (!white_to_move) {
+        uint64_t moves = king_attacks[weak_king];
+        if (!(moves & ~(king_attacks[strong_king] | pawn_attacks(pawn)))) return KPK_DRAW;
+        if (moves & (1ULL << pawn) & ~king_attacks[strong_king]) return KPK_DRAW;
+    }
+    return KPK_UNKNOWN;
+}
+
+/**
+ * Clasifica una posición según sus sucesoras: el bando que mueve elige la mejor y, si alguna todavía no se
+ * conoce, el resultado queda pendiente. Las jugadas ilegales llevan a posiciones KPK_INVALID y no cuentan.
+ */
+static uint8_t classify(const uint8_t *db, int white_to_move, int strong_king, int weak_king, int pawn) {
+    uint8_t results = KPK_INVALID;
+    if (white_to_move) {
+        for (int i = 0; i < king_target_count[strong_king]; i++) {
+            results |= db[kpk_index(0, king_targets[strong_king][i], weak_king, pawn)];
+        }
+        // El avance a la octava fila lo resuelve initial_result (solo se considera la coronación a dama)
+        if ((pawn >> 3) < 6) results |= db[kpk_index(0, strong_king, weak_king, pawn + 8)];
+        if ((pawn >> 3) == 1 && pawn + 8 != strong_king && pawn + 8 != weak_king) {
+            results |= db[kpk_index(0, strong_king, weak_king, pawn + 16)];
+        }
+        return results & KPK_WIN ? KPK_WIN : results & KPK_UNKNOWN ? KPK_UNKNOWN : KPK_DRAW;
+    }
+    for (int i = 0; i < king_target_count[weak_king]; i++) {
+        results |= db[kpk_index(1, strong_king, king_targets[weak_king][i], pawn)];
+    }
+    return results & KPK_DRAW ? KPK_DRAW : results & KPK_UNKNOWN ? KPK_UNKNOWN : KPK_WIN;
+}
+
+static void kpk_generate(void) {
+    int64_t start = platform_time_ns();
+    for (int square = 0; square < 64; square++) {
+        king_attacks[square] = 0;
+        king_target_count[square] = 0;
+        for (int target = 0; target < 64; target++) {
+            if (target != square && distance(square, target) == 1) {
+                king_attacks[square] |= 1ULL << target;
+                king_targets[square][king_target_count[square]++] = (uint8_t)target;
+            }
+        }
+    }
+
+    static uint8_t db[KPK_POSITIONS];
+    for (int index = 0; index < KPK_POSITIONS; index++) {
+        int pawn = ((index >> 13) & 3) + ((((index >> 15) & 7) + 1) << 3);
+        db[index] = initial_result((index >> 12) & 1, index & 63, (index >> 6) & 63, pawn);
+    }
+
+    // Se repiten pasadas hasta que ninguna posición pendiente cambia
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int index = 0; index < KPK_POSITIONS; index++) {
+            if (db[index] != KPK_UNKNOWN) continue;
+            int pawn = ((index >> 13) & 3) + ((((index >> 15) & 7) + 1) << 3);
+            uint8_t result = classify(db, (index >> 12) & 1, index & 63, (index >> 6) & 63, pawn);
+            if (result != KPK_UNKNOWN) {
+                db[index] = result;
+                changed = true;
+            }
+        }
+    }
+
+    // Las que siguen pendientes no pueden forzar la coronación: son tablas
+    memset(kpk_bits, 0, sizeof(kpk_bits));
+    for (int index = 0; index < KPK_POSITIONS; index++) {
+        if (db[index] == KPK_WIN) kpk_bits[index >> 3] |= (uint8_t)(1 << (index & 7));
+    }
+    kpk_time_ms = (platform_time_ns() - start) / 1e6;
+}
+
+// Genera el bitbase si todavía no existe (se puede llamar desde varios hilos)
+void kpk_init(void) {
+    pthread_once(&kpk_once, kpk_generate);
+}
+
+// Tiempo que tomó generar el bitbase (0 si todavía no se generó)
+double kpk_generation_ms(void) {
+    return kpk_time_ms;
+}
+
+/**
+ * Busca el peón de una posición de rey y peón contra rey.
+ * Deja de recorrer el tablero al encontrar una segunda pieza, así es barato en las demás posiciones.
+ * @return casilla del peón (formato 0x88), o -1 si la posición no es KPK.
+ */
+int kpk_find_pawn(const gamestate_t *game) {
+    int pawn = -1;
+    for (int sq = 0; sq < BOARD_SIZE; sq = (sq + 9) & ~8) {
+        int piece = game->board[sq];
+        if (piece == EMPTY || PIECE_TYPE(piece) == KING) continue;
+        if (pawn >= 0 || PIECE_TYPE(piece) != PAWN) return -1;
+        pawn = sq;
+    }
+    return pawn;
+}
+
+/**
+ * Consulta el bitbase.
+ * @param game: posición con solo los dos reyes y un peón.
+ * @param pawn_square: casilla del peón (ver kpk_find_pawn).
+ * @return true si gana el bando del peón, false si son tablas.
+ */
+bool kpk_probe(const gamestate_t *game, int pawn_square) {
+    kpk_init();
+    int strong = COLOR(game->board[pawn_square]);
+    int strong_king = SQ64(game->king_square[strong]);
+    int weak_king = SQ64(game->king_square[1 - strong]);
+    int pawn = SQ64(pawn_square);
+    // El bando fuerte juega con blancas (se voltean las filas) y el peón queda en las columnas a-d
+    if (strong == BLACK) {
+        strong_king ^= 56;
+        weak_king ^= 56;
+        pawn ^= 56;
+    }
+    if ((pawn & 7) > 3) {
+        strong_king ^= 7;
+        weak_king ^= 7;
+        pawn ^= 7;
+    }
+    int index = kpk_index(game->to_move == strong, strong_king, weak_king, pawn);
+    return (kpk_bits[index >> 3] >> (index & 7)) & 1;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <stdbool.h>
+#include "chess.h"
+
+// Bitbase de rey y peón contra rey (KPK)
+// https://www.chessprogramming.org/KPK
+// Se genera por análisis retrógrado la primera vez que se consulta (o con kpk_init): se parte de las posiciones
+// con resultado inmediato (coronación segura, ahogado o captura del peón) y se reclasifican las demás según sus
+// sucesoras hasta que ninguna cambia. Queda un bit por posición (1 = gana el bando del peón), con el bando
+// fuerte como blancas y el peón en las columnas a-d (las demás posiciones se reflejan).
+
+#define KPK_POSITIONS (2 * 24 * 64 * 64)    // Turno x casilla del peón x rey fuerte x rey débil
+#define KPK_BYTES (KPK_POSITIONS / 8)       // 24 KB
+
+void kpk_init(void);
+double kpk_generation_ms(void);
+int kpk_find_pawn(const gamestate_t *game);
+bool kpk_probe(const gamestate_t *game, int pawn_square);
@@ -3,6 +3,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <inttypes.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -16,6 +17,33 @@
 #include "zobrist.h"
 // Función que contiene las funciones relacionadas al bot (Jugador vs CPU)
 #include "bot.h"
+// Representación compacta del libro de aperturas
+#include "book.h"
+// Generador de libros de apertura a partir de partidas PGN
+#include "book_builder.h"
+// Lectura de partidas PGN
+#include "pgn.h"
+// Análisis por lotes de posiciones EPD/FEN
+#include "analysis.h"
+// Protocolo UCI para interfaces gráficas
+#include "uci.h"
+// Partidas entre dos configuraciones del motor (self-play)
+#include "match.h"
+// Benchmark de la búsqueda (firma de nodos y velocidad)
+#include "bench.h"
+// Suites perft y divide para validar la generación de movimientos
+#include "perft.h"
+// Ajuste de los parámetros de la evaluación con posiciones etiquetadas
+#include "tuner.h"
+// Generación de tablas de finales por análisis retrógrado
+#include "tablebase_builder.h"
+// Búsqueda del mate más corto (df-pn y mate en N)
+#include "mate.h"
+// Búsqueda de árbol Monte Carlo con varios hilos
+#include "mcts.h"
+
+// Tiempo por jugada de la CPU en partidas sin reloj (ms)
+#define BOT_MOVE_TIME_MS 1500
 
 //// Prototipos de funciones
 // Funciones auxiliares
@@ -33,9 +61,19 @@ void game_submenu(int is_bot);
 int time_submenu();
 int piece_submenu();
 void start_game(int player_piece, int time_format, int is_bot);
+int64_t bot_move_time(int format, int time_left);
+// Modos de línea de comandos
+int makebook_command(int argc, char *argv[]);
+int pgn_command(int argc, char *argv[]);
+int analyze_command(int argc, char *argv[]);
+int match_command(int argc, char *argv[]);
+int bench_command(int argc, char *argv[]);
+int perft_command(int argc, char *argv[]);
 
 // Tabla hash que se utilizará como libro de apertura para el modo Jugador vs CPU
 hashtable_t *book = NULL;
+// Versión compacta del libro (arreglos ordenados), que reemplaza a la tabla hash una vez cargado
+compact_book_t *opening_book = NULL;
 
 /**
  * Convierte un tipo de pieza a su carácter representativo.
@@ -120,9 +158,7 @@ void display_board(gamestate_t *game, int p1) {
            (game->castling_rights & CASTLE_BLACK_KING) ? "k" : "",
            (game->castling_rights & CASTLE_BLACK_QUEEN) ? "q" : "");
 
-    char fen[128];
-    gamestate_to_fen(game, fen);
-    printf("[ DEBUG ] Hash de la posición: %016llx\n", polyglot_hash(fen));
+    printf("[ DEBUG ] Hash de la posición: %016llx\n", (unsigned long long)polyglot_hash_position(game));
 
     // [DEBUG] Imprimir la casilla "fantasma" que deja un peón que avanza 2 casillas
     // Útil para poder testear que las reglas de en passant estén funcionando correctamente
@@ -336,6 +372,17 @@ int piece_submenu() {
     return option;
 }
 
+/**
+ * Calcula el tiempo que usará la CPU en su jugada.
+ * @param format: formato de tiempo de la partida (1 = blitz, 2 = rápido, 3 = sin tiempo).
+ * @param time_left: segundos que le quedan a la CPU en el reloj.
+ * @return tiempo de búsqueda en milisegundos.
+ */
+int64_t bot_move_time(int format, int time_left) {
+    if (format != 1 && format != 2) return BOT_MOVE_TIME_MS;
+    return search_time_for_move((int64_t)time_left * 1000, 0, 0);
+}
+
 /**
  * Inicia el juego con los parámetros elegidos.
  * @param player_piece: color elegido por el jugador.
@@ -373,6 +420,13 @@ void start_game(int p1, int format, int is_bot) {
         black_time = 600;
     }
 
+    // Estado de la CPU: tabla de transposición (se conserva durante toda la partida) y pondering
+    // Mientras el jugador piensa, la CPU busca la respuesta a la jugada que espera del jugador
+    tt_t bot_tt = {0};
+    ponder_t ponder = {0};
+    bool ponder_pending = false;   // true después de un ponder hit: la búsqueda sigue y solo falta esperar el resultado
+    if (is_bot) tt_init(&bot_tt, TT_DEFAULT_MB);
+
     // Se muestra el tablero en pantalla
     display_board(&game, p1);
 
@@ -395,9 +449,35 @@ void start_game(int p1, int format, int is_bot) {
         // Si es que juega el bot:
         if (is_bot && ((p1 == 1 && game.to_move == BLACK) || (p1 == 2 && game.to_move == WHITE))) {
             printf("Turno de la CPU...\n");
-            move_t best_move = find_best_move(&game, 4);
-            make_move(&best_move, &game, true);
+            int *bot_time = (game.to_move == WHITE) ? &white_time : &black_time;
+            int64_t bot_start = platform_time_ms();
+            search_result_t search_result;
+            bool found;
+
+            if (ponder_pending) {
+                // Ponder hit: la búsqueda ya lleva todo el tiempo que el jugador usó pensando
+                found = ponder_wait(&ponder, &search_result);
+                ponder_pending = false;
+                if (found) {
+                    printf("(Ponder hit) ");
+                    print_search_info(&game, search_result.depth, search_result.score, &search_result.best_move);
+                }
+            } else {
+                search_limits_t limits = { .movetime_ms = bot_move_time(format, *bot_time) };
+                found = bot_search(&game, &limits, &bot_tt, &search_result);
+            }
+            if (!found) break;
+
+            make_move(&search_result.best_move, &game, true);
+            if (format == 1 || format == 2) {
+                *bot_time -= (int)((platform_time_ms() - bot_start + 500) / 1000);
+            }
             display_board(&game, p1);
+
+            // Pondering: buscar la respuesta a la jugada esperada del jugador (segunda jugada de la variante principal)
+            if (search_result.pv_length >= 2 && evaluate_game_state(&game) == GAME_ONGOING) {
+                ponder_start(&ponder, &game, &search_result.pv[1], &bot_tt);
+            }
             continue; // Salta al siguiente turno después de que la CPU haga su movimiento 
         }
 
@@ -455,12 +535,26 @@ void start_game(int p1, int format, int is_bot) {
         }
 
         if (strcmp(input, "historial") == 0) {
-            printf("El historial de movimientos tiene %d movimientos almacenados.\n", stack_size(game.move_history));
-            // TODO: Imprimir una lista de los movimientos de cada jugador, por turno.
+            int count = stack_size(game.move_history);
+            printf("El historial de movimientos tiene %d movimientos almacenados.\n", count);
+            // Una línea por turno: número de jugada, jugada de las blancas y respuesta de las negras
+            for (int i = 0; i < count; i++) {
+                history_entry_t *entry = stack_get(game.move_history, i);
+                char move_str[6];
+                move_to_string(&entry->move, move_str);
+                if (COLOR(entry->move.piece) == WHITE) {
+                    printf("%3d. %-6s", entry->undo.fullmove_number, move_str);
+                } else {
+                    if (i == 0) printf("%3d. %-6s", entry->undo.fullmove_number, "...");
+                    printf("%s\n", move_str);
+                }
+            }
+            if (count > 0 && COLOR(((history_entry_t *)stack_peek(game.move_history))->move.piece) == WHITE) printf("\n");
             continue;
         }
 
         if (strcmp(input, "deshacer") == 0) {
+            ponder_stop(&ponder);
             if (stack_is_empty(game.move_history)) {
                 printf("No hay movimiento que deshacer. (Posición inicial)\n");
             } else {
@@ -473,6 +567,11 @@ void start_game(int p1, int format, int is_bot) {
         
         if (parse_move(input, &move, &game)) {
             if (is_legal_move(&move, &game)) {
+                // Si la CPU estaba pensando en esta jugada, su búsqueda continúa; si no, se cancela
+                if (is_bot && ponder.running) {
+                    int bot_time = (game.to_move == WHITE) ? black_time : white_time;
+                    ponder_pending = ponder_hit(&ponder, &move, bot_move_time(format, bot_time));
+                }
                 make_move(&move, &game, true);
                 display_board(&game, p1);
                 // TODO: Agregar checks para jaque mate, aguas, etc. y terminar la partida con su correspondiente mensaje
@@ -488,56 +587,614 @@ void start_game(int p1, int format, int is_bot) {
         }
     }
     
+    ponder_stop(&ponder);
+    tt_free(&bot_tt);
     printf("¡Gracias por jugar!\n");
 }
 
-// Función auxiliar para poder testear funcionamiento de la función Zobrist Hashing + TDA hashtable
-// Simula el movimiento e2e4 en el tablero
-// Asume que gamestate_t *game es un puntero al estado del juego en posición inicial
-void make_dummy_e2e4(gamestate_t *game) {
-    int from = SQUARE(1, 4);  // e2 (0x14)
-    int to = SQUARE(3, 4);    // e4 (0x34)
-    game->board[to] = game->board[from];
-    game->board[from] = EMPTY;
-    game->en_passant_square = SQUARE(2, 4);  // e3 (0x24)
-    game->to_move = BLACK;
-    game->move_count++;
+/**
+ * Modo "makebook": genera un libro PolyGlot a partir de un archivo PGN.
+ * Uso: fortunachess makebook <partidas.pgn> [libro.bin] [-ply N] [-min-games N] [-threads N] [-memory MB]
+ */
+int makebook_command(int argc, char *argv[]) {
+    book_builder_options_t options;
+    book_builder_default_options(&options);
+
+    int positional = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-ply") == 0 && i + 1 < argc) {
+            options.max_ply = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-min-games") == 0 && i + 1 < argc) {
+            options.min_games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-memory") == 0 && i + 1 < argc) {
+            options.memory_mb = (size_t)atoi(argv[++i]);
+        } else if (positional == 0) {
+            options.pgn_path = argv[i];
+            positional++;
+        } else if (positional == 1) {
+            options.book_path = argv[i];
+            positional++;
+        } else {
+            fprintf(stderr, "Argumento desconocido: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (options.pgn_path == NULL) {
+        fprintf(stderr, "Uso: %s makebook <partidas.pgn> [libro.bin] [-ply N] [-min-games N] [-threads N] [-memory MB]\n", argv[0]);
+        return 1;
+    }
+    return book_builder_run(&options) ? 0 : 1;
+}
+
+/**
+ * Modo "pgn": lee y reproduce todas las partidas de uno o más archivos PGN (un hilo por archivo)
+ * y muestra la velocidad de procesamiento. Sirve para validar colecciones de partidas.
+ * Uso: fortunachess pgn <archivo.pgn> [archivo2.pgn ...] [-threads N]
+ */
+int pgn_command(int argc, char *argv[]) {
+    const char **files = malloc(argc * sizeof(char *));
+    int file_count = 0;
+    int threads = 0;
+    if (!files) return 1;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else {
+            files[file_count++] = argv[i];
+        }
+    }
+    if (file_count == 0) {
+        fprintf(stderr, "Uso: %s pgn <archivo.pgn> [archivo2.pgn ...] [-threads N]\n", argv[0]);
+        free(files);
+        return 1;
+    }
+
+    pgn_stats_t stats;
+    bool ok = pgn_parse_files_parallel(files, file_count, threads, NULL, NULL, &stats);
+    double seconds = stats.seconds > 0 ? stats.seconds : 0.001;
+    printf("[ PGN ] Partidas: %ld (inválidas: %ld), jugadas: %ld\n", stats.games, stats.invalid_games, stats.moves);
+    printf("[ PGN ] Tiempo: %.2f s | %.0f partidas/s | %.0f jugadas/s | %.1f MB/s\n",
+           stats.seconds, stats.games / seconds, stats.moves / seconds, stats.bytes / seconds / (1024.0 * 1024.0));
+
+    free(files);
+    return ok ? 0 : 1;
+}
+
+// Opción "-nnue <archivo>" de los modos de línea de comandos: carga la red para todas las búsquedas del modo
+static bool load_network_option(const char *path) {
+    if (nnue_load(path)) return true;
+    fprintf(stderr, "No se pudo cargar la red neuronal: %s\n", path);
+    return false;
+}
+
+// Opción "-params <archivo>": reemplaza los parámetros de la evaluación clásica (ver tuner_command)
+static bool load_params_option(const char *path) {
+    if (eval_params_load(path)) return true;
+    fprintf(stderr, "No se pudieron cargar los parámetros de la evaluación: %s\n", path);
+    return false;
+}
+
+// Opción "-tb <carpeta>": carga las tablas de finales de la carpeta (ver tbgen_command)
+static bool load_tablebase_option(const char *dir) {
+    int count = tb_init(dir);
+    if (count > 0) {
+        printf("[ TB ] Se cargaron %d tablas de finales de %s (hasta %d piezas)\n", count, dir, tb_max_pieces());
+        return true;
+    }
+    fprintf(stderr, "No hay tablas de finales en %s\n", dir);
+    return false;
+}
+
+/**
+ * Modo "analyze": analiza todas las posiciones de un archivo EPD/FEN en paralelo.
+ * Escribe una línea por posición (mejor jugada, evaluación y variante principal), en el orden del archivo.
+ * Uso: fortunachess analyze <posiciones.epd> [-depth N] [-movetime ms] [-nodes N] [-threads N] [-hash MB] [-nnue red.nnue]
+ *                           [-params archivo] [-tb carpeta] [-o salida.txt]
+ */
+int analyze_command(int argc, char *argv[]) {
+    analysis_options_t options;
+    analysis_default_options(&options);
+    bool depth_set = false;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-depth") == 0 && i + 1 < argc) {
+            options.limits.depth = atoi(argv[++i]);
+            depth_set = true;
+        } else if (strcmp(argv[i], "-movetime") == 0 && i + 1 < argc) {
+            options.limits.movetime_ms = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-nodes") == 0 && i + 1 < argc) {
+            options.limits.nodes = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-hash") == 0 && i + 1 < argc) {
+            options.hash_mb = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-nnue") == 0 && i + 1 < argc) {
+            if (!load_network_option(argv[++i])) return 1;
+        } else if (strcmp(argv[i], "-params") == 0 && i + 1 < argc) {
+            if (!load_params_option(argv[++i])) return 1;
+        } else if (strcmp(argv[i], "-tb") == 0 && i + 1 < argc) {
+            if (!load_tablebase_option(argv[++i])) return 1;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            options.output_path = argv[++i];
+        } else if (options.input_path == NULL) {
+            options.input_path = argv[i];
+        } else {
+            fprintf(stderr, "Argumento desconocido: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (options.input_path == NULL) {
+        fprintf(stderr, "Uso: %s analyze <posiciones.epd> [-depth N] [-movetime ms] [-nodes N] [-threads N] [-hash MB] "
+                        "[-nnue red.nnue] [-params archivo] [-tb carpeta] [-o salida.txt]\n", argv[0]);
+        return 1;
+    }
+    // Si solo se entrega tiempo o nodos, la profundidad por defecto deja de ser un límite
+    if (!depth_set && (options.limits.movetime_ms > 0 || options.limits.nodes > 0)) {
+        options.limits.depth = 0;
+    }
+    return analysis_run(&options) ? 0 : 1;
+}
+
+/**
+ * Modo "match": partidas entre dos configuraciones del motor, con estimación de Elo y test SPRT.
+ * Los motores se configuran con "clave=valor" separados por comas (ver match_parse_engine).
+ * Uso: fortunachess match [-a config] [-b config] [-games N] [-concurrency N] [-tc base+inc] [-openings archivo.epd]
+ *                         [-pgn partidas.pgn] [-elo0 x] [-elo1 y] [-maxplies N] [-nnue red.nnue] [-params archivo]
+ *                         [-tb carpeta]
+ * El control de tiempo se indica en segundos (ej: "10+0.1"); "-tc 0" juega sin reloj (solo con profundidad o nodos).
+ * Con "-nnue" los motores evalúan con la red, salvo los configurados con "nnue=0" (para compararla con la evaluación clásica).
+ */
+int match_command(int argc, char *argv[]) {
+    match_options_t options;
+    match_default_options(&options);
+
+    for (int i = 2; i < argc; i++) {
+        if ((strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "-b") == 0) && i + 1 < argc) {
+            match_engine_t *engine = &options.engines[argv[i][1] == 'a' ? 0 : 1];
+            if (!match_parse_engine(argv[++i], engine)) {
+                fprintf(stderr, "Configuración de motor inválida: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-games") == 0 && i + 1 < argc) {
+            options.games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-concurrency") == 0 && i + 1 < argc) {
+            options.concurrency = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-tc") == 0 && i + 1 < argc) {
+            char *plus;
+            options.base_ms = (int64_t)(strtod(argv[++i], &plus) * 1000);
+            options.increment_ms = *plus == '+' ? (int64_t)(strtod(plus + 1, NULL) * 1000) : 0;
+        } else if (strcmp(argv[i], "-openings") == 0 && i + 1 < argc) {
+            options.openings_path = argv[++i];
+        } else if (strcmp(argv[i], "-pgn") == 0 && i + 1 < argc) {
+            options.pgn_path = argv[++i];
+        } else if (strcmp(argv[i], "-elo0") == 0 && i + 1 < argc) {
+            options.elo0 = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-elo1") == 0 && i + 1 < argc) {
+            options.elo1 = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-maxplies") == 0 && i + 1 < argc) {
+            options.max_plies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-nnue") == 0 && i + 1 < argc) {
+            if (!load_network_option(argv[++i])) return 1;
+        } else if (strcmp(argv[i], "-params") == 0 && i + 1 < argc) {
+            if (!load_params_option(argv[++i])) return 1;
+        } else if (strcmp(argv[i], "-tb") == 0 && i + 1 < argc) {
+            if (!load_tablebase_option(argv[++i])) return 1;
+        } else {
+            fprintf(stderr, "Argumento desconocido: %s\n", argv[i]);
+            fprintf(stderr, "Uso: %s match [-a config] [-b config] [-games N] [-concurrency N] [-tc base+inc] "
+                            "[-openings archivo.epd] [-pgn partidas.pgn] [-elo0 x] [-elo1 y] [-maxplies N] [-nnue red.nnue] "
+                            "[-params archivo] [-tb carpeta]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    match_score_t score;
+    return match_run(&options, &score) ? 0 : 1;
+}
+
+/**
+ * Modo "bench": busca un conjunto fijo de posiciones a profundidad fija con un hilo.
+ * El total de nodos es determinista (sirve para detectar cambios de comportamiento) y los nodos/s miden la velocidad.
+ * Uso: fortunachess bench [profundidad] [-v] [-nnue red.nnue] [-params archivo]
+ */
+int bench_command(int argc, char *argv[]) {
+    int depth = BENCH_DEFAULT_DEPTH;
+    bool verbose = false;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[i], "-nnue") == 0 && i + 1 < argc) {
+            if (!load_network_option(argv[++i])) return 1;
+        } else if (strcmp(argv[i], "-params") == 0 && i + 1 < argc) {
+            if (!load_params_option(argv[++i])) return 1;
+        } else if (atoi(argv[i]) > 0) {
+            depth = atoi(argv[i]);
+        } else {
+            fprintf(stderr, "Uso: %s bench [profundidad] [-v] [-nnue red.nnue] [-params archivo]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // El bitbase KPK se genera antes, para no contar su tiempo en la búsqueda
+    kpk_init();
+    bench_result_t result;
+    if (!bench_run(depth, verbose, &result)) {
+        fprintf(stderr, "[ BENCH ] No hay memoria suficiente para la tabla de transposición\n");
+        return 1;
+    }
+    double seconds = result.time_ms > 0 ? result.time_ms / 1000.0 : 0.001;
+    printf("[ BENCH ] Posiciones: %d | Profundidad: %d | Hash: %d MB | Hilos: 1\n", result.positions, depth, BENCH_HASH_MB);
+    if (nnue_ready()) printf("[ BENCH ] Evaluación: red neuronal (%s)\n", nnue_simd_name());
+    printf("[ BENCH ] Tiempo: %.2f s\n", seconds);
+    printf("[ BENCH ] Nodos/s: %.0f\n", result.nodes / seconds);
+    printf("[ BENCH ] Memoria por hilo: %zu KB\n", (result.memory_peak + 1023) / 1024);
+    if (result.eval_cache_probes > 0) {
+        printf("[ BENCH ] Caché de evaluaciones: %.1f%% aciertos (%d MB)\n",
+               100.0 * result.eval_cache_hits / result.eval_cache_probes, BENCH_EVAL_CACHE_MB);
+    }
+    if (result.pawn_probes > 0) {
+        printf("[ BENCH ] Tabla de peones: %.1f%% aciertos (%zu MB)\n", 100.0 * result.pawn_hits / result.pawn_probes, pawn_hash_size());
+    }
+    printf("[ BENCH ] Bitbase KPK: generado en %.1f ms (%d KB)\n", kpk_generation_ms(), KPK_BYTES / 1024);
+    printf("[ BENCH ] Nodos: %" PRIu64 "\n", result.nodes);
+    return 0;
+}
+
+/**
+ * Modo "perft": verifica la generación de movimientos.
+ * Uso: fortunachess perft <suite.epd> [-threads N] [-maxdepth N]
+ *      fortunachess perft divide <profundidad> [fen]
+ *      fortunachess perft stats <profundidad> [fen]   (capturas, en passant, enroques, promociones, jaques y mates)
+ */
+int perft_command(int argc, char *argv[]) {
+    bool divide = argc >= 4 && strcmp(argv[2], "divide") == 0;
+    bool stats = argc >= 4 && strcmp(argv[2], "stats") == 0;
+    if (divide || stats) {
+        int depth = atoi(argv[3]);
+        gamestate_t game;
+        memset(&game, 0, sizeof(gamestate_t));
+        game.en_passant_square = -1;
+        if (argc >= 5) {
+            // El FEN puede venir en un solo argumento o separado en varios
+            char fen[PERFT_MAX_LINE] = "";
+            size_t len = 0;
+            for (int i = 4; i < argc && len < sizeof(fen) - 1; i++) {
+                len += snprintf(fen + len, sizeof(fen) - len, "%s%s", i > 4 ? " " : "", argv[i]);
+            }
+            if (init_board_fen(&game, fen) != 0) {
+                fprintf(stderr, "FEN inválido: %s\n", fen);
+                return 1;
+            }
+        } else {
+            init_board(&game);
+        }
+        int64_t start = platform_time_ms();
+        uint64_t nodes;
+        if (divide) {
+            nodes = perft_divide(&game, depth, stdout);
+        } else {
+            perft_stats_t counts = {0};
+            if (depth > 0) perft_detailed(&game, depth, &counts);
+            nodes = counts.nodes;
+            printf("Nodos: %" PRIu64 "\nCapturas: %" PRIu64 "\nEn passant: %" PRIu64 "\nEnroques: %" PRIu64 "\n"
+                   "Promociones: %" PRIu64 "\nJaques: %" PRIu64 "\nJaques mate: %" PRIu64 "\n",
+                   counts.nodes, counts.captures, counts.en_passant, counts.castles,
+                   counts.promotions, counts.checks, counts.checkmates);
+        }
+        double seconds = (platform_time_ms() - start) / 1000.0;
+        printf("Tiempo: %.3f s (%.0f nodos/s)\n", seconds, seconds > 0 ? nodes / seconds : 0);
+        return 0;
+    }
+
+    perft_suite_options_t options = {NULL, 0, 0};
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-maxdepth") == 0 && i + 1 < argc) {
+            options.max_depth = atoi(argv[++i]);
+        } else if (options.path == NULL) {
+            options.path = argv[i];
+        } else {
+            fprintf(stderr, "Argumento desconocido: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (options.path == NULL) {
+        fprintf(stderr, "Uso: %s perft <suite.epd> [-threads N] [-maxdepth N]\n", argv[0]);
+        fprintf(stderr, "     %s perft divide <profundidad> [fen]\n", argv[0]);
+        fprintf(stderr, "     %s perft stats <profundidad> [fen]\n", argv[0]);
+        return 1;
+    }
+    int failed = 0;
+    if (!perft_suite_run(&options, &failed)) return 1;
+    return failed == 0 ? 0 : 1;
+}
+
+/**
+ * Modo "tune": ajusta los parámetros de la evaluación clásica con posiciones etiquetadas con el resultado de
+ * su partida (método de Texel, ver tuner.h) y los guarda en un archivo que se carga con "-params" o "EvalParams".
+ * Parte de los parámetros actuales (los de "-params" si se entrega).
+ * Uso: fortunachess tune <posiciones.epd> [-threads N] [-iterations N] [-rate x] [-params archivo] [-o salida.params]
+ */
+int tune_command(int argc, char *argv[]) {
+    tuner_options_t options;
+    tuner_default_options(&options);
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-iterations") == 0 && i + 1 < argc) {
+            options.iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-rate") == 0 && i + 1 < argc) {
+            options.rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-params") == 0 && i + 1 < argc) {
+            if (!load_params_option(argv[++i])) return 1;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            options.output_path = argv[++i];
+        } else if (options.input_path == NULL) {
+            options.input_path = argv[i];
+        } else {
+            fprintf(stderr, "Argumento desconocido: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (options.input_path == NULL) {
+        fprintf(stderr, "Uso: %s tune <posiciones.epd> [-threads N] [-iterations N] [-rate x] [-params archivo] "
+                        "[-o salida.params]\n", argv[0]);
+        return 1;
+    }
+    return tuner_run(&options) ? 0 : 1;
+}
+
+/**
+ * Modo "tbgen": genera una tabla de finales (y las tablas menores que necesita) en una carpeta, por análisis
+ * retrógrado (ver tablebase_builder.h). Las tablas que ya están en la carpeta no se vuelven a generar.
+ * Uso: fortunachess tbgen <firma> [-threads N] [-dir carpeta]
+ * Ej: "fortunachess tbgen KRPvKR" genera KRPvKR, KRvKR, KRPvK, KQRvKR, ... en la carpeta "tablas".
+ */
+int tbgen_command(int argc, char *argv[]) {
+    tb_builder_options_t options;
+    tb_builder_default_options(&options);
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-dir") == 0 && i + 1 < argc) {
+            options.dir = argv[++i];
+        } else if (options.material == NULL) {
+            options.material = argv[i];
+        } else {
+            fprintf(stderr, "Argumento desconocido: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (options.material == NULL) {
+        fprintf(stderr, "Uso: %s tbgen <firma> [-threads N] [-dir carpeta] (ej: KRPvKR, hasta %d piezas)\n",
+                argv[0], TB_MAX_PIECES);
+        return 1;
+    }
+    return tb_builder_run(&options) ? 0 : 1;
+}
+
+/**
+ * Modo "mate": busca el mate más corto para el bando que mueve en una posición (ver mate.h).
+ * Uso: fortunachess mate <fen> [-moves N] [-movetime ms] [-nodes N] [-hash MB] [-all] [-nodfpn]
+ * "-moves" limita la búsqueda de mate en N cuando df-pn no encuentra el mate (o con "-nodfpn"); "-all" deja que
+ * el atacante pruebe también jugadas sin jaque.
+ */
+int mate_command(int argc, char *argv[]) {
+    mate_options_t options;
+    mate_default_options(&options);
+    // El FEN puede venir en un solo argumento o separado en varios (sus campos "-" no son opciones)
+    char fen[PERFT_MAX_LINE] = "";
+    size_t len = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-moves") == 0 && i + 1 < argc) {
+            options.max_moves = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-movetime") == 0 && i + 1 < argc) {
+            options.movetime_ms = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-nodes") == 0 && i + 1 < argc) {
+            options.nodes = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-hash") == 0 && i + 1 < argc) {
+            options.hash_mb = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-all") == 0) {
+            options.checks_only = false;
+        } else if (strcmp(argv[i], "-nodfpn") == 0) {
+            options.use_dfpn = false;
+        } else if (len < sizeof(fen) - 1) {
+            len += snprintf(fen + len, sizeof(fen) - len, "%s%s", len > 0 ? " " : "", argv[i]);
+        }
+    }
+
+    gamestate_t game;
+    memset(&game, 0, sizeof(gamestate_t));
+    if (len == 0 || init_board_fen(&game, fen) != 0) {
+        if (len > 0) fprintf(stderr, "FEN inválido: %s\n", fen);
+        fprintf(stderr, "Uso: %s mate <fen> [-moves N] [-movetime ms] [-nodes N] [-hash MB] [-all] [-nodfpn]\n", argv[0]);
+        return 1;
+    }
+
+    mate_result_t result;
+    if (!mate_solve(&game, &options, &result)) {
+        fprintf(stderr, "No hay memoria suficiente para el solucionador de mates\n");
+        return 1;
+    }
+
+    if (result.status == MATE_FOUND) {
+        printf("[ MATE ] Mate en %d%s:", result.mate_in, result.shortest ? "" : " (puede haber uno más corto)");
+        for (int i = 0; i < result.pv_length; i++) {
+            char move_str[8];
+            move_to_string(&result.pv[i], move_str);
+            printf(" %s", move_str);
+        }
+        printf("\n");
+    } else if (result.status == MATE_NONE) {
+        printf("[ MATE ] No hay mate%s\n", options.checks_only ? " dando solo jaques" : "");
+    } else if (result.searched_moves > 0) {
+        printf("[ MATE ] No se encontró mate (no hay mate en %d o menos)\n", result.searched_moves);
+    } else {
+        printf("[ MATE ] No se encontró mate\n");
+    }
+    if (options.use_dfpn) {
+        printf("[ MATE ] df-pn: %" PRIu64 " nodos, tabla %.1f%% usada (%zu entradas)\n", result.dfpn_nodes,
+               result.dfpn_capacity ? 100.0 * result.dfpn_entries / result.dfpn_capacity : 0.0, result.dfpn_capacity);
+    }
+    printf("[ MATE ] Mate en N: %" PRIu64 " nodos\n", result.search_nodes);
+    uint64_t nodes = result.dfpn_nodes + result.search_nodes;
+    printf("[ MATE ] Tiempo: %" PRId64 " ms (%.0f nodos/s)\n", result.time_ms,
+           result.time_ms > 0 ? nodes * 1000.0 / result.time_ms : 0.0);
+    return result.status == MATE_FOUND ? 0 : 2;
+}
+
+/**
+ * Modo "mcts": elige la jugada de una posición con la búsqueda de árbol Monte Carlo (ver mcts.h) e informa las
+ * simulaciones por segundo de cada hilo.
+ * Uso: fortunachess mcts [fen] [-movetime ms] [-nodes N] [-threads N] [-c x] [-leafdepth N] [-rollout N] [-hash MB]
+ *                        [-nnue red.nnue]
+ * "-nodes" limita las simulaciones y "-c" es la constante de exploración de UCT. Sin FEN se usa la posición inicial.
+ */
+int mcts_command(int argc, char *argv[]) {
+    search_limits_t limits = {0};
+    search_params_t params = search_default_params;
+    params.use_mcts = true;
+    int threads = 1;
+    size_t hash_mb = TT_DEFAULT_MB;
+    char fen[PERFT_MAX_LINE] = "";
+    size_t len = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-movetime") == 0 && i + 1 < argc) {
+            limits.movetime_ms = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-nodes") == 0 && i + 1 < argc) {
+            limits.nodes = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            params.mcts_exploration = (int)(atof(argv[++i]) * 100.0 + 0.5);
+        } else if (strcmp(argv[i], "-leafdepth") == 0 && i + 1 < argc) {
+            params.mcts_leaf_depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-rollout") == 0 && i + 1 < argc) {
+            params.mcts_rollout_plies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-hash") == 0 && i + 1 < argc) {
+            hash_mb = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-nnue") == 0 && i + 1 < argc) {
+            if (!load_network_option(argv[++i])) return 1;
+        } else if (len < sizeof(fen) - 1) {
+            len += snprintf(fen + len, sizeof(fen) - len, "%s%s", len > 0 ? " " : "", argv[i]);
+        }
+    }
+    if (threads < 1 || threads > SEARCH_MAX_THREADS) {
+        fprintf(stderr, "Uso: %s mcts [fen] [-movetime ms] [-nodes N] [-threads N] [-c x] [-leafdepth N] [-rollout N] "
+                        "[-hash MB] [-nnue red.nnue] (hasta %d hilos)\n", argv[0], SEARCH_MAX_THREADS);
+        return 1;
+    }
+    if (limits.movetime_ms <= 0 && limits.nodes == 0) limits.movetime_ms = BOT_MOVE_TIME_MS;
+
+    gamestate_t game;
+    memset(&game, 0, sizeof(gamestate_t));
+    if (init_board_fen(&game, len > 0 ? fen : START_FEN) != 0) {
+        fprintf(stderr, "FEN inválido: %s\n", fen);
+        return 1;
+    }
+
+    tt_t tt;
+    search_context_t *ctx = malloc(sizeof(search_context_t));
+    if (!ctx || !tt_init(&tt, hash_mb)) {
+        fprintf(stderr, "No hay memoria suficiente para la búsqueda\n");
+        free(ctx);
+        return 1;
+    }
+    search_init(ctx, &limits, NULL);
+    ctx->params = params;
+    ctx->tt = &tt;
+
+    search_result_t result;
+    bool found = search_run_threads(ctx, &game, threads, &result);
+    free(ctx);
+    tt_free(&tt);
+    if (!found) {
+        printf("[ MCTS ] La posición no tiene jugadas legales\n");
+        return 2;
+    }
+
+    char score[16];
+    char move_str[8];
+    search_score_to_string(result.score, score);
+    move_to_string(&result.best_move, move_str);
+    printf("[ MCTS ] Mejor jugada: %s (%s)\n", move_str, score);
+    printf("[ MCTS ] Variante más visitada:");
+    for (int i = 0; i < result.pv_length; i++) {
+        move_to_string(&result.pv[i], move_str);
+        printf(" %s", move_str);
+    }
+    printf("\n");
+    double seconds = result.time_ms > 0 ? result.time_ms / 1000.0 : 0.001;
+    for (int i = 0; i < result.threads; i++) {
+        printf("[ MCTS ] Hilo %d: %" PRIu64 " simulaciones (%.0f/s)\n", i, result.thread_playouts[i],
+               result.thread_playouts[i] / seconds);
+    }
+    printf("[ MCTS ] Total: %" PRIu64 " simulaciones (%.0f/s), %" PRIu64 " nodos, árbol de %.1f MB, %" PRId64 " ms\n",
+           result.playouts, result.playouts / seconds, result.nodes, result.memory_peak / (1024.0 * 1024.0),
+           result.time_ms);
+    return 0;
 }
 
 /**
  * Bucle principal del juego.
  * Se encarga de recibir los movimientos del usuario y de mostrar el tablero.
- * Por el momento, no existe un menú, y solo se puede jugar una partida.
+ * Si se entrega un modo por línea de comandos (ej: "makebook"), se ejecuta ese modo sin entrar al menú.
  */
-int main() {
+int main(int argc, char *argv[]) {
     // Establece la página de códigos de salida usada por la consola
     // Necesitamos hacer esto para que los caracteres especiales de se rendericen bien
     #ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
     #endif
 
-    // Initializar estructuras principales para los tests
-    gamestate_t game;
-    move_t move;
-
-    // Realizar benchmark PERFT en una posición complicada
-    // Debería dar:
-    // Profunidad 1: 48 nodos
-    // Profunidad 2: 2039 nodos
-    // Profunidad 3: 97862 nodos
-    // Profunidad 4: 4085603 nodos
-    // Profunidad 5: 193690690 nodos
-    const char *perft_fen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -";
-    init_board_fen(&game, perft_fen);
-    perft_benchmark(&game, 4);
-
-    // Test funcionamiento minimax (Grafo implícito)
-    //init_board(&game);
-    //move_t best_move = find_best_move(&game, 6);
+    // Modos de línea de comandos
+    if (argc >= 2 && strcmp(argv[1], "makebook") == 0) {
+        return makebook_command(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "pgn") == 0) {
+        return pgn_command(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "analyze") == 0) {
+        return analyze_command(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "uci") == 0) {
+        return uci_loop();
+    }
+    if (argc >= 2 && strcmp(argv[1], "match") == 0) {
+        return match_command(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        return bench_command(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "perft") == 0) {
+        return perft_command(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "tune") == 0) {
+        return tune_command(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "tbgen") == 0) {
+        return tbgen_command(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "mate") == 0) {
+        return mate_command(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "mcts") == 0) {
+        return mcts_command(argc, argv);
+    }
 
-    init_board(&game);
-    
-    // Test funcionamiento de TDA tabla hash + Zobrist hashing
+    // Cargar el libro de aperturas y convertirlo al formato compacto
     book = hashtable_create();
     if (!load_polyglot_book("book.bin", book)) {
         printf("[ HASHTABLE ] No se pudo cargar libro de aperturas (book.bin)\n");
@@ -547,35 +1204,24 @@ int main() {
 
     printf("[ HASHTABLE ] Se cargaron %d posiciones correctamente\n", hashtable_get_size(book));
 
-    // Test gamestate_t a FEN
-    char fen[128];
-    gamestate_to_fen(&game, fen);
-    printf("[ DEBUG ] FEN: %s\n", fen);
-
-    // Obtener clave Zobrist para posición inicial
-    uint64_t key_initial = polyglot_hash(fen);
-    printf("[ ZOBRIST ] Clave posición inicial: %016llx\n", key_initial);
-
-    // Simulamos e2e4 y obtenemos la nueva clave
-    make_dummy_e2e4(&game);
-    gamestate_to_fen(&game, fen);
-    uint64_t key_after_e4 = polyglot_hash(fen);
-    printf("[ ZOBRIST ] Clave después de e2e4: %016llx\n", key_after_e4);
-
-    // Utilizamos nuestra hashtable (libro de apertura) para obtener los mejores movimientos en 2 posiciones de prueba 
-    char recommended_move[MAX_MOVE_STR];
-    if (hashtable_lookup_best_move(book, key_initial, recommended_move))
-        printf("[ HASHTABLE ] Movimiento recomendado para posición inicial: %s\n", recommended_move);
-    else
-        printf("[ HASHTABLE ] No se encontró un movimiento para la posición inicial.\n");
-
-    if (hashtable_lookup_best_move(book, key_after_e4, recommended_move))
-        printf("[ HASHTABLE ] Movimiento recomendado después de e2e4: %s\n", recommended_move);
-    else
-        printf("[ HASHTABLE ] No se encontró un movimiento para la posición después de 1. e2e4.\n");
-
+    // Convertir la tabla hash al formato compacto y comparar la memoria usada por ambos
+    opening_book = book_create_from_hashtable(book);
+    book_print_memory_report(book, opening_book);
     hashtable_destroy(book);
 
+    // La red neuronal es opcional: sin archivo de pesos se usa la evaluación clásica
+    if (nnue_load(NNUE_DEFAULT_FILE)) {
+        printf("[ NNUE ] Se cargó la red %s (%s)\n", NNUE_DEFAULT_FILE, nnue_simd_name());
+    }
+    // Lo mismo con los parámetros ajustados por el tuner
+    if (eval_params_load(EVAL_DEFAULT_PARAMS_FILE)) {
+        printf("[ EVAL ] Se cargaron los parámetros de %s\n", EVAL_DEFAULT_PARAMS_FILE);
+    }
+    // Y con las tablas de finales generadas con "tbgen"
+    if (tb_init(TB_DEFAULT_DIR) > 0) {
+        printf("[ TB ] Se cargaron tablas de finales de hasta %d piezas (%s)\n", tb_max_pieces(), TB_DEFAULT_DIR);
+    }
+
     // Menú principal
     main_menu();
     
@@ -0,0 +1,550 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "match.h"
+#include "analysis.h"
+#include "pgn.h"
+#include "platform.h"
+
+#define MATCH_MOVETEXT_SIZE 16384   // Largo máximo del texto de jugadas de una partida
+#define MATCH_PGN_LINE 79           // Largo máximo de una línea de jugadas en el PGN
+
+// Aperturas usadas cuando no se indica un archivo (posiciones equilibradas después de unas pocas jugadas)
+static const char *default_openings[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2",
+    "rnbqkbnr/pp1ppppp/8/2p5/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2",
+    "rnbqkbnr/pppp1ppp/4p3/8/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2",
+    "rnbqkbnr/ppp1pppp/8/3p4/3P4/8/PPP1PPPP/RNBQKBNR w KQkq - 0 2",
+    "rnbqkb1r/pppppppp/5n2/8/3P4/8/PPP1PPPP/RNBQKBNR w KQkq - 1 2",
+    "rnbqkbnr/pppppppp/8/8/2P5/8/PP1PPPPP/RNBQKBNR b KQkq - 0 1",
+    "rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - 1 1",
+};
+
+typedef struct {
+    char fen[ANALYSIS_MAX_LINE];
+} match_opening_t;
+
+// Estado compartido entre los hilos que juegan las partidas
+typedef struct {
+    const match_options_t *options;
+    match_opening_t *openings;
+    int opening_count;
+    FILE *pgn;
+    int next_game;                  // Próxima partida por jugar
+    int finished;                   // Partidas terminadas
+    bool decided;                   // El SPRT ya aceptó una de las hipótesis: no se empiezan más partidas
+    match_score_t score;
+    double llr_lower, llr_upper;
+    // Una caché de evaluaciones por motor (sus parámetros de evaluación pueden ser distintos), compartida por todos los hilos
+    evalcache_t eval_caches[2];
+    pthread_mutex_t lock;
+} match_t;
+
+// Resultado de una partida
+typedef struct {
+    int winner;                     // WHITE, BLACK o -1 si son tablas
+    const char *reason;             // Motivo del resultado (para mostrar)
+    const char *termination;        // Valor de la etiqueta Termination del PGN
+} match_game_result_t;
+
+void match_default_options(match_options_t *options) {
+    memset(options, 0, sizeof(match_options_t));
+    for (int i = 0; i < 2; i++) {
+        match_engine_t *engine = &options->engines[i];
+        snprintf(engine->name, MATCH_MAX_NAME, "%s", i == 0 ? "A" : "B");
+        engine->params = search_default_params;
+        engine->hash_mb = 8;
+    }
+    options->games = 100;
+    options->concurrency = 0;
+    options->base_ms = 10000;
+    options->increment_ms = 100;
+    options->max_plies = MATCH_DEFAULT_MAX_PLIES;
+    options->elo0 = 0;
+    options->elo1 = 5;
+    options->alpha = 0.05;
+    options->beta = 0.05;
+}
+
+/**
+ * Lee la configuración de un motor en formato "clave=valor,clave=valor".
+ * Claves: name, tt (0/1), pvs (0/1), mobility (peso), nnue (0/1), depth, nodes, hash (MB), y para MCTS (ver mcts.h):
+ * mcts (0/1), uct (exploración en centésimas), leafdepth, rollout (plies).
+ * @param spec: texto a interpretar (ej: "name=sin-pvs,pvs=0,depth=4").
+ * @param engine: configuración a modificar (las claves ausentes conservan su valor).
+ * @return false si alguna clave o valor no es válido.
+ */
+bool match_parse_engine(const char *spec, match_engine_t *engine) {
+    const char *p = spec;
+    while (*p) {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        char item[64];
+        if (len == 0 || len >= sizeof(item)) return false;
+        memcpy(item, p, len);
+        item[len] = '\0';
+
+        char *value = strchr(item, '=');
+        if (!value) return false;
+        *value++ = '\0';
+        char *rest;
+        long number = strtol(value, &rest, 10);
+        bool numeric = *value != '\0' && *rest == '\0' && number >= 0;
+
+        if (strcmp(item, "name") == 0) {
+            if (*value == '\0') return false;
+            snprintf(engine->name, MATCH_MAX_NAME, "%s", value);
+        } else if (!numeric) {
+            return false;
+        } else if (strcmp(item, "tt") == 0) {
+            engine->params.use_tt = number != 0;
+        } else if (strcmp(item, "pvs") == 0) {
+            engine->params.use_pvs = number != 0;
+        } else if (strcmp(item, "mobility") == 0) {
+            engine->params.mobility_weight = (int)number;
+        } else if (strcmp(item, "nnue") == 0) {
+            engine->params.use_nnue = number != 0;
+        } else if (strcmp(item, "mcts") == 0) {
+            engine->params.use_mcts = number != 0;
+        } else if (strcmp(item, "uct") == 0) {
+            engine->params.mcts_exploration = (int)number;
+        } else if (strcmp(item, "leafdepth") == 0) {
+            engine->params.mcts_leaf_depth = (int)number;
+        } else if (strcmp(item, "rollout") == 0) {
+            engine->params.mcts_rollout_plies = (int)number;
+        } else if (strcmp(item, "depth") == 0) {
+            engine->limits.depth = (int)number;
+        } else if (strcmp(item, "nodes") == 0) {
+            engine->limits.nodes = (uint64_t)number;
+        } else if (strcmp(item, "hash") == 0) {
+            engine->hash_mb = number > 0 ? (size_t)number : 1;
+        } else {
+            return false;
+        }
+        p += len;
+        if (*p == ',') p++;
+    }
+    return true;
+}
+
+// Puntaje esperado para una diferencia de Elo (curva logística)
+static double elo_to_score(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+static double score_to_elo(double score) {
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+// Media y varianza del puntaje por partida (victoria = 1, tablas = 0.5, derrota = 0)
+static bool score_stats(const match_score_t *score, double *mean, double *variance) {
+    int games = score->wins + score->draws + score->losses;
+    if (games == 0) return false;
+    double w = (double)score->wins / games;
+    double d = (double)score->draws / games;
+    double l = (double)score->losses / games;
+    *mean = w + d / 2.0;
+    *variance = w * (1.0 - *mean) * (1.0 - *mean) + d * (0.5 - *mean) * (0.5 - *mean) + l * (*mean) * (*mean);
+    return true;
+}
+
+/**
+ * Diferencia de Elo estimada de engines[0] sobre engines[1].
+ * @param margin: recibe el margen del intervalo de confianza del 95% (puede ser NULL).
+ */
+double match_elo(const match_score_t *score, double *margin) {
+    double mean, variance;
+    if (margin) *margin = 0;
+    if (!score_stats(score, &mean, &variance)) return 0;
+    int games = score->wins + score->draws + score->losses;
+    // Con 0% o 100% de puntaje la diferencia es infinita: se acota para mostrar un valor finito
+    double clamped = fmin(fmax(mean, 0.001), 0.999);
+    if (margin) {
+        double deviation = sqrt(variance / games);
+        double low = fmin(fmax(mean - 1.96 * deviation, 0.001), 0.999);
+        double high = fmin(fmax(mean + 1.96 * deviation, 0.001), 0.999);
+        *margin = (score_to_elo(high) - score_to_elo(low)) / 2.0;
+    }
+    return score_to_elo(clamped);
+}
+
+// Probabilidad de que engines[0] sea más fuerte (likelihood of superiority). Las tablas no aportan información
+double match_los(const match_score_t *score) {
+    int decisive = score->wins + score->losses;
+    if (decisive == 0) return 0.5;
+    return 0.5 * (1.0 + erf((score->wins - score->losses) / sqrt(2.0 * decisive)));
+}
+
+/**
+ * Log-likelihood ratio del SPRT entre H1 (diferencia elo1) y H0 (diferencia elo0),
+ * con la aproximación normal del puntaje por partida.
+ */
+double match_sprt_llr(const match_score_t *score, double elo0, double elo1) {
+    int games = score->wins + score->draws + score->losses;
+    if (games == 0) return 0;
+    // Si algún resultado no ha ocurrido la varianza se subestima (o es 0): se agrega media partida de cada tipo
+    double w = score->wins, d = score->draws, l = score->losses;
+    if (w == 0 || d == 0 || l == 0) {
+        w += 0.5;
+        d += 0.5;
+        l += 0.5;
+    }
+    double n = w + d + l;
+    double mean = (w + d / 2.0) / n;
+    double variance = (w * (1.0 - mean) * (1.0 - mean) + d * (0.5 - mean) * (0.5 - mean) + l * mean * mean) / n;
+    double s0 = elo_to_score(elo0);
+    double s1 = elo_to_score(elo1);
+    return n * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+}
+
+// Lee las aperturas del archivo (una posición EPD/FEN por línea) o usa las incluidas
+static bool load_openings(match_t *match, const char *path) {
+    if (!path) {
+        int count = (int)(sizeof(default_openings) / sizeof(default_openings[0]));
+        match->openings = malloc(count * sizeof(match_opening_t));
+        if (!match->openings) return false;
+        for (int i = 0; i < count; i++) snprintf(match->openings[i].fen, ANALYSIS_MAX_LINE, "%s", default_openings[i]);
+        match->opening_count = count;
+        return true;
+    }
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror("[ MATCH ] Error al abrir el archivo de aperturas");
+        return false;
+    }
+    int capacity = 64;
+    match->openings = malloc(capacity * sizeof(match_opening_t));
+    match->opening_count = 0;
+    char line[ANALYSIS_MAX_LINE];
+    char id[ANALYSIS_MAX_ID];
+    while (match->openings && fgets(line, sizeof(line), file)) {
+        char *text = line;
+        while (isspace((unsigned char)*text)) text++;
+        if (*text == '\0' || *text == '#') continue;
+        if (match->opening_count == capacity) {
+            capacity *= 2;
+            match_opening_t *grown = realloc(match->openings, capacity * sizeof(match_opening_t));
+            if (!grown) {
+                free(match->openings);
+                match->openings = NULL;
+                break;
+            }
+            match->openings = grown;
+        }
+        match_opening_t *opening = &match->openings[match->opening_count];
+        gamestate_t game;
+        memset(&game, 0, sizeof(gamestate_t));
+        game.en_passant_square = -1;
+        if (!analysis_parse_epd(text, opening->fen, id) || init_board_fen(&game, opening->fen) != 0) {
+            fprintf(stderr, "[ MATCH ] Apertura inválida ignorada: %s", line);
+            continue;
+        }
+        match->opening_count++;
+    }
+    fclose(file);
+    if (!match->openings || match->opening_count == 0) {
+        fprintf(stderr, "[ MATCH ] El archivo de aperturas no tiene posiciones válidas\n");
+        free(match->openings);
+        match->openings = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Triple repetición: la posición actual ya apareció dos veces desde la última captura o movimiento de peón
+static bool is_threefold(const gamestate_t *game, const uint64_t *keys, int count) {
+    int repetitions = 0;
+    for (int i = count - 2; i >= 0 && i >= count - game->halfmove_clock; i -= 2) {
+        if (keys[i] == game->key && ++repetitions >= 2) return true;
+    }
+    return false;
+}
+
+// Agrega un token al texto de jugadas, cortando las líneas según el largo máximo del PGN
+static void append_token(char *text, size_t *len, int *line_len, const char *token) {
+    size_t token_len = strlen(token);
+    if (*len + token_len + 2 >= MATCH_MOVETEXT_SIZE) return;
+    if (*line_len > 0) {
+        if (*line_len + 1 + (int)token_len > MATCH_PGN_LINE) {
+            text[(*len)++] = '\n';
+            *line_len = 0;
+        } else {
+            text[(*len)++] = ' ';
+            (*line_len)++;
+        }
+    }
+    memcpy(text + *len, token, token_len + 1);
+    *len += token_len;
+    *line_len += (int)token_len;
+}
+
+/**
+ * Juega una partida completa entre los dos motores.
+ * @param index: número de partida (define la apertura y los colores).
+ * @param ctx: contexto de búsqueda del hilo.
+ * @param tts: tablas de transposición de cada motor (se limpian al empezar).
+ * @param pool: pool de memoria del hilo para las búsquedas.
+ * @param keys: buffer de max_plies + 1 claves para detectar repeticiones.
+ * @param movetext: buffer de MATCH_MOVETEXT_SIZE caracteres que recibe las jugadas en SAN.
+ * @param a_color: recibe el color con que juega engines[0].
+ */
+static match_game_result_t play_game(match_t *match, int index, search_context_t *ctx, tt_t tts[2], pool_t *pool,
+                                     uint64_t *keys, char *movetext, int *a_color) {
+    const match_options_t *options = match->options;
+    const char *fen = match->openings[(index / 2) % match->opening_count].fen;
+    *a_color = index % 2 == 0 ? WHITE : BLACK;
+    match_game_result_t result = {-1, "", "normal"};
+
+    gamestate_t game;
+    memset(&game, 0, sizeof(gamestate_t));
+    game.en_passant_square = -1;
+    init_board_fen(&game, fen);
+    int64_t clocks[2] = {options->base_ms, options->base_ms};
+    tt_clear(&tts[0]);
+    tt_clear(&tts[1]);
+
+    size_t len = 0;
+    int line_len = 0;
+    movetext[0] = '\0';
+
+    for (int ply = 0; ; ply++) {
+        game_result_t state = evaluate_game_state(&game);
+        if (state != GAME_ONGOING) {
+            if (state == GAME_CHECKMATE_WHITE) result.winner = WHITE;
+            if (state == GAME_CHECKMATE_BLACK) result.winner = BLACK;
+            result.reason = get_game_result_name(state);
+            break;
+        }
+        if (is_threefold(&game, keys, ply)) {
+            result.reason = get_game_result_name(GAME_DRAW_REPETITION);
+            break;
+        }
+        if (ply >= options->max_plies) {
+            result.reason = "Tablas por adjudicación (partida demasiado larga)";
+            result.termination = "adjudication";
+            break;
+        }
+
+        int side = game.to_move;
+        int engine_index = side == *a_color ? 0 : 1;
+        const match_engine_t *engine = &options->engines[engine_index];
+
+        search_result_t search;
+        search_init(ctx, &engine->limits, NULL);
+        ctx->params = engine->params;
+        ctx->tt = &tts[engine_index];
+        ctx->pool = pool;
+        if (match->eval_caches[engine_index].entries) ctx->eval_cache = &match->eval_caches[engine_index];
+        ctx->history_keys = keys;
+        ctx->history_count = ply;
+        int64_t start = platform_time_ms();
+        if (options->base_ms > 0) {
+            search_set_deadline(ctx, search_time_for_move(clocks[side], options->increment_ms, 0));
+        }
+        if (!search_run(ctx, &game, &search)) break;    // No ocurre: evaluate_game_state detecta el fin de partida
+
+        if (options->base_ms > 0) {
+            clocks[side] -= platform_time_ms() - start;
+            if (clocks[side] < 0) {
+                result.winner = side == WHITE ? BLACK : WHITE;
+                result.reason = side == WHITE ? "Las blancas perdieron por tiempo" : "Las negras perdieron por tiempo";
+                result.termination = "time forfeit";
+                break;
+            }
+            clocks[side] += options->increment_ms;
+        }
+
+        char token[32];
+        if (side == WHITE) {
+            snprintf(token, sizeof(token), "%d.", game.fullmove_number);
+            append_token(movetext, &len, &line_len, token);
+        } else if (ply == 0) {
+            snprintf(token, sizeof(token), "%d...", game.fullmove_number);
+            append_token(movetext, &len, &line_len, token);
+        }
+        pgn_move_to_san(&game, &search.best_move, token);
+        append_token(movetext, &len, &line_len, token);
+
+        keys[ply] = game.key;
+        make_move(&search.best_move, &game, false);
+    }
+
+    const char *result_str = result.winner == WHITE ? "1-0" : result.winner == BLACK ? "0-1" : "1/2-1/2";
+    append_token(movetext, &len, &line_len, result_str);
+    return result;
+}
+
+// Escribe la partida en el archivo PGN (se llama con el lock tomado)
+static void write_pgn(match_t *match, int index, int a_color, const match_game_result_t *result, const char *movetext) {
+    const match_options_t *options = match->options;
+    const char *fen = match->openings[(index / 2) % match->opening_count].fen;
+    const char *white = options->engines[a_color == WHITE ? 0 : 1].name;
+    const char *black = options->engines[a_color == WHITE ? 1 : 0].name;
+    const char *result_str = result->winner == WHITE ? "1-0" : result->winner == BLACK ? "0-1" : "1/2-1/2";
+
+    char date[16];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y.%m.%d", localtime(&now));
+
+    fprintf(match->pgn, "[Event \"FortunaChess match\"]\n[Site \"?\"]\n[Date \"%s\"]\n[Round \"%d\"]\n", date, index + 1);
+    fprintf(match->pgn, "[White \"%s\"]\n[Black \"%s\"]\n[Result \"%s\"]\n", white, black, result_str);
+    if (strcmp(fen, default_openings[0]) != 0) {
+        fprintf(match->pgn, "[SetUp \"1\"]\n[FEN \"%s\"]\n", fen);
+    }
+    if (options->base_ms > 0) {
+        fprintf(match->pgn, "[TimeControl \"%g+%g\"]\n", options->base_ms / 1000.0, options->increment_ms / 1000.0);
+    } else {
+        fprintf(match->pgn, "[TimeControl \"-\"]\n");
+    }
+    fprintf(match->pgn, "[Termination \"%s\"]\n\n%s\n\n", result->termination, movetext);
+    fflush(match->pgn);
+}
+
+// Registra el resultado de una partida y muestra el estado del match (se llama con el lock tomado)
+static void record_result(match_t *match, int index, int a_color, const match_game_result_t *result) {
+    const match_options_t *options = match->options;
+    const char *outcome;
+    if (result->winner < 0) {
+        match->score.draws++;
+        outcome = "1/2-1/2";
+    } else if (result->winner == a_color) {
+        match->score.wins++;
+        outcome = result->winner == WHITE ? "1-0" : "0-1";
+    } else {
+        match->score.losses++;
+        outcome = result->winner == WHITE ? "1-0" : "0-1";
+    }
+    match->finished++;
+
+    double margin;
+    double elo = match_elo(&match->score, &margin);
+    double llr = match_sprt_llr(&match->score, options->elo0, options->elo1);
+    printf("[ MATCH ] Partida %d (%s con %s): %s %s\n", index + 1, options->engines[0].name,
+           a_color == WHITE ? "blancas" : "negras", outcome, result->reason);
+    printf("[ MATCH ] %s vs %s: +%d =%d -%d | Elo %+.1f +/- %.1f | LOS %.1f%% | LLR %.2f [%.2f, %.2f]\n",
+           options->engines[0].name, options->engines[1].name, match->score.wins, match->score.draws,
+           match->score.losses, elo, margin, 100.0 * match_los(&match->score), llr, match->llr_lower, match->llr_upper);
+    fflush(stdout);
+
+    if (!match->decided && (llr >= match->llr_upper || llr <= match->llr_lower)) {
+        match->decided = true;
+    }
+}
+
+// Hilo de juego: toma el siguiente número de partida hasta completar el match o hasta que el SPRT termine
+static void* match_worker_main(void *arg) {
+    match_t *match = arg;
+    const match_options_t *options = match->options;
+    // Cada hilo es una sesión de juego: el contexto, las tablas y el pool de memoria de la búsqueda se reutilizan
+    // en todas sus partidas, así las búsquedas no piden memoria al sistema en cada jugada
+    search_context_t *ctx = malloc(sizeof(search_context_t));
+    uint64_t *keys = malloc((options->max_plies + 1) * sizeof(uint64_t));
+    char *movetext = malloc(MATCH_MOVETEXT_SIZE);
+    tt_t tts[2] = {0};
+    bool ok = ctx && keys && movetext;
+    for (int i = 0; i < 2 && ok; i++) ok = tt_init(&tts[i], options->engines[i].hash_mb);
+    pool_t pool;
+    pool_init(&pool, ARENA_CHUNK_SIZE, POOL_BLOCKS_PER_CHUNK);
+
+    while (ok) {
+        pthread_mutex_lock(&match->lock);
+        if (match->decided || match->next_game >= options->games) {
+            pthread_mutex_unlock(&match->lock);
+            break;
+        }
+        int index = match->next_game++;
+        pthread_mutex_unlock(&match->lock);
+
+        int a_color;
+        match_game_result_t result = play_game(match, index, ctx, tts, &pool, keys, movetext, &a_color);
+
+        pthread_mutex_lock(&match->lock);
+        if (match->pgn) write_pgn(match, index, a_color, &result, movetext);
+        record_result(match, index, a_color, &result);
+        pthread_mutex_unlock(&match->lock);
+    }
+
+    pool_destroy(&pool);
+    tt_free(&tts[0]);
+    tt_free(&tts[1]);
+    free(movetext);
+    free(keys);
+    free(ctx);
+    return NULL;
+}
+
+/**
+ * Juega un match entre options->engines[0] y options->engines[1]. Cada apertura se juega con ambos colores.
+ * El match termina al completar las partidas o cuando el SPRT acepta H0 o H1.
+ * @param options: motores, aperturas, control de tiempo y parámetros del SPRT.
+ * @param score: recibe el resultado final desde la perspectiva de engines[0].
+ * @return false si no se pudo iniciar el match.
+ */
+bool match_run(const match_options_t *options, match_score_t *score) {
+    match_t match;
+    memset(&match, 0, sizeof(match_t));
+    match.options = options;
+    for (int i = 0; i < 2; i++) {
+        const match_engine_t *engine = &options->engines[i];
+        if (options->base_ms <= 0 && engine->limits.depth <= 0 && engine->limits.nodes == 0 && engine->limits.movetime_ms <= 0) {
+            fprintf(stderr, "[ MATCH ] Sin reloj, el motor %s necesita un límite de profundidad o de nodos\n", engine->name);
+            return false;
+        }
+    }
+    if (options->max_plies <= 0 || !load_openings(&match, options->openings_path)) return false;
+    if (options->pgn_path) {
+        match.pgn = fopen(options->pgn_path, "w");
+        if (!match.pgn) {
+            perror("[ MATCH ] Error al abrir el archivo PGN");
+            free(match.openings);
+            return false;
+        }
+    }
+    match.llr_lower = log(options->beta / (1.0 - options->alpha));
+    match.llr_upper = log((1.0 - options->beta) / options->alpha);
+
+    int threads = options->concurrency > 0 ? options->concurrency : platform_cpu_count();
+    if (threads > options->games) threads = options->games > 0 ? options->games : 1;
+    pthread_t *thread_ids = malloc(threads * sizeof(pthread_t));
+    if (!thread_ids) {
+        if (match.pgn) fclose(match.pgn);
+        free(match.openings);
+        return false;
+    }
+    for (int i = 0; i < 2; i++) evalcache_init(&match.eval_caches[i], EVAL_CACHE_DEFAULT_MB);
+    pthread_mutex_init(&match.lock, NULL);
+
+    printf("[ MATCH ] %s vs %s | %d partidas | %d simultáneas | %d aperturas | SPRT elo0=%.1f elo1=%.1f alpha=%.2f beta=%.2f\n",
+           options->engines[0].name, options->engines[1].name, options->games, threads, match.opening_count,
+           options->elo0, options->elo1, options->alpha, options->beta);
+    int64_t start = platform_time_ms();
+    // Los hilos toman las partidas de un contador compartido: si no se puede crear alguno, las juegan los demás
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&thread_ids[started], NULL, match_worker_main, &match) == 0) started++;
+    }
+    if (started == 0) fprintf(stderr, "[ MATCH ] No se pudo crear ningún hilo para jugar las partidas\n");
+    for (int t = 0; t < started; t++) {
+        pthread_join(thread_ids[t], NULL);
+    }
+
+    double llr = match_sprt_llr(&match.score, options->elo0, options->elo1);
+    const char *verdict = llr >= match.llr_upper ? "H1 aceptada (el cambio es una mejora)"
+                        : llr <= match.llr_lower ? "H0 aceptada (el cambio no es una mejora)"
+                        : "sin decisión";
+    printf("[ MATCH ] Fin: %d partidas en %.1f s | SPRT: %s\n", match.finished,
+           (platform_time_ms() - start) / 1000.0, verdict);
+
+    *score = match.score;
+    for (int i = 0; i < 2; i++) evalcache_free(&match.eval_caches[i]);
+    pthread_mutex_destroy(&match.lock);
+    free(thread_ids);
+    if (match.pgn) fclose(match.pgn);
+    free(match.openings);
+    return match.finished > 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bot.h"
+
+// Partidas automáticas entre dos configuraciones del motor (self-play)
+// Cada apertura se juega dos veces, una con cada color. Las partidas se juegan en paralelo (una por hilo),
+// cada una con su propio reloj y sus propias tablas de transposición.
+// Al final (y después de cada partida) se muestra la diferencia de Elo estimada y el estado del test SPRT.
+// https://www.chessprogramming.org/Sequential_Probability_Ratio_Test
+
+#define MATCH_MAX_NAME 32
+#define MATCH_DEFAULT_MAX_PLIES 400     // Partidas más largas se adjudican como tablas
+
+// Configuración de uno de los dos motores
+typedef struct {
+    char name[MATCH_MAX_NAME];
+    search_params_t params;
+    search_limits_t limits;             // Límites fijos por jugada (profundidad/nodos), además del reloj
+    size_t hash_mb;
+} match_engine_t;
+
+typedef struct {
+    match_engine_t engines[2];          // El resultado se informa desde la perspectiva de engines[0]
+    const char *openings_path;          // Archivo EPD/FEN con aperturas (NULL = aperturas incluidas)
+    const char *pgn_path;               // Archivo donde se guardan las partidas (NULL = no se guardan)
+    int games;
+    int concurrency;                    // Partidas simultáneas (0 = todos los núcleos)
+    int64_t base_ms;                    // Tiempo inicial de cada reloj (0 = sin reloj)
+    int64_t increment_ms;
+    int max_plies;
+    // SPRT: H0 = la diferencia es elo0, H1 = la diferencia es elo1
+    double elo0, elo1;
+    double alpha, beta;
+} match_options_t;
+
+// Resultado acumulado desde la perspectiva de engines[0]
+typedef struct {
+    int wins;
+    int draws;
+    int losses;
+} match_score_t;
+
+void match_default_options(match_options_t *options);
+bool match_parse_engine(const char *spec, match_engine_t *engine);
+bool match_run(const match_options_t *options, match_score_t *score);
+// Estadísticas
+double match_elo(const match_score_t *score, double *margin);
+double match_los(const match_score_t *score);
+double match_sprt_llr(const match_score_t *score, double elo0, double elo1);
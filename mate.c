@@ -0,0 +1,408 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mate.h"
+#include "bot.h"
+#include "zobrist.h"
+#include "platform.h"
+
+#define DFPN_INFINITY (1U << 30)    // Proof o disproof number de una posición resuelta
+#define DFPN_BUCKET_SIZE 4
+
+// Proof y disproof numbers desde el punto de vista del que mueve: phi es el costo de probar que logra su objetivo
+// (el atacante dar mate, el defensor evitarlo) y delta el de probar que no lo logra. phi = 0: gana el que mueve;
+// delta = 0: pierde. Una posición que nadie consultó vale (1, 1).
+// Las repeticiones y el largo máximo de la línea dependen del camino por el que se llegó a la posición, no solo de
+// la posición: un fracaso del atacante que se apoya en ellos se marca, y en la raíz no alcanza para descartar el mate
+// (problema de la interacción con la historia, https://www.chessprogramming.org/Graph_History_Interaction).
+typedef struct {
+    uint32_t phi;
+    uint32_t delta;
+    uint16_t distance;              // Plies hasta el final de la línea (en posiciones resueltas)
+    bool path_dependent;            // El resultado se apoya en una repetición o en el largo máximo de la línea
+} dfpn_values_t;
+
+typedef struct {
+    uint64_t key;                   // 0 = entrada vacía
+    uint32_t phi;
+    uint32_t delta;
+    uint32_t work;                  // Nodos usados para llegar a este valor (se reemplazan primero las de menos trabajo)
+    uint16_t move;                  // Jugada que resuelve la posición (ver tt_pack_move)
+    uint8_t distance;               // Hasta MATE_MAX_PLY
+    bool path_dependent;
+} dfpn_entry_t;
+
+typedef struct {
+    const mate_options_t *options;
+    int attacker;
+    dfpn_entry_t *table;
+    size_t bucket_count;            // Potencia de 2
+    size_t used;
+    uint64_t nodes;
+    uint64_t node_limit;            // 0 = sin límite
+    int64_t deadline;               // 0 = sin límite
+    bool stopped;
+    uint64_t path[MATE_MAX_PLY + 1];        // Claves de las posiciones de la línea actual (para las repeticiones)
+    move_list_t *moves;                     // Una lista por ply
+    dfpn_values_t *children;                // Valores de las jugadas de cada ply (256 por ply)
+    move_t pv[MATE_MAX_PLY + 1][MATE_MAX_PLY];
+    int pv_length[MATE_MAX_PLY + 1];
+} mate_solver_t;
+
+void mate_default_options(mate_options_t *options) {
+    options->max_moves = MATE_DEFAULT_MAX_MOVES;
+    options->movetime_ms = 0;
+    options->nodes = 0;
+    options->hash_mb = MATE_DEFAULT_HASH_MB;
+    options->checks_only = true;
+    options->use_dfpn = true;
+}
+
+static bool solver_should_stop(mate_solver_t *s) {
+    if (s->stopped) return true;
+    if (s->node_limit && s->nodes >= s->node_limit) {
+        s->stopped = true;
+    } else if ((s->nodes & 1023) == 0 && s->deadline && platform_time_ms() >= s->deadline) {
+        s->stopped = true;
+    }
+    return s->stopped;
+}
+
+// La posición ya apareció en la línea actual (antes de 'ply')
+static bool on_path(const mate_solver_t *s, uint64_t key, int ply) {
+    for (int i = ply - 1; i >= 0; i--) {
+        if (s->path[i] == key) return true;
+    }
+    return false;
+}
+
+// Deja solo las jugadas que dan jaque
+static void keep_checks(gamestate_t *game, move_list_t *moves) {
+    int count = 0;
+    for (int i = 0; i < moves->count; i++) {
+        fast_undo_t undo;
+        prepare_fast_undo(game, &moves->moves[i], &undo);
+        make_move(&moves->moves[i], game, false);
+        bool check = is_in_check(game, game->to_move);
+        fast_unmake_move(game, &moves->moves[i], &undo);
+        if (check) moves->moves[count++] = moves->moves[i];
+    }
+    moves->count = count;
+}
+
+//// Tabla de df-pn
+
+static dfpn_entry_t* table_probe(mate_solver_t *s, uint64_t key) {
+    dfpn_entry_t *bucket = &s->table[(key & (s->bucket_count - 1)) * DFPN_BUCKET_SIZE];
+    for (int i = 0; i < DFPN_BUCKET_SIZE; i++) {
+        if (bucket[i].key == key) return &bucket[i];
+    }
+    return NULL;
+}
+
+static void table_store(mate_solver_t *s, uint64_t key, const dfpn_values_t *values, uint16_t move, uint64_t work) {
+    dfpn_entry_t *bucket = &s->table[(key & (s->bucket_count - 1)) * DFPN_BUCKET_SIZE];
+    dfpn_entry_t *entry = &bucket[0];
+    for (int i = 0; i < DFPN_BUCKET_SIZE; i++) {
+        if (bucket[i].key == key) {
+            entry = &bucket[i];
+            work += entry->work;
+            break;
+        }
+        if (bucket[i].work < entry->work) entry = &bucket[i];
+    }
+    if (entry->key == 0) s->used++;
+    entry->key = key;
+    entry->phi = values->phi;
+    entry->delta = values->delta;
+    entry->work = work < UINT32_MAX ? (uint32_t)work : UINT32_MAX;
+    entry->move = move;
+    entry->distance = (uint8_t)values->distance;
+    entry->path_dependent = values->path_dependent;
+}
+
+// Valores de la posición a la que lleva una jugada: repetición (fracasa el atacante), tabla o (1, 1)
+static void child_values(mate_solver_t *s, gamestate_t *game, int ply, move_t *move, dfpn_values_t *values) {
+    fast_undo_t undo;
+    prepare_fast_undo(game, move, &undo);
+    make_move(move, game, false);
+    const dfpn_entry_t *entry;
+    if (on_path(s, game->key, ply + 1)) {
+        bool attacker = game->to_move == s->attacker;
+        values->phi = attacker ? DFPN_INFINITY : 0;
+        values->delta = attacker ? 0 : DFPN_INFINITY;
+        values->distance = 0;
+        // La raíz está en todos los caminos de la búsqueda: volver a ella no depende del camino
+        values->path_dependent = game->key != s->path[0];
+    } else if ((entry = table_probe(s, game->key)) != NULL) {
+        values->phi = entry->phi;
+        values->delta = entry->delta;
+        values->distance = entry->distance;
+        values->path_dependent = entry->path_dependent;
+    } else {
+        values->phi = 1;
+        values->delta = 1;
+        values->distance = 0;
+        values->path_dependent = false;
+    }
+    fast_unmake_move(game, move, &undo);
+}
+
+/**
+ * Expande la posición hasta que su phi o su delta alcanzan el umbral (o se resuelve) y guarda el resultado en la tabla.
+ * Siempre sigue la jugada con menor delta (la que parece más fácil de ganar para el que mueve); su umbral de phi
+ * deja volver apenas la suma de las demás lo supera, y el de delta apenas pasa a la segunda mejor jugada.
+ */
+static void dfpn_mid(mate_solver_t *s, gamestate_t *game, int ply, uint32_t th_phi, uint32_t th_delta) {
+    s->nodes++;
+    if (solver_should_stop(s)) return;
+    uint64_t start_nodes = s->nodes;
+    s->path[ply] = game->key;
+    bool attacker = game->to_move == s->attacker;
+    move_list_t *moves = &s->moves[ply];
+    generate_legal_moves(game, moves);
+    if (attacker && s->options->checks_only) keep_checks(game, moves);
+
+    // Sin jugadas (o al llegar al largo máximo) el atacante fracasa, salvo que el defensor esté en jaque mate
+    if (moves->count == 0 || ply >= MATE_MAX_PLY - 1) {
+        bool lost = attacker || (moves->count == 0 && is_in_check(game, game->to_move));
+        dfpn_values_t values = {lost ? DFPN_INFINITY : 0, lost ? 0 : DFPN_INFINITY, 0, moves->count > 0};
+        table_store(s, game->key, &values, 0, 1);
+        return;
+    }
+
+    dfpn_values_t *children = &s->children[ply * 256];
+    for (;;) {
+        uint32_t phi = DFPN_INFINITY, delta2 = DFPN_INFINITY;
+        uint64_t delta = 0;
+        int best = 0, win = -1, slowest = 0;
+        // Ganar depende del camino si todas las jugadas ganadoras dependen; perder, si alguna de las jugadas depende
+        bool win_path_dependent = true, loss_path_dependent = false;
+        for (int i = 0; i < moves->count; i++) {
+            child_values(s, game, ply, &moves->moves[i], &children[i]);
+            if (children[i].delta < phi) {
+                delta2 = phi;
+                phi = children[i].delta;
+                best = i;
+            } else if (children[i].delta < delta2) {
+                delta2 = children[i].delta;
+            }
+            delta += children[i].phi;
+            // La jugada ganadora más rápida y, si todas pierden, la que más demora el final
+            if (children[i].delta == 0 && (win < 0 || children[i].distance < children[win].distance)) win = i;
+            if (children[i].distance > children[slowest].distance) slowest = i;
+            if (children[i].delta == 0 && !children[i].path_dependent) win_path_dependent = false;
+            if (children[i].path_dependent) loss_path_dependent = true;
+        }
+
+        dfpn_values_t values = {phi, delta < DFPN_INFINITY ? (uint32_t)delta : DFPN_INFINITY - 1, 0, false};
+        if (phi == 0) {
+            values.delta = DFPN_INFINITY;
+            values.distance = children[win].distance + 1;
+            values.path_dependent = win_path_dependent;
+            table_store(s, game->key, &values, tt_pack_move(&moves->moves[win]), s->nodes - start_nodes + 1);
+            return;
+        }
+        if (delta == 0) {
+            values.phi = DFPN_INFINITY;
+            values.distance = children[slowest].distance + 1;
+            values.path_dependent = loss_path_dependent;
+            table_store(s, game->key, &values, tt_pack_move(&moves->moves[slowest]), s->nodes - start_nodes + 1);
+            return;
+        }
+        if (values.phi >= th_phi || values.delta >= th_delta) {
+            table_store(s, game->key, &values, 0, s->nodes - start_nodes + 1);
+            return;
+        }
+
+        uint64_t child_th_phi = (uint64_t)th_delta + children[best].phi - values.delta;
+        uint64_t child_th_delta = (uint64_t)delta2 + 1 < th_phi ? (uint64_t)delta2 + 1 : th_phi;
+        fast_undo_t undo;
+        prepare_fast_undo(game, &moves->moves[best], &undo);
+        make_move(&moves->moves[best], game, false);
+        dfpn_mid(s, game, ply + 1, child_th_phi < DFPN_INFINITY ? (uint32_t)child_th_phi : DFPN_INFINITY,
+                 child_th_delta < DFPN_INFINITY ? (uint32_t)child_th_delta : DFPN_INFINITY);
+        fast_unmake_move(game, &moves->moves[best], &undo);
+        if (s->stopped) return;
+    }
+}
+
+// Línea de mate guardada en la tabla: el atacante sigue la jugada que gana más rápido y el defensor la que más resiste
+static int dfpn_pv(mate_solver_t *s, gamestate_t *game, move_t *pv) {
+    int length = 0;
+    while (length < MATE_MAX_PLY) {
+        const dfpn_entry_t *entry = table_probe(s, game->key);
+        bool attacker = game->to_move == s->attacker;
+        if (!entry || entry->distance == 0 || (attacker ? entry->phi : entry->delta) != 0) break;
+        move_list_t *moves = &s->moves[0];
+        generate_legal_moves(game, moves);
+        int found = -1;
+        for (int i = 0; i < moves->count && found < 0; i++) {
+            if (tt_move_matches(entry->move, &moves->moves[i])) found = i;
+        }
+        if (found < 0) break;
+        pv[length++] = moves->moves[found];
+        make_move(&moves->moves[found], game, false);
+    }
+    return length;
+}
+
+//// Mate en N
+
+// Jugadas del atacante: solo jaques si corresponde, primero las que le dejan menos respuestas al defensor
+static void order_attacker_moves(mate_solver_t *s, gamestate_t *game, int ply, move_list_t *moves, bool checks) {
+    if (checks) keep_checks(game, moves);
+    int replies[256];
+    move_list_t *scratch = &s->moves[ply + 1];
+    for (int i = 0; i < moves->count; i++) {
+        fast_undo_t undo;
+        prepare_fast_undo(game, &moves->moves[i], &undo);
+        make_move(&moves->moves[i], game, false);
+        generate_legal_moves(game, scratch);
+        replies[i] = scratch->count;
+        fast_unmake_move(game, &moves->moves[i], &undo);
+    }
+    for (int i = 1; i < moves->count; i++) {
+        move_t move = moves->moves[i];
+        int count = replies[i], j = i - 1;
+        while (j >= 0 && replies[j] > count) {
+            moves->moves[j + 1] = moves->moves[j];
+            replies[j + 1] = replies[j];
+            j--;
+        }
+        moves->moves[j + 1] = move;
+        replies[j + 1] = count;
+    }
+}
+
+/**
+ * Alfa-beta que solo distingue mates: un mate vale MATE_SCORE menos su distancia en plies a la raíz y todo lo
+ * demás vale 0. El atacante solo prueba jaques (siempre en su última jugada).
+ * @param depth: plies que quedan (2N - 1 en la raíz para un mate en N).
+ */
+static int mate_alpha_beta(mate_solver_t *s, gamestate_t *game, int ply, int depth, int alpha, int beta) {
+    s->pv_length[ply] = 0;
+    s->nodes++;
+    if (solver_should_stop(s)) return 0;
+    // Poda por distancia al mate: ni un mate en la jugada siguiente puede mejorar la ventana
+    if (alpha < -MATE_SCORE + ply) alpha = -MATE_SCORE + ply;
+    if (beta > MATE_SCORE - ply - 1) beta = MATE_SCORE - ply - 1;
+    if (alpha >= beta) return alpha;
+
+    move_list_t *moves = &s->moves[ply];
+    generate_legal_moves(game, moves);
+    if (moves->count == 0) return is_in_check(game, game->to_move) ? -MATE_SCORE + ply : 0;
+    if (depth <= 0 || ply >= MATE_MAX_PLY - 1) return 0;
+    s->path[ply] = game->key;
+    if (on_path(s, game->key, ply)) return 0;
+    if (game->to_move == s->attacker) order_attacker_moves(s, game, ply, moves, s->options->checks_only || depth == 1);
+
+    for (int i = 0; i < moves->count; i++) {
+        fast_undo_t undo;
+        prepare_fast_undo(game, &moves->moves[i], &undo);
+        make_move(&moves->moves[i], game, false);
+        int score = -mate_alpha_beta(s, game, ply + 1, depth - 1, -beta, -alpha);
+        fast_unmake_move(game, &moves->moves[i], &undo);
+        if (s->stopped) return 0;
+        if (score > alpha) {
+            alpha = score;
+            s->pv[ply][0] = moves->moves[i];
+            memcpy(&s->pv[ply][1], s->pv[ply + 1], s->pv_length[ply + 1] * sizeof(move_t));
+            s->pv_length[ply] = s->pv_length[ply + 1] + 1;
+            if (alpha >= beta) break;
+        }
+    }
+    return alpha;
+}
+
+/**
+ * Busca el mate más corto para el bando que mueve. Primero df-pn prueba o descarta el mate; después la búsqueda de
+ * mate en N recorre las profundidades menores para encontrar la línea más corta (sin df-pn, hasta options->max_moves).
+ * @param game: posición (no se modifica).
+ * @param result: recibe el resultado, la línea y las estadísticas.
+ * @return false si no hay memoria para la tabla o las listas de jugadas.
+ */
+bool mate_solve(const gamestate_t *game, const mate_options_t *options, mate_result_t *result) {
+    memset(result, 0, sizeof(mate_result_t));
+    int64_t start = platform_time_ms();
+    mate_solver_t *s = calloc(1, sizeof(mate_solver_t));
+    if (!s) return false;
+    s->options = options;
+    s->moves = malloc((MATE_MAX_PLY + 1) * sizeof(move_list_t));
+    s->children = malloc((size_t)MATE_MAX_PLY * 256 * sizeof(dfpn_values_t));
+    if (options->use_dfpn) {
+        size_t mb = options->hash_mb < 1 ? 1 : options->hash_mb > MATE_MAX_HASH_MB ? MATE_MAX_HASH_MB : options->hash_mb;
+        size_t bucket_bytes = DFPN_BUCKET_SIZE * sizeof(dfpn_entry_t);
+        s->bucket_count = 1;
+        while (s->bucket_count * 2 * bucket_bytes <= mb * 1024 * 1024) s->bucket_count *= 2;
+        s->table = calloc(s->bucket_count, bucket_bytes);
+    }
+    if (!s->moves || !s->children || (options->use_dfpn && !s->table)) {
+        free(s->moves);
+        free(s->children);
+        free(s->table);
+        free(s);
+        return false;
+    }
+
+    // Copia de la posición con las claves recalculadas (por si el tablero se armó sin make_move)
+    gamestate_t position = *game;
+    position.key = polyglot_hash_position(&position);
+    position.pawn_key = zobrist_pawn_key(&position);
+    position.material_key = compute_material_key(&position);
+    position.nnue.generation = 0;
+    s->attacker = position.to_move;
+    s->deadline = options->movetime_ms > 0 ? start + options->movetime_ms : 0;
+    s->node_limit = options->nodes;
+
+    int max_moves = options->max_moves;
+    if (options->use_dfpn) {
+        dfpn_mid(s, &position, 0, DFPN_INFINITY, DFPN_INFINITY);
+        result->dfpn_nodes = s->nodes;
+        result->dfpn_entries = s->used;
+        result->dfpn_capacity = s->bucket_count * DFPN_BUCKET_SIZE;
+        const dfpn_entry_t *root = table_probe(s, position.key);
+        if (root && root->phi == 0) {
+            result->status = MATE_FOUND;
+            result->mate_in = (root->distance + 1) / 2;
+            gamestate_t line = position;
+            result->pv_length = dfpn_pv(s, &line, result->pv);
+            max_moves = result->mate_in;
+        } else if (root && root->delta == 0 && !root->path_dependent) {
+            // Si el fracaso depende de una repetición o del largo máximo, lo verifica la búsqueda de mate en N
+            result->status = MATE_NONE;
+        }
+    }
+
+    // Mate en N para N = 1, 2, ...: el primero que se encuentra es el más corto. Si df-pn ya encontró un mate en N
+    // con su línea completa, alcanza con descartar los más cortos
+    if (result->status != MATE_NONE && !s->stopped) {
+        s->node_limit = options->nodes ? (options->nodes > s->nodes ? options->nodes - s->nodes : 1) : 0;
+        s->nodes = 0;
+        if (max_moves > (MATE_MAX_PLY + 1) / 2) max_moves = (MATE_MAX_PLY + 1) / 2;
+        for (int n = 1; n <= max_moves; n++) {
+            if (result->status == MATE_FOUND && n == result->mate_in && result->pv_length == 2 * n - 1) {
+                result->shortest = true;
+                break;
+            }
+            int score = mate_alpha_beta(s, &position, 0, 2 * n - 1, 0, MATE_SCORE);
+            if (s->stopped) break;
+            result->searched_moves = n;
+            if (score > 0) {
+                result->status = MATE_FOUND;
+                result->shortest = true;
+                result->mate_in = (MATE_SCORE - score + 1) / 2;
+                result->pv_length = s->pv_length[0];
+                memcpy(result->pv, s->pv[0], s->pv_length[0] * sizeof(move_t));
+                break;
+            }
+        }
+        result->search_nodes = s->nodes;
+    }
+
+    result->time_ms = platform_time_ms() - start;
+    free(s->moves);
+    free(s->children);
+    free(s->table);
+    free(s);
+    return true;
+}
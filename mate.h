@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "chess.h"
+
+// Solucionador de mates: encuentra el mate más corto para el bando que mueve (ej: para validar problemas).
+// Tiene dos búsquedas que solo consideran jaques del atacante (salvo con checks_only = false) y todas las
+// respuestas del defensor:
+// - Búsqueda de proof numbers en profundidad (df-pn): prueba o descarta el mate sin límite de profundidad,
+//   expandiendo siempre la rama más fácil de resolver. Los proof/disproof numbers de cada posición se guardan en
+//   una tabla propia de tamaño configurable. https://www.chessprogramming.org/Proof-Number_Search#DFPN
+//   La línea que encuentra no siempre es la más corta, pero da una cota.
+// - Mate en N por profundización iterativa (alfa-beta con puntajes de mate y poda por distancia al mate):
+//   la primera profundidad con mate da la línea más corta. https://www.chessprogramming.org/Mate_Search
+// Las repeticiones cuentan como fracaso del atacante y no se considera la regla de 50 movimientos. Si df-pn descarta
+// el mate solo por una repetición o por el largo máximo de la línea, igual se corre la búsqueda de mate en N.
+
+#define MATE_MAX_PLY 128            // Largo máximo de una línea (los mates más largos no se encuentran)
+#define MATE_DEFAULT_HASH_MB 64
+#define MATE_MAX_HASH_MB 4096
+#define MATE_DEFAULT_MAX_MOVES 20   // Jugadas del atacante que recorre la búsqueda de mate en N sin df-pn
+
+typedef struct {
+    int max_moves;                  // Mate en N más largo que se busca con alfa-beta (si df-pn no dio una cota)
+    int64_t movetime_ms;            // Tiempo máximo (0 = sin límite)
+    uint64_t nodes;                 // Nodos máximos entre las dos búsquedas (0 = sin límite)
+    size_t hash_mb;                 // Memoria de la tabla de df-pn
+    bool checks_only;               // false = el atacante también prueba jugadas sin jaque (mucho más lento)
+    bool use_dfpn;                  // false = solo la búsqueda de mate en N
+} mate_options_t;
+
+typedef enum {
+    MATE_UNKNOWN,                   // Se acabó el tiempo o los nodos sin resolver la posición
+    MATE_FOUND,
+    MATE_NONE                       // No hay mate (con las jugadas consideradas y dentro de MATE_MAX_PLY)
+} mate_status_t;
+
+typedef struct {
+    mate_status_t status;
+    bool shortest;                  // La búsqueda de mate en N confirmó que no hay un mate más corto
+    int mate_in;                    // Jugadas del atacante
+    int searched_moves;             // Mayor N para el que la búsqueda de mate en N terminó
+    move_t pv[MATE_MAX_PLY];
+    int pv_length;
+    uint64_t dfpn_nodes;
+    uint64_t search_nodes;
+    size_t dfpn_entries;            // Entradas ocupadas de la tabla de df-pn
+    size_t dfpn_capacity;
+    int64_t time_ms;
+} mate_result_t;
+
+void mate_default_options(mate_options_t *options);
+bool mate_solve(const gamestate_t *game, const mate_options_t *options, mate_result_t *result);
@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include "material.h"
+#include "eval.h"
+#include "kpk.h"
+
+// Valor de las piezas en peones para comparar el material de cada bando (no depende de los parámetros de la evaluación)
+#define MINOR_UNITS 3
+#define ROOK_UNITS 5
+#define QUEEN_UNITS 9
+
+static _Thread_local material_entry_t material_table[MATERIAL_HASH_ENTRIES];
+
+typedef struct {
+    int pawns, knights, bishops, rooks, queens;
+    int units;                      // Material sin peones, en peones
+} side_material_t;
+
+static void side_material(uint64_t key, int color, side_material_t *side) {
+    side->pawns = MATERIAL_COUNT(key, MAKE_PIECE(PAWN, color));
+    side->knights = MATERIAL_COUNT(key, MAKE_PIECE(KNIGHT, color));
+    side->bishops = MATERIAL_COUNT(key, MAKE_PIECE(BISHOP, color));
+    side->rooks = MATERIAL_COUNT(key, MAKE_PIECE(ROOK, color));
+    side->queens = MATERIAL_COUNT(key, MAKE_PIECE(QUEEN, color));
+    side->units = MINOR_UNITS * (side->knights + side->bishops) + ROOK_UNITS * side->rooks + QUEEN_UNITS * side->queens;
+}
+
+/**
+ * Clasifica una combinación de material.
+ * @param entry: recibe el evaluador especializado y los factores de escala (entry->key ya asignada).
+ */
+static void classify(material_entry_t *entry) {
+    side_material_t side[2];
+    side_material(entry->key, WHITE, &side[WHITE]);
+    side_material(entry->key, BLACK, &side[BLACK]);
+    entry->evaluator = ENDGAME_NONE;
+    entry->strong = WHITE;
+    for (int color = WHITE; color <= BLACK; color++) {
+        entry->scale_fn[color] = ENDGAME_SCALE_NONE;
+        entry->scale[color] = MATERIAL_SCALE_NORMAL;
+    }
+
+    // Sin peones y con a lo sumo una pieza menor por bando nadie puede dar mate
+    if (side[WHITE].pawns + side[BLACK].pawns == 0 && side[WHITE].units <= MINOR_UNITS &&
+        side[BLACK].units <= MINOR_UNITS) {
+        entry->evaluator = ENDGAME_DRAW;
+        return;
+    }
+
+    for (int color = WHITE; color <= BLACK; color++) {
+        const side_material_t *strong = &side[color];
+        const side_material_t *weak = &side[1 - color];
+        int minors = strong->knights + strong->bishops;
+
+        if (weak->pawns == 0 && weak->units == 0) {
+            entry->strong = (uint8_t)color;
+            if (strong->units == 0 && strong->pawns == 1) {
+                entry->evaluator = ENDGAME_KPK;
+                return;
+            }
+            if (strong->pawns == 0) {
+                if (strong->units == 2 * MINOR_UNITS && strong->knights == 2) {
+                    entry->evaluator = ENDGAME_DRAW;        // Dos caballos no fuerzan el mate
+                    return;
+                }
+                if (strong->units == 2 * MINOR_UNITS && strong->knights == 1) {
+                    entry->evaluator = ENDGAME_KBNK;
+                    return;
+                }
+            }
+            if (strong->queens + strong->rooks > 0 || (strong->pawns == 0 && minors >= 2)) {
+                entry->evaluator = ENDGAME_KXK;
+                return;
+            }
+        }
+
+        // Alfil y peones (o solo peones contra rey solo): tablas si todos están en una columna de torre y el alfil
+        // no controla la casilla de coronación (ver rook_pawns_scale)
+        if (strong->pawns > 0 && strong->knights + strong->rooks + strong->queens == 0 &&
+            (strong->bishops == 1 || (strong->bishops == 0 && weak->pawns == 0 && weak->units == 0))) {
+            entry->scale_fn[color] = ENDGAME_SCALE_ROOK_PAWNS;
+        }
+
+        // Sin peones hace falta al menos una torre más que el rival para ganar (ej: torre contra pieza menor
+        // suele ser tablas); con un solo peón y poca ventaja de piezas tampoco es fácil
+        if (strong->pawns == 0 && strong->units - weak->units <= MINOR_UNITS) {
+            entry->scale[color] = strong->units < ROOK_UNITS ? 0 : weak->units <= MINOR_UNITS ? 4 : 14;
+        } else if (strong->pawns == 1 && strong->units - weak->units <= MINOR_UNITS) {
+            entry->scale[color] = MATERIAL_SCALE_ONE_PAWN;
+        }
+    }
+    entry->strong = WHITE;
+}
+
+/**
+ * Busca la combinación de material de la posición en la tabla del hilo (y la clasifica si no está).
+ * @param game: posición con game->material_key actualizada.
+ */
+const material_entry_t* material_probe(const gamestate_t *game) {
+    material_entry_t *entry = &material_table[game->material_key & (MATERIAL_HASH_ENTRIES - 1)];
+    if (entry->key != game->material_key) {
+        entry->key = game->material_key;
+        classify(entry);
+    }
+    return entry;
+}
+
+static inline int distance(int a, int b) {
+    int files = abs(FILE(a) - FILE(b)), ranks = abs(RANK(a) - RANK(b));
+    return files > ranks ? files : ranks;
+}
+
+// Distancia de una casilla al centro del tablero en columnas más filas (0 en d4-e5, 6 en las esquinas)
+static inline int center_distance(int square) {
+    int file = FILE(square) < 4 ? 3 - FILE(square) : FILE(square) - 4;
+    int rank = RANK(square) < 4 ? 3 - RANK(square) : RANK(square) - 4;
+    return file + rank;
+}
+
+static inline bool light_square(int square) {
+    return (RANK(square) + FILE(square)) % 2 != 0;
+}
+
+// Material del bando fuerte sin el rey, con los valores de la evaluación
+static int strong_material(const gamestate_t *game, int strong) {
+    int total = 0;
+    for (int type = PAWN; type <= QUEEN; type++) {
+        total += MATERIAL_COUNT(game->material_key, MAKE_PIECE(type, strong)) * eval_params.piece_values[type];
+    }
+    return total;
+}
+
+// Lo que queda de una victoria conocida sin pasar la zona de los puntajes de mate
+static inline int known_win(int score) {
+    return score < 2 * EVAL_KNOWN_WIN ? score : 2 * EVAL_KNOWN_WIN - 1;
+}
+
+// Alfiles sin otras piezas (la clave de material no distingue colores): si todos van por casillas del mismo color
+// no se puede dar mate
+static bool same_colored_bishops(const gamestate_t *game, int strong) {
+    uint64_t key = game->material_key;
+    if (MATERIAL_COUNT(key, MAKE_PIECE(KNIGHT, strong)) + MATERIAL_COUNT(key, MAKE_PIECE(ROOK, strong)) +
+        MATERIAL_COUNT(key, MAKE_PIECE(QUEEN, strong)) > 0) {
+        return false;
+    }
+    bool colors[2] = {false, false};
+    for (int sq = 0; sq < BOARD_SIZE; sq = (sq + 9) & ~8) {
+        if (game->board[sq] == MAKE_PIECE(BISHOP, strong)) colors[light_square(sq)] = true;
+    }
+    return !(colors[0] && colors[1]);
+}
+
+// Rey solo contra material suficiente: cuanto más cerca del borde está el rey débil y más cerca los dos reyes,
+// mejor para el fuerte (la búsqueda encuentra el mate una vez que el rey está arrinconado)
+static int evaluate_kxk(const gamestate_t *game, int strong) {
+    if (same_colored_bishops(game, strong)) return 0;
+    int strong_king = game->king_square[strong], weak_king = game->king_square[1 - strong];
+    return known_win(EVAL_KNOWN_WIN + strong_material(game, strong) +
+                     EVAL_MOPUP_EDGE * center_distance(weak_king) +
+                     EVAL_MOPUP_CLOSE * (7 - distance(strong_king, weak_king)));
+}
+
+// Alfil y caballo: el mate solo se puede dar en una esquina del color del alfil, así que el rey débil se empuja
+// hacia la diagonal que une esas dos esquinas (a1-h8 para el alfil de casillas oscuras)
+static int evaluate_kbnk(const gamestate_t *game, int strong) {
+    int strong_king = game->king_square[strong], weak_king = game->king_square[1 - strong];
+    int bishop = -1;
+    for (int sq = 0; sq < BOARD_SIZE && bishop < 0; sq = (sq + 9) & ~8) {
+        if (game->board[sq] == MAKE_PIECE(BISHOP, strong)) bishop = sq;
+    }
+    int file = light_square(bishop) ? 7 - FILE(weak_king) : FILE(weak_king);
+    int corner = abs(7 - RANK(weak_king) - file);       // 7 en las esquinas buenas, 0 en la diagonal opuesta
+    return known_win(EVAL_KNOWN_WIN + strong_material(game, strong) + EVAL_MOPUP_CORNER * corner +
+                     EVAL_MOPUP_CLOSE * (7 - distance(strong_king, weak_king)));
+}
+
+// Rey y peón contra rey: resultado exacto del bitbase. Una posición ganada vale algo menos que una dama y más
+// cuanto más avanzado está el peón, así la búsqueda lo empuja y prefiere coronar
+static int evaluate_kpk(const gamestate_t *game, int strong) {
+    int pawn = kpk_find_pawn(game);
+    if (pawn < 0 || !kpk_probe(game, pawn)) return 0;
+    int rank = strong == WHITE ? RANK(pawn) : 7 - RANK(pawn);
+    return eval_params.piece_values[QUEEN] - EVAL_KPK_RANK_STEP * (7 - rank);
+}
+
+static int evaluate_draw(const gamestate_t *game, int strong) {
+    (void)game;
+    (void)strong;
+    return 0;
+}
+
+// Evaluadores por endgame_eval_t, desde la perspectiva del bando fuerte
+static int (*const evaluators[])(const gamestate_t *game, int strong) = {
+    [ENDGAME_DRAW] = evaluate_draw,
+    [ENDGAME_KXK] = evaluate_kxk,
+    [ENDGAME_KBNK] = evaluate_kbnk,
+    [ENDGAME_KPK] = evaluate_kpk,
+};
+
+/**
+ * Evalúa la posición con la función especializada de su material, si tiene.
+ * @param entry: clasificación del material (ver material_probe).
+ * @param score: recibe el puntaje desde la perspectiva de las blancas.
+ * @return false si la posición se evalúa con la evaluación general.
+ */
+bool material_evaluate(const material_entry_t *entry, const gamestate_t *game, int *score) {
+    if (entry->evaluator == ENDGAME_NONE) return false;
+    int strong_score = evaluators[entry->evaluator](game, entry->strong);
+    *score = entry->strong == WHITE ? strong_score : -strong_score;
+    return true;
+}
+
+// Peones en una sola columna de torre: si el rey débil llega a la casilla de coronación (y el alfil, si hay, es del
+// otro color) no hay forma de sacarlo. https://www.chessprogramming.org/Wrong_Color_Bishop
+static int rook_pawns_scale(const gamestate_t *game, int color) {
+    int pawn_file = -1, bishop = -1;
+    for (int sq = 0; sq < BOARD_SIZE; sq = (sq + 9) & ~8) {
+        int piece = game->board[sq];
+        if (piece == MAKE_PIECE(BISHOP, color)) {
+            bishop = sq;
+        } else if (piece == MAKE_PIECE(PAWN, color)) {
+            if (FILE(sq) != 0 && FILE(sq) != 7) return -1;
+            if (pawn_file >= 0 && FILE(sq) != pawn_file) return -1;
+            pawn_file = FILE(sq);
+        }
+    }
+    if (pawn_file < 0) return -1;
+    int queening = SQUARE(color == WHITE ? 7 : 0, pawn_file);
+    if (bishop >= 0 && light_square(bishop) == light_square(queening)) return -1;
+    return distance(game->king_square[1 - color], queening) <= 1 ? 0 : -1;
+}
+
+/**
+ * Factor de escala de la evaluación general cuando va ganando un bando.
+ * @param entry: clasificación del material (ver material_probe).
+ * @param color: bando que va ganando.
+ * @return factor sobre MATERIAL_SCALE_NORMAL.
+ */
+int material_scale(const material_entry_t *entry, const gamestate_t *game, int color) {
+    if (entry->scale_fn[color] == ENDGAME_SCALE_ROOK_PAWNS) {
+        int scale = rook_pawns_scale(game, color);
+        if (scale >= 0) return scale;
+    }
+    return entry->scale[color];
+}
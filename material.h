@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "chess.h"
+
+// Finales conocidos según el material (sin buscar): la clave de material (game->material_key, con la cantidad de
+// piezas de cada tipo y color) se clasifica una sola vez y el resultado queda en una tabla chica por hilo, así
+// cada evaluación lo obtiene con un acceso. https://www.chessprogramming.org/Material_Hash_Table
+// La clasificación elige una función de evaluación especializada que reemplaza a la general (tablas conocidas,
+// mates que se fuerzan con técnica, KPK con su bitbase) y, si no hay, un factor de escala para cada bando que
+// reduce la evaluación general del que va ganando cuando el material no alcanza para ganar.
+// https://www.chessprogramming.org/Endgame#Endgame_Knowledge
+
+#define MATERIAL_HASH_ENTRIES 1024      // Por hilo, potencia de 2 (pocas combinaciones de material por partida)
+#define MATERIAL_SCALE_NORMAL 64        // Factor de escala que deja la evaluación como está
+#define MATERIAL_SCALE_ONE_PAWN 48      // Un solo peón y poca ventaja de piezas: suele ser difícil de ganar
+
+// Evaluación especializada (ver material_evaluate)
+typedef enum {
+    ENDGAME_NONE,                   // Evaluación general
+    ENDGAME_DRAW,                   // Tablas conocidas (ej: pieza menor contra pieza menor)
+    ENDGAME_KXK,                    // Dama, torre o dos piezas menores contra rey solo: llevar el rey al borde
+    ENDGAME_KBNK,                   // Alfil y caballo contra rey solo: llevar el rey a una esquina del color del alfil
+    ENDGAME_KPK                     // Rey y peón contra rey (ver kpk.h)
+} endgame_eval_t;
+
+// Función de escala que depende de la posición (ver material_scale)
+typedef enum {
+    ENDGAME_SCALE_NONE,
+    ENDGAME_SCALE_ROOK_PAWNS        // Peones en una columna de torre (con alfil que no controla la casilla de coronación)
+} endgame_scale_t;
+
+typedef struct {
+    uint64_t key;                   // Clave de material (0 = entrada vacía, siempre hay dos reyes)
+    uint8_t evaluator;              // endgame_eval_t
+    uint8_t strong;                 // Bando que tiene la ventaja según el evaluador
+    uint8_t scale_fn[2];            // endgame_scale_t de cada bando
+    uint8_t scale[2];               // Factor de escala de cada bando, sobre MATERIAL_SCALE_NORMAL
+} material_entry_t;
+
+const material_entry_t* material_probe(const gamestate_t *game);
+bool material_evaluate(const material_entry_t *entry, const gamestate_t *game, int *score);
+int material_scale(const material_entry_t *entry, const gamestate_t *game, int color);
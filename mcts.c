@@ -0,0 +1,511 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mcts.h"
+
+#define MCTS_VALUE_ONE 65536u           // Valor de una victoria en la suma de resultados de un nodo (tablas = la mitad)
+#define MCTS_SCORE_SCALE 400.0          // Centipeones por cada factor 10 entre victorias y derrotas (como el Elo)
+
+// Estados de un nodo. Solo el hilo que pasa un nodo de MCTS_LEAF a MCTS_EXPANDING escribe sus hijos
+enum {
+    MCTS_LEAF,                      // Sin hijos todavía
+    MCTS_EXPANDING,                 // Otro hilo está creando los hijos (mientras tanto se trata como hoja)
+    MCTS_EXPANDED,
+    MCTS_TERMINAL                   // Mate o ahogado: el valor está en 'terminal'
+};
+
+typedef struct {
+    move_t move;                    // Jugada que lleva a este nodo desde su padre
+    uint32_t first_child;           // Índice del primer hijo en el pool (los hijos de un nodo son contiguos)
+    uint16_t child_count;
+    uint16_t terminal;              // Valor de la posición terminal para el bando que mueve (0 = mate, la mitad = ahogado)
+    atomic_uchar state;
+    atomic_uint visits;
+    atomic_uint virtual_loss;       // Simulaciones en curso que pasan por este nodo
+    atomic_uint_least64_t value;    // Suma de resultados desde la perspectiva del bando que jugó 'move'
+} mcts_node_t;
+
+// Árbol compartido por todos los hilos. El nodo 0 es la raíz
+typedef struct {
+    mcts_node_t *nodes;
+    uint32_t capacity;
+    atomic_uint used;
+    atomic_bool full;               // El pool se llenó: no se expande más
+    atomic_bool stop;               // Señal del hilo principal para los demás (y para sus búsquedas en las hojas)
+    atomic_uint_fast64_t playouts;
+    atomic_uint_fast64_t nodes_searched;    // Nodos de alfa-beta de todos los hilos (ver search_should_stop)
+    double exploration;
+    int leaf_depth;
+    int rollout_plies;
+} mcts_tree_t;
+
+// Estado de un hilo: su copia del tablero y un contexto de búsqueda propio para estimar las hojas
+typedef struct {
+    mcts_tree_t *tree;
+    search_context_t ctx;
+    gamestate_t game;               // Posición de la raíz (se restaura al terminar cada simulación)
+    gamestate_t rollout;
+    uint64_t *keys;                 // Claves anteriores a la raíz seguidas de las del camino (para las repeticiones)
+    int history_count;
+    mcts_node_t *path[MCTS_MAX_DEPTH + 1];
+    move_t path_moves[MCTS_MAX_DEPTH];
+    fast_undo_t undo[MCTS_MAX_DEPTH];
+    move_list_t moves;
+    uint64_t rng;
+    uint64_t playouts;
+    pthread_t thread;
+} mcts_worker_t;
+
+// Generador xorshift64* (cada hilo tiene el suyo, para los rollouts)
+static uint64_t mcts_random(mcts_worker_t *worker) {
+    worker->rng ^= worker->rng >> 12;
+    worker->rng ^= worker->rng << 25;
+    worker->rng ^= worker->rng >> 27;
+    return worker->rng * 0x2545F4914F6CDD1DULL;
+}
+
+// Probabilidad de ganar (sobre MCTS_VALUE_ONE) para un puntaje en centipeones, con la misma curva que el Elo
+static uint32_t mcts_score_to_value(int score) {
+    double p = 1.0 / (1.0 + pow(10.0, -score / MCTS_SCORE_SCALE));
+    return (uint32_t)(p * MCTS_VALUE_ONE + 0.5);
+}
+
+static int mcts_value_to_score(double p) {
+    if (p < 0.001) p = 0.001;
+    if (p > 0.999) p = 0.999;
+    return (int)lround(-MCTS_SCORE_SCALE * log10(1.0 / p - 1.0));
+}
+
+/**
+ * Reserva nodos contiguos del pool (sin locks: un solo fetch_add).
+ * @return índice del primero, o UINT32_MAX si el pool se llenó.
+ */
+static uint32_t mcts_alloc(mcts_tree_t *tree, int count) {
+    uint32_t first = atomic_fetch_add(&tree->used, (unsigned)count);
+    if (first > tree->capacity - (uint32_t)count) {
+        atomic_store(&tree->full, true);
+        return UINT32_MAX;
+    }
+    return first;
+}
+
+static void mcts_node_init(mcts_node_t *node, const move_t *move) {
+    if (move) node->move = *move;
+    else memset(&node->move, 0, sizeof(move_t));
+    node->first_child = 0;
+    node->child_count = 0;
+    node->terminal = 0;
+    atomic_init(&node->state, MCTS_LEAF);
+    atomic_init(&node->visits, 0);
+    atomic_init(&node->virtual_loss, 0);
+    atomic_init(&node->value, 0);
+}
+
+/**
+ * Crea los hijos de una hoja (o la marca como terminal si no hay jugadas legales). Si otro hilo ya la está
+ * expandiendo, o el pool está lleno, no hace nada.
+ * @param game: posición del nodo.
+ */
+static void mcts_expand(mcts_worker_t *worker, mcts_node_t *node, gamestate_t *game) {
+    mcts_tree_t *tree = worker->tree;
+    unsigned char expected = MCTS_LEAF;
+    if (atomic_load_explicit(&tree->full, memory_order_relaxed) ||
+        !atomic_compare_exchange_strong(&node->state, &expected, MCTS_EXPANDING)) {
+        return;
+    }
+
+    move_list_t *moves = &worker->moves;
+    generate_moves(game, moves);
+    filter_legal_moves(game, moves);
+    if (moves->count == 0) {
+        node->terminal = is_in_check(game, game->to_move) ? 0 : MCTS_VALUE_ONE / 2;
+        atomic_store_explicit(&node->state, MCTS_TERMINAL, memory_order_release);
+        return;
+    }
+
+    uint32_t first = mcts_alloc(tree, moves->count);
+    if (first == UINT32_MAX) {
+        atomic_store_explicit(&node->state, MCTS_LEAF, memory_order_release);
+        return;
+    }
+    // Entre hijos sin visitar se elige el primero, así que se ordenan como en alfa-beta (capturas primero)
+    sort_moves(game, moves);
+    for (int i = 0; i < moves->count; i++) {
+        mcts_node_init(&tree->nodes[first + i], &moves->moves[i]);
+    }
+    node->first_child = first;
+    node->child_count = (uint16_t)moves->count;
+    atomic_store_explicit(&node->state, MCTS_EXPANDED, memory_order_release);
+}
+
+/**
+ * Elige el hijo con mayor UCT: valor promedio + exploration * sqrt(ln(N) / n). Las simulaciones en curso cuentan
+ * como visitas sin resultado (pérdida virtual). Un hijo sin visitas se trata como si tuviera una con el valor
+ * promedio del padre (first play urgency): así, si la jugada ya visitada responde bien se sigue con ella antes de
+ * probar todas las demás, que se prueban cuando las visitadas rinden menos de lo esperado.
+ * @param node: nodo expandido.
+ */
+static mcts_node_t* mcts_select(const mcts_tree_t *tree, mcts_node_t *node) {
+    mcts_node_t *children = &tree->nodes[node->first_child];
+    unsigned node_visits = atomic_load_explicit(&node->visits, memory_order_relaxed);
+    double log_parent = log(node_visits + atomic_load_explicit(&node->virtual_loss, memory_order_relaxed) + 1.0);
+    // El valor del padre es desde la perspectiva del rival del bando que elige
+    double urgency = node_visits == 0 ? 1.0 :
+                     1.0 - (double)atomic_load_explicit(&node->value, memory_order_relaxed) / MCTS_VALUE_ONE / node_visits;
+    urgency += tree->exploration * sqrt(log_parent);
+    mcts_node_t *best = NULL;
+    double best_uct = -1.0;
+
+    for (int i = 0; i < node->child_count; i++) {
+        mcts_node_t *child = &children[i];
+        unsigned visits = atomic_load_explicit(&child->visits, memory_order_relaxed) +
+                          atomic_load_explicit(&child->virtual_loss, memory_order_relaxed);
+        double uct = urgency;
+        if (visits > 0) {
+            double mean = (double)atomic_load_explicit(&child->value, memory_order_relaxed) / MCTS_VALUE_ONE / visits;
+            uct = mean + tree->exploration * sqrt(log_parent / visits);
+        }
+        // A igual urgencia gana el primero (los hijos están ordenados)
+        if (uct > best_uct) {
+            best_uct = uct;
+            best = child;
+        }
+    }
+    return best;
+}
+
+// Tablas por regla de 50 movimientos, material insuficiente o repetición (con las claves de la partida y del camino)
+static bool mcts_is_draw(const mcts_worker_t *worker, gamestate_t *game, int depth) {
+    if (game->halfmove_clock >= 100 || is_insufficient_material(game)) return true;
+    int index = worker->history_count + depth;
+    for (int back = 2; back <= game->halfmove_clock && back <= index; back += 2) {
+        if (worker->keys[index - back] == game->key) return true;
+    }
+    return false;
+}
+
+/**
+ * Valor de una posición con la búsqueda corta de las hojas.
+ * @param history_count: claves de worker->keys anteriores a la posición.
+ * @param value: recibe el valor para el bando que mueve (sobre MCTS_VALUE_ONE).
+ * @return false si la búsqueda se detuvo antes de terminar.
+ */
+static bool mcts_search_value(mcts_worker_t *worker, gamestate_t *game, int history_count, uint32_t *value) {
+    search_context_t *ctx = &worker->ctx;
+    ctx->history_keys = worker->keys;
+    ctx->history_count = history_count;
+    int score = alpha_beta(ctx, game, worker->tree->leaf_depth, -INFINITE_SCORE, INFINITE_SCORE, 0);
+    if (ctx->stopped) return false;
+    *value = mcts_score_to_value(score);
+    return true;
+}
+
+/**
+ * Estima el valor de una hoja: juega rollout_plies jugadas al azar (si la partida no termina antes) y evalúa la
+ * posición a la que llega.
+ * @param depth: profundidad de la hoja en el árbol.
+ * @param value: recibe el valor para el bando que mueve en la hoja.
+ */
+static bool mcts_estimate(mcts_worker_t *worker, gamestate_t *game, int depth, uint32_t *value) {
+    int plies = worker->tree->rollout_plies;
+    if (plies == 0) return mcts_search_value(worker, game, worker->history_count + depth, value);
+
+    // El rollout no guarda las claves: las repeticiones se detectan solo hasta la hoja
+    gamestate_t *rollout = &worker->rollout;
+    *rollout = *game;
+    uint32_t result = MCTS_VALUE_ONE / 2;
+    int ply = 0;
+    for (; ply < plies; ply++) {
+        if (rollout->halfmove_clock >= 100 || is_insufficient_material(rollout)) break;
+        move_list_t *moves = &worker->moves;
+        generate_moves(rollout, moves);
+        filter_legal_moves(rollout, moves);
+        if (moves->count == 0) {
+            if (is_in_check(rollout, rollout->to_move)) result = 0;
+            break;
+        }
+        make_move(&moves->moves[mcts_random(worker) % (uint64_t)moves->count], rollout, false);
+    }
+    if (ply == plies && !mcts_search_value(worker, rollout, 0, &result)) return false;
+    // El resultado es para el bando que mueve al final del rollout
+    *value = ply % 2 == 0 ? result : MCTS_VALUE_ONE - result;
+    return true;
+}
+
+/**
+ * Una simulación: selección con UCT hasta una hoja, expansión, estimación y propagación del resultado.
+ * @return false si se detuvo antes de terminar (el resultado no se suma).
+ */
+static bool mcts_playout(mcts_worker_t *worker) {
+    mcts_tree_t *tree = worker->tree;
+    gamestate_t *game = &worker->game;
+    mcts_node_t *node = &tree->nodes[0];
+    int depth = 0;
+    worker->path[0] = node;
+
+    while (depth < MCTS_MAX_DEPTH && atomic_load_explicit(&node->state, memory_order_acquire) == MCTS_EXPANDED) {
+        node = mcts_select(tree, node);
+        atomic_fetch_add_explicit(&node->virtual_loss, 1, memory_order_relaxed);
+        worker->path_moves[depth] = node->move;
+        prepare_fast_undo(game, &worker->path_moves[depth], &worker->undo[depth]);
+        make_move(&worker->path_moves[depth], game, false);
+        worker->path[++depth] = node;
+        worker->keys[worker->history_count + depth] = game->key;
+    }
+
+    // Valor de la hoja para el bando que mueve en ella
+    uint32_t value = MCTS_VALUE_ONE / 2;
+    bool finished = true;
+    int state = atomic_load_explicit(&node->state, memory_order_acquire);
+    if (state != MCTS_TERMINAL && !(depth > 0 && mcts_is_draw(worker, game, depth))) {
+        // Una hoja se expande en su segunda visita: muchas se visitan una sola vez y no vale la pena crear sus hijos
+        if (state == MCTS_LEAF && depth < MCTS_MAX_DEPTH &&
+            (depth == 0 || atomic_load_explicit(&node->visits, memory_order_relaxed) > 0)) {
+            mcts_expand(worker, node, game);
+            state = atomic_load_explicit(&node->state, memory_order_acquire);
+        }
+        if (state != MCTS_TERMINAL) finished = mcts_estimate(worker, game, depth, &value);
+    }
+    if (state == MCTS_TERMINAL) value = node->terminal;
+
+    for (int i = depth - 1; i >= 0; i--) {
+        fast_unmake_move(game, &worker->path_moves[i], &worker->undo[i]);
+    }
+
+    // Cada nodo guarda el resultado desde la perspectiva del bando que jugó su jugada, que alterna en cada ply
+    // (la raíz también, para la urgencia de sus hijos sin visitas)
+    uint32_t reward = MCTS_VALUE_ONE - value;
+    for (int i = depth; i >= 0; i--) {
+        mcts_node_t *step = worker->path[i];
+        if (finished) {
+            atomic_fetch_add_explicit(&step->value, reward, memory_order_relaxed);
+            atomic_fetch_add_explicit(&step->visits, 1, memory_order_relaxed);
+        }
+        if (i > 0) atomic_fetch_sub_explicit(&step->virtual_loss, 1, memory_order_relaxed);
+        reward = MCTS_VALUE_ONE - reward;
+    }
+    if (!finished) return false;
+    atomic_fetch_add_explicit(&tree->playouts, 1, memory_order_relaxed);
+    worker->playouts++;
+    return true;
+}
+
+// Hijo más visitado (a igual cantidad de visitas, el de mejor valor). NULL si no hay hijos visitados
+static mcts_node_t* mcts_most_visited(const mcts_tree_t *tree, mcts_node_t *node) {
+    if (atomic_load_explicit(&node->state, memory_order_acquire) != MCTS_EXPANDED) return NULL;
+    mcts_node_t *best = NULL;
+    unsigned best_visits = 0;
+    uint64_t best_value = 0;
+    for (int i = 0; i < node->child_count; i++) {
+        mcts_node_t *child = &tree->nodes[node->first_child + i];
+        unsigned visits = atomic_load_explicit(&child->visits, memory_order_relaxed);
+        uint64_t value = atomic_load_explicit(&child->value, memory_order_relaxed);
+        if (visits > best_visits || (visits == best_visits && visits > 0 && value > best_value)) {
+            best = child;
+            best_visits = visits;
+            best_value = value;
+        }
+    }
+    return best;
+}
+
+/**
+ * Completa el resultado con el estado actual del árbol: la jugada más visitada, su valor como puntaje y la variante
+ * que siguen las jugadas más visitadas (su largo se informa como profundidad).
+ */
+static void mcts_fill_result(const mcts_tree_t *tree, const search_context_t *ctx, search_result_t *result) {
+    mcts_node_t *node = &tree->nodes[0];
+    mcts_node_t *best = mcts_most_visited(tree, node);
+    if (best) {
+        unsigned visits = atomic_load_explicit(&best->visits, memory_order_relaxed);
+        double mean = (double)atomic_load_explicit(&best->value, memory_order_relaxed) / MCTS_VALUE_ONE / visits;
+        result->best_move = best->move;
+        result->score = mcts_value_to_score(mean);
+        // Mate en una: el único resultado exacto del árbol
+        if (atomic_load_explicit(&best->state, memory_order_acquire) == MCTS_TERMINAL && best->terminal == 0) {
+            result->score = MATE_SCORE - 1;
+        }
+        result->pv_length = 0;
+        for (mcts_node_t *step = best; step && result->pv_length < MAX_PLY; step = mcts_most_visited(tree, step)) {
+            result->pv[result->pv_length++] = step->move;
+        }
+        result->depth = result->pv_length;
+    }
+    result->nodes = atomic_load(&tree->nodes_searched);
+    result->playouts = atomic_load(&tree->playouts);
+    result->time_ms = platform_time_ms() - ctx->start_time;
+}
+
+static bool mcts_worker_init(mcts_worker_t *worker, mcts_tree_t *tree, search_context_t *ctx,
+                             const gamestate_t *game, int id) {
+    search_limits_t no_limits = {0};
+    worker->tree = tree;
+    // Las búsquedas de las hojas se cortan con los mismos límites que la búsqueda completa (el tiempo límite se lee
+    // del contexto principal, que puede fijarse después con search_set_deadline). La señal externa la revisa el
+    // hilo principal; los demás se detienen con la del árbol, que levanta el primero que ve un límite
+    search_init(&worker->ctx, &no_limits, id == 0 ? ctx->stop : &tree->stop);
+    worker->ctx.shared_deadline = &ctx->deadline;
+    worker->ctx.params = ctx->params;
+    worker->ctx.params.use_mcts = false;
+    worker->ctx.tt = ctx->tt;
+    worker->ctx.eval_cache = ctx->eval_cache;
+    worker->ctx.shared_nodes = &tree->nodes_searched;
+    worker->ctx.thread_id = id;
+    // El pool de la sesión no se comparte entre hilos: solo lo usa el hilo principal
+    arena_init(&worker->ctx.arena, id == 0 ? ctx->pool : NULL);
+    worker->game = *game;
+    worker->history_count = ctx->history_count;
+    worker->keys = malloc((ctx->history_count + MCTS_MAX_DEPTH + 1) * sizeof(uint64_t));
+    if (!worker->keys) return false;
+    if (ctx->history_count > 0) memcpy(worker->keys, ctx->history_keys, ctx->history_count * sizeof(uint64_t));
+    worker->keys[ctx->history_count] = game->key;
+    worker->rng = 0x9E3779B97F4A7C15ULL * (uint64_t)(id + 1);
+    worker->playouts = 0;
+    return true;
+}
+
+static void mcts_worker_finish(mcts_worker_t *worker) {
+    atomic_fetch_add(worker->ctx.shared_nodes, worker->ctx.nodes & 1023);
+    arena_free(&worker->ctx.arena);
+}
+
+static void* mcts_helper_main(void *arg) {
+    mcts_worker_t *worker = arg;
+    while (!atomic_load_explicit(&worker->tree->stop, memory_order_relaxed)) {
+        if (!mcts_playout(worker) && worker->ctx.stopped) atomic_store(&worker->tree->stop, true);
+    }
+    mcts_worker_finish(worker);
+    return NULL;
+}
+
+/**
+ * Búsqueda MCTS con varios hilos sobre un árbol compartido (ver mcts.h). La usan search_run y search_run_threads
+ * cuando ctx->params.use_mcts está activo.
+ * @param ctx: contexto del hilo principal (límites, señal de stop, tabla, caché, historia y on_iteration).
+ * @param game: posición a analizar (se restaura al terminar).
+ * @param threads: cantidad total de hilos (hasta SEARCH_MAX_THREADS).
+ * @param result: jugada más visitada, puntaje, variante y simulaciones de cada hilo (nodes son los de alfa-beta).
+ * @return false si la posición no tiene movimientos legales.
+ */
+bool mcts_run(search_context_t *ctx, gamestate_t *game, int threads, search_result_t *result) {
+    memset(result, 0, sizeof(search_result_t));
+    ctx->start_time = platform_time_ms();
+    if (ctx->limits.movetime_ms > 0) search_set_deadline(ctx, ctx->limits.movetime_ms);
+    if (threads < 1) threads = 1;
+    if (threads > SEARCH_MAX_THREADS) threads = SEARCH_MAX_THREADS;
+    tt_new_search(ctx->tt);
+
+    // Por si el tablero se modificó directamente (sin make_move): el acumulador de la red se recalcula al evaluar
+    game->key = polyglot_hash_position(game);
+    game->pawn_key = zobrist_pawn_key(game);
+    game->material_key = compute_material_key(game);
+    game->nnue.generation = 0;
+
+    move_list_t moves;
+    generate_moves(game, &moves);
+    filter_legal_moves(game, &moves);
+    if (moves.count == 0) return false;
+
+    mcts_tree_t *tree = malloc(sizeof(mcts_tree_t));
+    mcts_worker_t *workers = malloc(threads * sizeof(mcts_worker_t));
+    size_t capacity = (size_t)MCTS_POOL_MB * 1024 * 1024 / sizeof(mcts_node_t);
+    mcts_node_t *nodes = malloc(capacity * sizeof(mcts_node_t));
+    int started = 0;
+    bool ready = tree && workers && nodes;
+    for (int i = 0; i < threads && ready; i++) {
+        ready = mcts_worker_init(&workers[i], tree, ctx, game, i);
+        if (ready) started++;
+    }
+    if (!ready) {
+        // Sin memoria para el árbol se busca con alfa-beta
+        for (int i = 0; i < started; i++) {
+            free(workers[i].keys);
+        }
+        free(tree);
+        free(workers);
+        free(nodes);
+        ctx->params.use_mcts = false;
+        bool found = search_run_threads(ctx, game, threads, result);
+        ctx->params.use_mcts = true;
+        return found;
+    }
+
+    tree->nodes = nodes;
+    tree->capacity = (uint32_t)capacity;
+    atomic_init(&tree->used, 1);
+    atomic_init(&tree->full, false);
+    atomic_init(&tree->stop, false);
+    atomic_init(&tree->playouts, 0);
+    atomic_init(&tree->nodes_searched, 0);
+    tree->exploration = ctx->params.mcts_exploration / 100.0;
+    tree->leaf_depth = ctx->params.mcts_leaf_depth < 0 ? 0 :
+                       ctx->params.mcts_leaf_depth > MAX_PLY - 2 ? MAX_PLY - 2 : ctx->params.mcts_leaf_depth;
+    tree->rollout_plies = ctx->params.mcts_rollout_plies < 0 ? 0 :
+                          ctx->params.mcts_rollout_plies > MCTS_MAX_ROLLOUT_PLIES ? MCTS_MAX_ROLLOUT_PLIES :
+                          ctx->params.mcts_rollout_plies;
+    mcts_node_init(&nodes[0], NULL);
+
+    // Sin tiempo ni simulaciones como límite, la profundidad da la cantidad de simulaciones. Sin ningún límite la
+    // búsqueda sigue hasta la señal de stop (ej: "go infinite" o pondering), si hay una
+    uint64_t max_playouts = ctx->limits.nodes;
+    if (!max_playouts && ctx->limits.movetime_ms <= 0 && atomic_load(&ctx->deadline) == 0 &&
+        (ctx->limits.depth > 0 || !ctx->stop)) {
+        int depth = ctx->limits.depth > 0 ? ctx->limits.depth : MAX_PLY - 1;
+        max_playouts = (uint64_t)MCTS_PLAYOUTS_PER_DEPTH * depth;
+    }
+
+    sort_moves(game, &moves);
+    result->best_move = moves.moves[0];
+    mcts_expand(&workers[0], &nodes[0], &workers[0].game);
+
+    // Si no se puede crear un hilo, se busca con los que ya están
+    int helpers = 0;
+    while (helpers < threads - 1 &&
+           pthread_create(&workers[helpers + 1].thread, NULL, mcts_helper_main, &workers[helpers + 1]) == 0) {
+        helpers++;
+    }
+
+    // El hilo principal también simula, y entre simulaciones revisa los límites
+    int64_t next_report = ctx->start_time + MCTS_REPORT_MS;
+    while (true) {
+        // Una simulación sin terminar significa que su búsqueda llegó al tiempo límite o recibió la señal de stop
+        if (!mcts_playout(&workers[0]) && workers[0].ctx.stopped) break;
+        if (atomic_load_explicit(&tree->stop, memory_order_relaxed)) break;
+        if (max_playouts && atomic_load_explicit(&tree->playouts, memory_order_relaxed) >= max_playouts) break;
+        if (ctx->stop && atomic_load(ctx->stop)) break;
+        int64_t now = platform_time_ms();
+        int64_t deadline = atomic_load_explicit(&ctx->deadline, memory_order_relaxed);
+        if (deadline && now >= deadline) break;
+        if (ctx->on_iteration && now >= next_report) {
+            mcts_fill_result(tree, ctx, result);
+            ctx->on_iteration(result, ctx->callback_user);
+            next_report = now + MCTS_REPORT_MS;
+        }
+    }
+
+    atomic_store(&tree->stop, true);
+    for (int i = 1; i <= helpers; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    mcts_worker_finish(&workers[0]);
+
+    mcts_fill_result(tree, ctx, result);
+    result->threads = helpers + 1;
+    for (int i = 0; i <= helpers; i++) {
+        result->thread_playouts[i] = workers[i].playouts;
+        result->eval_cache_probes += workers[i].ctx.eval_cache_probes;
+        result->eval_cache_hits += workers[i].ctx.eval_cache_hits;
+    }
+    uint32_t used = atomic_load(&tree->used);
+    result->memory_peak = (used < tree->capacity ? used : tree->capacity) * sizeof(mcts_node_t);
+    // Como en alfa-beta, sin ninguna simulación terminada no hay información que reportar
+    if (ctx->on_iteration && result->playouts > 0) ctx->on_iteration(result, ctx->callback_user);
+
+    for (int i = 0; i < started; i++) {
+        free(workers[i].keys);
+    }
+    free(workers);
+    free(nodes);
+    free(tree);
+    return true;
+}
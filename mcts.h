@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "bot.h"
+
+// Búsqueda de árbol Monte Carlo (MCTS): otra forma de elegir la jugada, con un estilo de juego distinto al de
+// alfa-beta (más "humano": prefiere las jugadas que funcionan en muchas variantes y no solo en la mejor).
+// Cada simulación (playout) baja desde la raíz eligiendo en cada nodo el hijo con mejor UCT (valor promedio más
+// un bono para los hijos poco visitados), expande la hoja con generate_moves, estima su valor y suma el resultado
+// a todos los nodos del camino. La jugada elegida es la más visitada de la raíz.
+// https://www.chessprogramming.org/Monte-Carlo_Tree_Search
+// El valor de una hoja sale de una búsqueda alfa-beta corta (o de la evaluación estática con profundidad 0),
+// opcionalmente después de algunas jugadas al azar (rollout), y se pasa a probabilidad de ganar con una logística.
+// Todos los hilos comparten el mismo árbol sin locks: los nodos salen de un pool con reserva atómica, la expansión
+// la hace el hilo que gana un compare-and-swap, y la pérdida virtual (cada nodo del camino de una simulación en
+// curso cuenta como una derrota más) reparte a los hilos entre variantes distintas.
+// Se usa con search_params_t.use_mcts (search_run y search_run_threads la llaman en vez de alfa-beta) y respeta los
+// mismos límites: movetime/search_set_deadline y la señal de stop. limits.nodes cuenta simulaciones, y sin límite
+// de tiempo ni de simulaciones, limits.depth da MCTS_PLAYOUTS_PER_DEPTH simulaciones por cada ply.
+
+#define MCTS_POOL_MB 64                 // Memoria del árbol (al llenarse las hojas se siguen simulando sin expandir)
+#define MCTS_MAX_DEPTH 128              // Profundidad máxima del árbol (en plies)
+#define MCTS_MAX_ROLLOUT_PLIES 256
+#define MCTS_DEFAULT_EXPLORATION 10     // Constante de exploración de UCT, en centésimas (los valores van de 0 a 1)
+#define MCTS_DEFAULT_LEAF_DEPTH 2
+#define MCTS_PLAYOUTS_PER_DEPTH 1000
+#define MCTS_REPORT_MS 1000             // Cada cuánto se llama a on_iteration durante la búsqueda
+
+bool mcts_run(search_context_t *ctx, gamestate_t *game, int threads, search_result_t *result);
@@ -0,0 +1,309 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nnue.h"
+#include "chess.h"
+
+// AVX2 si el compilador lo permite; si no, SSE2 (siempre disponible en x86-64), con SSSE3 para la capa 1 si está
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NNUE_SSE2
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define NNUE_SSSE3
+#endif
+#endif
+
+int nnue_generation = 0;
+static int last_generation = 0;
+static nnue_network_t *network = NULL;
+
+// Tamaño del archivo de pesos: encabezado + capas
+#define NNUE_HEADER_SIZE 16
+#define NNUE_FILE_SIZE (NNUE_HEADER_SIZE + 2 * NNUE_HIDDEN + 2 * NNUE_INPUTS * NNUE_HIDDEN + 4 * NNUE_L1 \
+                        + NNUE_L1 * 2 * NNUE_HIDDEN + 4 + NNUE_L1)
+
+// Lectura y escritura de enteros little-endian (el archivo es el mismo en cualquier arquitectura)
+static uint32_t read_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int16_t read_i16(const unsigned char *p) {
+    return (int16_t)(uint16_t)(p[0] | p[1] << 8);
+}
+
+static void write_u32(FILE *file, uint32_t value) {
+    unsigned char bytes[4] = {value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24};
+    fwrite(bytes, 1, 4, file);
+}
+
+static void write_i16(FILE *file, int16_t value) {
+    unsigned char bytes[2] = {(uint16_t)value & 0xFF, (uint16_t)value >> 8};
+    fwrite(bytes, 1, 2, file);
+}
+
+/**
+ * Carga una red desde un archivo (ver el formato en nnue.h) y la deja como la red activa.
+ * Todos los acumuladores existentes quedan inválidos y se recalculan en su siguiente evaluación.
+ * No se debe llamar mientras hay búsquedas en curso.
+ * @param path: ruta del archivo de pesos.
+ * @return false si el archivo no existe o no tiene el formato esperado (la red anterior se mantiene).
+ */
+bool nnue_load(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+    unsigned char *data = malloc(NNUE_FILE_SIZE + 1);
+    nnue_network_t *loaded = malloc(sizeof(nnue_network_t));
+    // Se pide un byte más para detectar archivos más largos de lo esperado
+    size_t size = data ? fread(data, 1, NNUE_FILE_SIZE + 1, file) : 0;
+    fclose(file);
+    if (!data || !loaded || size != NNUE_FILE_SIZE || memcmp(data, "FNUE", 4) != 0 ||
+        read_u32(data + 4) != NNUE_VERSION || read_u32(data + 8) != NNUE_HIDDEN || read_u32(data + 12) != NNUE_L1) {
+        free(data);
+        free(loaded);
+        return false;
+    }
+
+    const unsigned char *p = data + NNUE_HEADER_SIZE;
+    for (int i = 0; i < NNUE_HIDDEN; i++, p += 2) loaded->ft_bias[i] = read_i16(p);
+    for (int f = 0; f < NNUE_INPUTS; f++) {
+        for (int i = 0; i < NNUE_HIDDEN; i++, p += 2) loaded->ft_weights[f][i] = read_i16(p);
+    }
+    for (int o = 0; o < NNUE_L1; o++, p += 4) loaded->l1_bias[o] = (int32_t)read_u32(p);
+    for (int o = 0; o < NNUE_L1; o++) {
+        for (int i = 0; i < 2 * NNUE_HIDDEN; i++) loaded->l1_weights[o][i] = (int8_t)*p++;
+    }
+    loaded->out_bias = (int32_t)read_u32(p);
+    p += 4;
+    for (int o = 0; o < NNUE_L1; o++) loaded->out_weights[o] = (int8_t)*p++;
+    free(data);
+
+    free(network);
+    network = loaded;
+    nnue_generation = ++last_generation;
+    return true;
+}
+
+/**
+ * Escribe una red en el formato que lee nnue_load.
+ * @return false si no se pudo escribir el archivo.
+ */
+bool nnue_save(const nnue_network_t *net, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return false;
+    fwrite("FNUE", 1, 4, file);
+    write_u32(file, NNUE_VERSION);
+    write_u32(file, NNUE_HIDDEN);
+    write_u32(file, NNUE_L1);
+    for (int i = 0; i < NNUE_HIDDEN; i++) write_i16(file, net->ft_bias[i]);
+    for (int f = 0; f < NNUE_INPUTS; f++) {
+        for (int i = 0; i < NNUE_HIDDEN; i++) write_i16(file, net->ft_weights[f][i]);
+    }
+    for (int o = 0; o < NNUE_L1; o++) write_u32(file, (uint32_t)net->l1_bias[o]);
+    fwrite(net->l1_weights, 1, sizeof(net->l1_weights), file);
+    write_u32(file, (uint32_t)net->out_bias);
+    fwrite(net->out_weights, 1, sizeof(net->out_weights), file);
+    bool ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
+
+// Descarga la red activa (la evaluación vuelve a ser la clásica)
+void nnue_unload(void) {
+    free(network);
+    network = NULL;
+    nnue_generation = 0;
+}
+
+bool nnue_ready(void) {
+    return network != NULL;
+}
+
+// Instrucciones con las que se compiló la inferencia
+const char* nnue_simd_name(void) {
+#if defined(NNUE_AVX2)
+    return "AVX2";
+#elif defined(NNUE_SSSE3)
+    return "SSSE3";
+#elif defined(NNUE_SSE2)
+    return "SSE2";
+#else
+    return "escalar";
+#endif
+}
+
+// Índice de la característica de una pieza desde una perspectiva: las piezas propias van primero
+// y, para las negras, el tablero se voltea (así ambas perspectivas usan los mismos pesos)
+static inline int feature_index(int perspective, int piece, int square) {
+    int relative_color = COLOR(piece) ^ perspective;
+    int index = (square + (square & 7)) >> 1;
+    if (perspective == BLACK) index ^= 56;
+    return (relative_color * 6 + PIECE_TYPE(piece) - 1) * 64 + index;
+}
+
+// values += suma de las columnas 'add' - suma de las columnas 'sub'
+static void accumulate(int16_t *values, const int16_t **sub, int sub_count, const int16_t **add, int add_count) {
+#if defined(NNUE_AVX2)
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+        for (int k = 0; k < sub_count; k++) v = _mm256_sub_epi16(v, _mm256_loadu_si256((const __m256i *)(sub[k] + i)));
+        for (int k = 0; k < add_count; k++) v = _mm256_add_epi16(v, _mm256_loadu_si256((const __m256i *)(add[k] + i)));
+        _mm256_storeu_si256((__m256i *)(values + i), v);
+    }
+#elif defined(NNUE_SSE2)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+        for (int k = 0; k < sub_count; k++) v = _mm_sub_epi16(v, _mm_loadu_si128((const __m128i *)(sub[k] + i)));
+        for (int k = 0; k < add_count; k++) v = _mm_add_epi16(v, _mm_loadu_si128((const __m128i *)(add[k] + i)));
+        _mm_storeu_si128((__m128i *)(values + i), v);
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        int v = values[i];
+        for (int k = 0; k < sub_count; k++) v -= sub[k][i];
+        for (int k = 0; k < add_count; k++) v += add[k][i];
+        values[i] = (int16_t)v;
+    }
+#endif
+}
+
+/**
+ * Calcula el acumulador desde cero con las piezas del tablero.
+ * @param acc: acumulador a calcular (queda válido para la red activa).
+ * @param board: tablero 0x88.
+ */
+void nnue_refresh(nnue_accumulator_t *acc, const int *board) {
+    if (!network) return;
+    const int16_t *columns[2][32];
+    int count = 0;
+    for (int sq = 0; sq < BOARD_SIZE; sq = (sq + 9) & ~8) {
+        if (board[sq] == EMPTY || count == 32) continue;
+        columns[WHITE][count] = network->ft_weights[feature_index(WHITE, board[sq], sq)];
+        columns[BLACK][count] = network->ft_weights[feature_index(BLACK, board[sq], sq)];
+        count++;
+    }
+    for (int perspective = WHITE; perspective <= BLACK; perspective++) {
+        memcpy(acc->values[perspective], network->ft_bias, sizeof(network->ft_bias));
+        accumulate(acc->values[perspective], NULL, 0, columns[perspective], count);
+    }
+    acc->generation = nnue_generation;
+}
+
+/**
+ * Actualiza un acumulador válido con las piezas que salen y entran al tablero en una jugada.
+ * @param removed: características (NNUE_FEATURE) que se quitan (hasta 4).
+ * @param added: características que se agregan (hasta 4).
+ */
+void nnue_update(nnue_accumulator_t *acc, const int *removed, int removed_count, const int *added, int added_count) {
+    if (!network || !nnue_valid(acc)) return;
+    for (int perspective = WHITE; perspective <= BLACK; perspective++) {
+        const int16_t *sub[4], *add[4];
+        for (int k = 0; k < removed_count; k++) {
+            sub[k] = network->ft_weights[feature_index(perspective, removed[k] >> 7, removed[k] & 127)];
+        }
+        for (int k = 0; k < added_count; k++) {
+            add[k] = network->ft_weights[feature_index(perspective, added[k] >> 7, added[k] & 127)];
+        }
+        accumulate(acc->values[perspective], sub, removed_count, add, added_count);
+    }
+}
+
+// Activación ReLU recortada: cada valor del acumulador se lleva a [0, 127] y se guarda como byte
+static void clipped_relu(const int16_t *values, uint8_t *output) {
+#if defined(NNUE_AVX2)
+    const __m256i max = _mm256_set1_epi16(127);
+    for (int i = 0; i < NNUE_HIDDEN; i += 32) {
+        __m256i a = _mm256_min_epi16(_mm256_loadu_si256((const __m256i *)(values + i)), max);
+        __m256i b = _mm256_min_epi16(_mm256_loadu_si256((const __m256i *)(values + i + 16)), max);
+        // packus satura los negativos a 0 e intercala las mitades de 128 bits; el permute recupera el orden
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i *)(output + i), packed);
+    }
+#elif defined(NNUE_SSE2)
+    const __m128i max = _mm_set1_epi16(127);
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m128i a = _mm_min_epi16(_mm_loadu_si128((const __m128i *)(values + i)), max);
+        __m128i b = _mm_min_epi16(_mm_loadu_si128((const __m128i *)(values + i + 8)), max);
+        _mm_storeu_si128((__m128i *)(output + i), _mm_packus_epi16(a, b));
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; i++) {
+        int v = values[i];
+        output[i] = (uint8_t)(v < 0 ? 0 : v > 127 ? 127 : v);
+    }
+#endif
+}
+
+// Producto punto de las entradas (bytes sin signo, máximo 127) con una fila de pesos int8.
+// Con entradas de hasta 127, las sumas de pares de maddubs no se saturan y el resultado es igual al escalar.
+static int32_t dot_product(const uint8_t *input, const int8_t *weights) {
+#if defined(NNUE_AVX2)
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < 2 * NNUE_HIDDEN; i += 32) {
+        __m256i products = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(input + i)),
+                                                _mm256_loadu_si256((const __m256i *)(weights + i)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+#elif defined(NNUE_SSSE3)
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < 2 * NNUE_HIDDEN; i += 16) {
+        __m128i products = _mm_maddubs_epi16(_mm_loadu_si128((const __m128i *)(input + i)),
+                                             _mm_loadu_si128((const __m128i *)(weights + i)));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#elif defined(NNUE_SSE2)
+    // Sin maddubs: las entradas y los pesos se extienden a 16 bits y se multiplican con madd
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < 2 * NNUE_HIDDEN; i += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(input + i));
+        __m128i w = _mm_loadu_si128((const __m128i *)(weights + i));
+        __m128i sign = _mm_cmpgt_epi8(zero, w);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(in, zero), _mm_unpacklo_epi8(w, sign)));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(in, zero), _mm_unpackhi_epi8(w, sign)));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < 2 * NNUE_HIDDEN; i++) sum += input[i] * weights[i];
+    return sum;
+#endif
+}
+
+/**
+ * Evalúa una posición con la red activa.
+ * @param acc: acumulador de la posición (si no es válido, se recalcula desde el tablero).
+ * @param board: tablero 0x88.
+ * @param to_move: jugador que mueve (su perspectiva va primero en la entrada de la capa 1).
+ * @return puntaje en centipeones desde la perspectiva del jugador que mueve (0 si no hay red).
+ */
+int nnue_evaluate(nnue_accumulator_t *acc, const int *board, int to_move) {
+    if (!network) return 0;
+    if (!nnue_valid(acc)) nnue_refresh(acc, board);
+
+    uint8_t input[2 * NNUE_HIDDEN];
+    clipped_relu(acc->values[to_move], input);
+    clipped_relu(acc->values[1 - to_move], input + NNUE_HIDDEN);
+
+    int32_t output = network->out_bias;
+    for (int o = 0; o < NNUE_L1; o++) {
+        int32_t sum = network->l1_bias[o] + dot_product(input, network->l1_weights[o]);
+        int32_t hidden = sum < 0 ? 0 : sum >> NNUE_L1_SHIFT;
+        if (hidden > 127) hidden = 127;
+        output += hidden * network->out_weights[o];
+    }
+    return output / NNUE_OUTPUT_SCALE;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// Evaluación con red neuronal actualizable de forma eficiente (NNUE)
+// https://www.chessprogramming.org/NNUE
+// Entrada: 768 características por perspectiva (color relativo de la pieza x tipo x casilla, con el tablero
+// volteado para las negras). La primera capa (el acumulador) se actualiza en make_move/fast_unmake_move
+// sumando y restando las columnas de las piezas que cambian, sin recalcularla desde cero.
+// Capas: 768 -> NNUE_HIDDEN (x2 perspectivas) -> NNUE_L1 -> 1, con pesos cuantizados (int16 en el acumulador,
+// int8 en las capas densas) y activación ReLU recortada a [0, 127].
+// La inferencia usa AVX2 compilando con -mavx2 (o -march=native), SSE2 en cualquier otro x86-64 (SSSE3 si está
+// habilitado) y código escalar en las demás arquitecturas; los resultados son idénticos en todos los casos.
+//
+// Formato del archivo de pesos (enteros little-endian):
+//   "FNUE", versión (u32), NNUE_HIDDEN (u32), NNUE_L1 (u32),
+//   sesgos del acumulador (i16 x NNUE_HIDDEN), pesos del acumulador (i16 x 768 x NNUE_HIDDEN, por característica),
+//   sesgos de la capa 1 (i32 x NNUE_L1), pesos de la capa 1 (i8 x NNUE_L1 x 2*NNUE_HIDDEN, por neurona),
+//   sesgo de salida (i32), pesos de salida (i8 x NNUE_L1).
+// Cuantización: la capa 1 se divide por 2^NNUE_L1_SHIFT antes de recortar; la salida se divide por NNUE_OUTPUT_SCALE
+// para obtener centipeones.
+
+#define NNUE_INPUTS 768
+#define NNUE_HIDDEN 128
+#define NNUE_L1 16
+#define NNUE_L1_SHIFT 6
+#define NNUE_OUTPUT_SCALE 4
+#define NNUE_VERSION 1
+#define NNUE_DEFAULT_FILE "fortuna.nnue"
+
+// Característica de una pieza en una casilla (formato 0x88), para nnue_update
+#define NNUE_FEATURE(piece, square) (((piece) << 7) | (square))
+
+// Acumulador de una posición: salida de la primera capa desde cada perspectiva (WHITE, BLACK)
+typedef struct {
+    int16_t values[2][NNUE_HIDDEN];
+    int generation;                 // Red con la que se calculó (0 = no calculado, ver nnue_valid)
+} nnue_accumulator_t;
+
+// Pesos cuantizados de la red
+typedef struct {
+    int16_t ft_bias[NNUE_HIDDEN];
+    int16_t ft_weights[NNUE_INPUTS][NNUE_HIDDEN];
+    int32_t l1_bias[NNUE_L1];
+    int8_t l1_weights[NNUE_L1][2 * NNUE_HIDDEN];
+    int32_t out_bias;
+    int8_t out_weights[NNUE_L1];
+} nnue_network_t;
+
+// Generación de la red cargada (0 = sin red). Cambia con cada nnue_load, así los acumuladores calculados
+// con otra red quedan inválidos. Solo se modifica cuando no hay búsquedas en curso.
+extern int nnue_generation;
+
+// El acumulador refleja el tablero actual con la red cargada (si no, se recalcula al evaluar)
+static inline bool nnue_valid(const nnue_accumulator_t *acc) {
+    return nnue_generation != 0 && acc->generation == nnue_generation;
+}
+
+bool nnue_load(const char *path);
+bool nnue_save(const nnue_network_t *network, const char *path);
+void nnue_unload(void);
+bool nnue_ready(void);
+const char* nnue_simd_name(void);
+void nnue_refresh(nnue_accumulator_t *acc, const int *board);
+void nnue_update(nnue_accumulator_t *acc, const int *removed, int removed_count, const int *added, int added_count);
+int nnue_evaluate(nnue_accumulator_t *acc, const int *board, int to_move);
@@ -0,0 +1,233 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "pawns.h"
+#include "stats.h"
+
+// Las penalizaciones y bonos (medio juego, final) están en eval_params (ver eval.h)
+
+#define BIT(rank, file) (1ULL << ((rank) * 8 + (file)))
+
+typedef struct {
+    pawn_entry_t *entries;
+    size_t mask;                    // Cantidad de entradas - 1 (potencia de 2)
+    size_t size_mb;
+    unsigned epoch;                 // Valor de table_epoch con el que se llenó
+    uint64_t probes;
+    uint64_t hits;
+} pawn_table_t;
+
+static atomic_size_t table_size_mb = PAWN_HASH_DEFAULT_MB;
+static atomic_uint table_epoch = 0;     // Cambia cuando cambian los parámetros de la evaluación
+static _Thread_local pawn_table_t *thread_table = NULL;
+static _Thread_local pawn_entry_t scratch_entry;    // Si no hay memoria para la tabla
+// La clave de pthread solo sirve para liberar la tabla de cada hilo cuando este termina
+static pthread_key_t table_key;
+static pthread_once_t table_key_once = PTHREAD_ONCE_INIT;
+
+static void table_destroy(void *arg) {
+    pawn_table_t *table = arg;
+    free(table->entries);
+    free(table);
+}
+
+static void table_key_create(void) {
+    pthread_key_create(&table_key, table_destroy);
+}
+
+// Tabla del hilo actual. Se crea en el primer uso, se vuelve a reservar si cambió el tamaño configurado
+// y se vacía si cambiaron los parámetros de la evaluación
+static pawn_table_t* current_table(void) {
+    size_t mb = atomic_load_explicit(&table_size_mb, memory_order_relaxed);
+    unsigned epoch = atomic_load_explicit(&table_epoch, memory_order_relaxed);
+    pawn_table_t *table = thread_table;
+    if (table && table->size_mb == mb && table->epoch == epoch) return table;
+    if (table && table->size_mb == mb) {
+        if (table->entries) memset(table->entries, 0, (table->mask + 1) * sizeof(pawn_entry_t));
+        table->epoch = epoch;
+        return table;
+    }
+
+    if (!table) {
+        table = calloc(1, sizeof(pawn_table_t));
+        if (!table) return NULL;
+        pthread_once(&table_key_once, table_key_create);
+        pthread_setspecific(table_key, table);
+        thread_table = table;
+    }
+
+    free(table->entries);
+    size_t count = 1;
+    while (count * 2 * sizeof(pawn_entry_t) <= mb * 1024 * 1024) count *= 2;
+    table->entries = calloc(count, sizeof(pawn_entry_t));
+    table->mask = table->entries ? count - 1 : 0;
+    table->size_mb = mb;
+    table->epoch = epoch;
+    table->probes = 0;
+    table->hits = 0;
+    return table;
+}
+
+/**
+ * Cambia el tamaño de las tablas de peones. Cada hilo ajusta su tabla en su siguiente evaluación.
+ * @param mb: tamaño de cada tabla en megabytes (entre 1 y PAWN_HASH_MAX_MB).
+ */
+void pawn_hash_set_size(size_t mb) {
+    if (mb < 1) mb = 1;
+    if (mb > PAWN_HASH_MAX_MB) mb = PAWN_HASH_MAX_MB;
+    atomic_store(&table_size_mb, mb);
+}
+
+size_t pawn_hash_size(void) {
+    return atomic_load(&table_size_mb);
+}
+
+// Descarta el contenido de las tablas de peones de todos los hilos (cada una se vacía en su siguiente uso)
+void pawn_hash_clear(void) {
+    atomic_fetch_add(&table_epoch, 1);
+}
+
+// Consultas y aciertos de la tabla del hilo actual (desde que se creó o cambió de tamaño)
+void pawn_hash_counters(uint64_t *probes, uint64_t *hits) {
+    *probes = thread_table ? thread_table->probes : 0;
+    *hits = thread_table ? thread_table->hits : 0;
+}
+
+static inline uint64_t file_mask(int file) {
+    return 0x0101010101010101ULL << file;
+}
+
+static inline uint64_t adjacent_files(int file) {
+    return (file > 0 ? file_mask(file - 1) : 0) | (file < 7 ? file_mask(file + 1) : 0);
+}
+
+// Filas por delante de 'rank' en la dirección en que avanzan los peones de 'color'
+static inline uint64_t ranks_ahead(int color, int rank) {
+    if (color == WHITE) return rank < 7 ? ~0ULL << ((rank + 1) * 8) : 0;
+    return rank > 0 ? (1ULL << (rank * 8)) - 1 : 0;
+}
+
+void pawn_evaluate(const gamestate_t *game, pawn_entry_t *entry) {
+    pawn_evaluate_traced(game, entry, NULL);
+}
+
+/**
+ * Evalúa la estructura de peones desde cero: peones doblados, aislados, retrasados y pasados.
+ * @param game: posición a evaluar (solo se miran los peones).
+ * @param entry: recibe los puntajes y los bitboards de peones pasados, ataques y alcance de ataque.
+ * @param coefs: si no es NULL, se le suma el aporte de cada parámetro (blancas - negras, para el tuner).
+ */
+void pawn_evaluate_traced(const gamestate_t *game, pawn_entry_t *entry, eval_params_t *coefs) {
+    const eval_params_t *params = &eval_params;
+    uint64_t pawns[2] = {0, 0};
+    for (int rank = 0; rank < 8; rank++) {
+        for (int file = 0; file < 8; file++) {
+            int piece = game->board[SQUARE(rank, file)];
+            if (piece != EMPTY && PIECE_TYPE(piece) == PAWN) pawns[COLOR(piece)] |= BIT(rank, file);
+        }
+    }
+
+    entry->key = game->pawn_key;
+    // Primero los ataques de ambos colores, que se necesitan para reconocer los peones retrasados
+    for (int color = WHITE; color <= BLACK; color++) {
+        int direction = color == WHITE ? 1 : -1;
+        entry->passed[color] = 0;
+        entry->attacks[color] = 0;
+        entry->attack_span[color] = 0;
+        for (int square = 0; square < 64; square++) {
+            if (!(pawns[color] & (1ULL << square))) continue;
+            int rank = square / 8, file = square % 8;
+            int attack_rank = rank + direction;
+            if (attack_rank >= 0 && attack_rank < 8) {
+                if (file > 0) entry->attacks[color] |= BIT(attack_rank, file - 1);
+                if (file < 7) entry->attacks[color] |= BIT(attack_rank, file + 1);
+            }
+            entry->attack_span[color] |= ranks_ahead(color, rank) & adjacent_files(file);
+        }
+    }
+
+    int mg = 0, eg = 0;
+    for (int color = WHITE; color <= BLACK; color++) {
+        int sign = color == WHITE ? 1 : -1;
+        int direction = color == WHITE ? 1 : -1;
+        uint64_t own = pawns[color], enemy = pawns[1 - color];
+
+        for (int file = 0; file < 8; file++) {
+            int count = 0;
+            for (int rank = 0; rank < 8; rank++) count += (own & BIT(rank, file)) != 0;
+            if (count > 1) {
+                mg -= sign * params->doubled_mg * (count - 1);
+                eg -= sign * params->doubled_eg * (count - 1);
+                if (coefs) {
+                    coefs->doubled_mg -= sign * (count - 1);
+                    coefs->doubled_eg -= sign * (count - 1);
+                }
+            }
+        }
+
+        for (int square = 0; square < 64; square++) {
+            if (!(own & (1ULL << square))) continue;
+            int rank = square / 8, file = square % 8;
+            int relative_rank = color == WHITE ? rank : 7 - rank;
+            uint64_t ahead = ranks_ahead(color, rank);
+
+            // Pasado: sin peones rivales delante en su columna ni en las vecinas (y sin un peón propio delante)
+            if (!(enemy & ahead & (file_mask(file) | adjacent_files(file))) && !(own & ahead & file_mask(file))) {
+                entry->passed[color] |= 1ULL << square;
+                mg += sign * params->passed_mg[relative_rank];
+                eg += sign * params->passed_eg[relative_rank];
+                if (coefs) {
+                    coefs->passed_mg[relative_rank] += sign;
+                    coefs->passed_eg[relative_rank] += sign;
+                }
+            }
+
+            if (!(own & adjacent_files(file))) {
+                mg -= sign * params->isolated_mg;
+                eg -= sign * params->isolated_eg;
+                if (coefs) {
+                    coefs->isolated_mg -= sign;
+                    coefs->isolated_eg -= sign;
+                }
+            } else if (!(own & adjacent_files(file) & ~ahead)) {
+                // Retrasado: ningún peón vecino puede protegerlo y la casilla de avance está atacada por un peón rival
+                int stop_rank = rank + direction;
+                if (stop_rank >= 0 && stop_rank < 8 && (entry->attacks[1 - color] & BIT(stop_rank, file))) {
+                    mg -= sign * params->backward_mg;
+                    eg -= sign * params->backward_eg;
+                    if (coefs) {
+                        coefs->backward_mg -= sign;
+                        coefs->backward_eg -= sign;
+                    }
+                }
+            }
+        }
+    }
+    entry->mg = (int16_t)mg;
+    entry->eg = (int16_t)eg;
+}
+
+/**
+ * Busca la estructura de peones de la posición en la tabla del hilo; si no está, la evalúa y la guarda.
+ * @param game: posición con game->pawn_key actualizado.
+ * @return entrada válida hasta la siguiente llamada desde el mismo hilo.
+ */
+const pawn_entry_t* pawn_probe(const gamestate_t *game) {
+    STATS_INC(pawn_probes);
+    pawn_table_t *table = current_table();
+    if (!table || !table->entries) {
+        pawn_evaluate(game, &scratch_entry);
+        return &scratch_entry;
+    }
+
+    table->probes++;
+    pawn_entry_t *entry = &table->entries[game->pawn_key & table->mask];
+    if (entry->key == game->pawn_key) {
+        table->hits++;
+        STATS_INC(pawn_hits);
+        return entry;
+    }
+    pawn_evaluate(game, entry);
+    return entry;
+}
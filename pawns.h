@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "chess.h"
+#include "eval.h"
+
+// Evaluación de la estructura de peones con tabla hash propia
+// https://www.chessprogramming.org/Pawn_Hash_Table
+// La estructura de peones cambia en pocas jugadas de la búsqueda, así que casi todas las evaluaciones encuentran
+// el resultado en la tabla (clave: game->pawn_key). Cada hilo tiene su propia tabla (sin locks), que se crea
+// en su primera evaluación y se libera cuando el hilo termina. El tamaño es independiente de la tabla de transposición.
+// Los bitboards usan un bit por casilla: bit = fila * 8 + columna (a1 = 0, h8 = 63).
+
+#define PAWN_HASH_DEFAULT_MB 1
+#define PAWN_HASH_MAX_MB 256
+
+typedef struct {
+    uint64_t key;
+    int16_t mg;                     // Puntaje de medio juego (perspectiva de las blancas)
+    int16_t eg;                     // Puntaje de final
+    uint64_t passed[2];             // Peones pasados de cada color
+    uint64_t attacks[2];            // Casillas atacadas por los peones de cada color
+    uint64_t attack_span[2];        // Casillas que los peones de cada color pueden llegar a atacar al avanzar
+} pawn_entry_t;
+
+void pawn_hash_set_size(size_t mb);
+size_t pawn_hash_size(void);
+const pawn_entry_t* pawn_probe(const gamestate_t *game);
+void pawn_evaluate(const gamestate_t *game, pawn_entry_t *entry);
+void pawn_evaluate_traced(const gamestate_t *game, pawn_entry_t *entry, eval_params_t *coefs);
+void pawn_hash_clear(void);
+void pawn_hash_counters(uint64_t *probes, uint64_t *hits);
@@ -0,0 +1,254 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "perft.h"
+#include "platform.h"
+
+#define PERFT_OUTPUT_SIZE 2048      // Largo máximo del resultado de una posición
+
+// Posición de la suite con su resultado (se escribe cuando terminan todas las anteriores)
+typedef struct {
+    perft_case_t test;
+    bool valid;
+    bool done;
+    bool passed;
+    char output[PERFT_OUTPUT_SIZE];
+} perft_job_t;
+
+// Estado compartido entre los hilos de la suite
+typedef struct {
+    const perft_suite_options_t *options;
+    perft_job_t *jobs;
+    int count;
+    int next_job;
+    int next_output;
+    int failed;
+    uint64_t total_nodes;
+    pthread_mutex_t lock;
+} perft_suite_t;
+
+/**
+ * Lee una línea de una suite perft: FEN (4 a 6 campos) seguido de anotaciones ";D<n> <nodos>".
+ * @param line: línea del archivo.
+ * @param test: recibe el FEN y los conteos esperados.
+ * @return false si la línea no tiene un FEN o ninguna anotación válida.
+ */
+bool perft_parse_epd(const char *line, perft_case_t *test) {
+    memset(test, 0, sizeof(perft_case_t));
+    const char *separator = strchr(line, ';');
+    if (!separator) return false;
+
+    size_t len = (size_t)(separator - line);
+    while (len > 0 && isspace((unsigned char)line[len - 1])) len--;
+    if (len == 0 || len >= PERFT_MAX_LINE || memchr(line, '/', len) == NULL) return false;
+    memcpy(test->fen, line, len);
+    test->fen[len] = '\0';
+
+    const char *p = separator;
+    while ((p = strchr(p, ';')) != NULL) {
+        p++;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p != 'D' && *p != 'd') continue;
+        char *end;
+        long depth = strtol(p + 1, &end, 10);
+        if (end == p + 1 || depth < 1 || depth > PERFT_MAX_DEPTH) continue;
+        uint64_t nodes = strtoull(end, &end, 10);
+        test->expected[depth] = nodes;
+        if (depth > test->depth) test->depth = (int)depth;
+    }
+    return test->depth > 0;
+}
+
+/**
+ * Muestra los nodos bajo cada jugada legal de la raíz (en notación UCI) y el total.
+ * @param game: posición inicial (se restaura al terminar).
+ * @param depth: profundidad total, contando la jugada de la raíz.
+ * @param out: donde se escriben los conteos.
+ * @return total de nodos (igual a perft(game, depth)).
+ */
+uint64_t perft_divide(gamestate_t *game, int depth, FILE *out) {
+    if (depth < 1) return 1;
+    move_list_t list;
+    generate_moves(game, &list);
+    uint64_t total = 0;
+    int moves = 0;
+
+    for (int i = 0; i < list.count; i++) {
+        move_t move = list.moves[i];
+        if (!is_legal_move(&move, game)) continue;
+        fast_undo_t undo_info;
+        prepare_fast_undo(game, &move, &undo_info);
+        make_move(&move, game, false);
+        uint64_t nodes = perft(game, depth - 1);
+        fast_unmake_move(game, &move, &undo_info);
+
+        char move_str[6];
+        move_to_string(&move, move_str);
+        fprintf(out, "%s: %" PRIu64 "\n", move_str, nodes);
+        total += nodes;
+        moves++;
+    }
+    fprintf(out, "\nJugadas: %d\nNodos: %" PRIu64 "\n", moves, total);
+    return total;
+}
+
+// Ejecuta perft a cada profundidad anotada y deja el resumen en job->output
+static void run_job(perft_suite_t *suite, perft_job_t *job, int index) {
+    char *out = job->output;
+    size_t size = PERFT_OUTPUT_SIZE;
+    int n = snprintf(out, size, "[ PERFT ] #%d %s\n", index + 1, job->test.fen);
+    job->passed = false;
+
+    gamestate_t game;
+    memset(&game, 0, sizeof(gamestate_t));
+    game.en_passant_square = -1;
+    if (!job->valid || init_board_fen(&game, job->test.fen) != 0) {
+        snprintf(out + n, size - n, "          ERROR: línea inválida\n");
+        return;
+    }
+
+    int max_depth = job->test.depth;
+    if (suite->options->max_depth > 0 && max_depth > suite->options->max_depth) max_depth = suite->options->max_depth;
+    bool passed = true;
+    uint64_t nodes_total = 0;
+    for (int depth = 1; depth <= max_depth; depth++) {
+        if (job->test.expected[depth] == 0) continue;
+        int64_t start = platform_time_ns();
+        uint64_t nodes = perft(&game, depth);
+        int64_t elapsed = platform_time_ns() - start;
+        nodes_total += nodes;
+
+        bool ok = nodes == job->test.expected[depth];
+        passed = passed && ok;
+        double seconds = elapsed > 0 ? elapsed / 1e9 : 1e-9;
+        n += snprintf(out + n, size - n, "          D%-2d %14" PRIu64 " %s", depth, nodes, ok ? "OK  " : "FAIL");
+        if (!ok) n += snprintf(out + n, size - n, " (esperado %" PRIu64 ")", job->test.expected[depth]);
+        n += snprintf(out + n, size - n, " %10.3f s %12.0f nodos/s\n", seconds, nodes / seconds);
+        if (n >= (int)size) n = (int)size - 1;
+    }
+    job->passed = passed;
+
+    pthread_mutex_lock(&suite->lock);
+    suite->total_nodes += nodes_total;
+    pthread_mutex_unlock(&suite->lock);
+}
+
+// Escribe los resultados terminados que siguen en el orden del archivo (se llama con el lock tomado)
+static void flush_results(perft_suite_t *suite) {
+    while (suite->next_output < suite->count && suite->jobs[suite->next_output].done) {
+        perft_job_t *job = &suite->jobs[suite->next_output];
+        fputs(job->output, stdout);
+        if (!job->passed) suite->failed++;
+        suite->next_output++;
+    }
+    fflush(stdout);
+}
+
+static void* perft_worker_main(void *arg) {
+    perft_suite_t *suite = arg;
+    while (true) {
+        pthread_mutex_lock(&suite->lock);
+        if (suite->next_job >= suite->count) {
+            pthread_mutex_unlock(&suite->lock);
+            break;
+        }
+        int index = suite->next_job++;
+        pthread_mutex_unlock(&suite->lock);
+
+        run_job(suite, &suite->jobs[index], index);
+
+        pthread_mutex_lock(&suite->lock);
+        suite->jobs[index].done = true;
+        flush_results(suite);
+        pthread_mutex_unlock(&suite->lock);
+    }
+    return NULL;
+}
+
+// Lee todas las posiciones del archivo (las suites tienen a lo más unos cientos de líneas)
+static bool load_suite(perft_suite_t *suite, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror("[ PERFT ] Error al abrir la suite");
+        return false;
+    }
+    int capacity = 64;
+    suite->jobs = malloc(capacity * sizeof(perft_job_t));
+    char line[PERFT_MAX_LINE];
+    while (suite->jobs && fgets(line, sizeof(line), file)) {
+        char *text = line;
+        while (isspace((unsigned char)*text)) text++;
+        if (*text == '\0' || *text == '#') continue;
+        if (suite->count == capacity) {
+            capacity *= 2;
+            perft_job_t *grown = realloc(suite->jobs, capacity * sizeof(perft_job_t));
+            if (!grown) {
+                free(suite->jobs);
+                suite->jobs = NULL;
+                break;
+            }
+            suite->jobs = grown;
+        }
+        perft_job_t *job = &suite->jobs[suite->count++];
+        job->valid = perft_parse_epd(text, &job->test);
+        if (!job->valid) {
+            text[strcspn(text, "\r\n")] = '\0';
+            snprintf(job->test.fen, PERFT_MAX_LINE, "%s", text);
+        }
+        job->done = false;
+    }
+    fclose(file);
+    return suite->jobs != NULL;
+}
+
+/**
+ * Verifica todas las posiciones de una suite perft en paralelo.
+ * @param options: archivo, hilos y profundidad máxima.
+ * @param failed: recibe la cantidad de posiciones con algún conteo incorrecto (o línea inválida).
+ * @return false si no se pudo leer el archivo o crear los hilos.
+ */
+bool perft_suite_run(const perft_suite_options_t *options, int *failed) {
+    perft_suite_t suite;
+    memset(&suite, 0, sizeof(perft_suite_t));
+    suite.options = options;
+    if (!load_suite(&suite, options->path)) return false;
+
+    int threads = options->threads > 0 ? options->threads : platform_cpu_count();
+    if (threads > suite.count) threads = suite.count > 0 ? suite.count : 1;
+    pthread_t *thread_ids = malloc(threads * sizeof(pthread_t));
+    if (!thread_ids) {
+        free(suite.jobs);
+        return false;
+    }
+    pthread_mutex_init(&suite.lock, NULL);
+
+    int64_t start = platform_time_ms();
+    // Los hilos toman las posiciones de un contador compartido: si no se puede crear alguno, las verifican los demás
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&thread_ids[started], NULL, perft_worker_main, &suite) == 0) started++;
+    }
+    if (started == 0) {
+        fprintf(stderr, "[ PERFT ] No se pudo crear ningún hilo\n");
+        pthread_mutex_destroy(&suite.lock);
+        free(thread_ids);
+        free(suite.jobs);
+        return false;
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(thread_ids[t], NULL);
+    }
+    int64_t elapsed = platform_time_ms() - start;
+    double seconds = elapsed > 0 ? elapsed / 1000.0 : 0.001;
+
+    printf("[ PERFT ] Posiciones: %d | Correctas: %d | Incorrectas: %d | Nodos: %" PRIu64 " | Tiempo: %.2f s | %.0f nodos/s | Hilos: %d\n",
+           suite.count, suite.count - suite.failed, suite.failed, suite.total_nodes, seconds, suite.total_nodes / seconds, started);
+
+    *failed = suite.failed;
+    pthread_mutex_destroy(&suite.lock);
+    free(thread_ids);
+    free(suite.jobs);
+    return true;
+}
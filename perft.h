@@ -0,0 +1,31 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "chess.h"
+
+// Validación de la generación de movimientos con perft
+// https://www.chessprogramming.org/Perft_Results
+// El modo suite lee un archivo EPD con los conteos esperados por profundidad, con el formato estándar:
+//   rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - ;D1 20 ;D2 400 ;D3 8902
+// Las posiciones se reparten entre varios hilos y los resultados se muestran en el orden del archivo.
+// El modo divide muestra los nodos bajo cada jugada de la raíz, para encontrar la jugada donde difiere un conteo.
+
+#define PERFT_MAX_DEPTH 15
+#define PERFT_MAX_LINE 1024
+
+typedef struct {
+    const char *path;               // Archivo EPD con las anotaciones ;D<n> <nodos>
+    int threads;                    // Hilos (0 = todos los núcleos)
+    int max_depth;                  // Profundidad máxima a verificar (0 = todas las del archivo)
+} perft_suite_options_t;
+
+typedef struct {
+    char fen[PERFT_MAX_LINE];
+    uint64_t expected[PERFT_MAX_DEPTH + 1];     // expected[d] = nodos esperados a profundidad d (0 = sin dato)
+    int depth;                                  // Mayor profundidad con dato
+} perft_case_t;
+
+bool perft_parse_epd(const char *line, perft_case_t *test);
+bool perft_suite_run(const perft_suite_options_t *options, int *failed);
+uint64_t perft_divide(gamestate_t *game, int depth, FILE *out);
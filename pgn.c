@@ -0,0 +1,635 @@
+#include "pgn.h"
+#include <pthread.h>
+#include "platform.h"
+
+bool pgn_reader_open(pgn_reader_t *reader, const char *filename) {
+    memset(reader, 0, sizeof(pgn_reader_t));
+    reader->file = fopen(filename, "rb");
+    if (!reader->file) {
+        perror("[ PGN ] Error al abrir el archivo");
+        return false;
+    }
+    reader->buffer = malloc(PGN_CHUNK_SIZE);
+    if (!reader->buffer) {
+        fclose(reader->file);
+        reader->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+void pgn_reader_close(pgn_reader_t *reader) {
+    if (reader->file) fclose(reader->file);
+    free(reader->buffer);
+    reader->file = NULL;
+    reader->buffer = NULL;
+}
+
+void pgn_game_init(pgn_game_t *game) {
+    game->result = PGN_RESULT_UNKNOWN;
+    game->fen[0] = '\0';
+    game->moves = NULL;
+    game->move_count = 0;
+    game->move_capacity = 0;
+}
+
+void pgn_game_free(pgn_game_t *game) {
+    free(game->moves);
+    pgn_game_init(game);
+}
+
+// Agrega una jugada SAN al final de la partida (el arreglo crece al doble cuando se llena)
+static bool pgn_game_append(pgn_game_t *game, const char *san, int len) {
+    if (game->move_count == game->move_capacity) {
+        int capacity = game->move_capacity ? game->move_capacity * 2 : 128;
+        char (*moves)[PGN_MAX_SAN] = realloc(game->moves, capacity * sizeof(*moves));
+        if (!moves) return false;
+        game->moves = moves;
+        game->move_capacity = capacity;
+    }
+    if (len > PGN_MAX_SAN - 1) len = PGN_MAX_SAN - 1;
+    memcpy(game->moves[game->move_count], san, len);
+    game->moves[game->move_count][len] = '\0';
+    game->move_count++;
+    return true;
+}
+
+// Lee el siguiente bloque del archivo. Retorna false al llegar al final
+static bool reader_fill(pgn_reader_t *reader) {
+    reader->len = fread(reader->buffer, 1, PGN_CHUNK_SIZE, reader->file);
+    reader->pos = 0;
+    reader->bytes_read += reader->len;
+    return reader->len > 0;
+}
+
+// Equivalentes a getc/ungetc sobre el bloque actual (sin el costo de bloqueo de stdio por carácter)
+static inline int reader_getc(pgn_reader_t *reader) {
+    if (reader->pos == reader->len && !reader_fill(reader)) return EOF;
+    return (unsigned char)reader->buffer[reader->pos++];
+}
+
+// Solo se puede devolver el último carácter leído (siempre está en el bloque actual)
+static inline void reader_ungetc(pgn_reader_t *reader, int c) {
+    if (c != EOF) reader->pos--;
+}
+
+static inline bool is_pgn_space(int c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+}
+
+// Avanza en el archivo hasta encontrar el carácter 'end' (o EOF)
+static int skip_until(pgn_reader_t *reader, int end) {
+    // Búsqueda directa en el bloque con memchr, que es mucho más rápida que avanzar carácter por carácter
+    while (true) {
+        if (reader->pos == reader->len && !reader_fill(reader)) return EOF;
+        char *found = memchr(reader->buffer + reader->pos, end, reader->len - reader->pos);
+        if (found) {
+            reader->pos = (size_t)(found - reader->buffer) + 1;
+            return end;
+        }
+        reader->pos = reader->len;
+    }
+}
+
+// Salta una variante completa, incluyendo variantes anidadas y comentarios dentro de ella
+static void skip_variation(pgn_reader_t *reader) {
+    int depth = 1;
+    int c;
+    while (depth > 0 && (c = reader_getc(reader)) != EOF) {
+        if (c == '(') depth++;
+        else if (c == ')') depth--;
+        else if (c == '{') skip_until(reader, '}');
+        else if (c == ';') skip_until(reader, '\n');
+    }
+}
+
+static pgn_result_t parse_result(const char *token) {
+    if (strcmp(token, "1-0") == 0) return PGN_RESULT_WHITE_WINS;
+    if (strcmp(token, "0-1") == 0) return PGN_RESULT_BLACK_WINS;
+    if (strcmp(token, "1/2-1/2") == 0) return PGN_RESULT_DRAW;
+    return PGN_RESULT_UNKNOWN;
+}
+
+// Lee un tag de la forma [Nombre "valor"]. Se asume que el '[' ya fue consumido
+static void read_tag(pgn_reader_t *reader, pgn_game_t *game) {
+    char name[32];
+    char value[256];
+    int len = 0;
+    int c;
+
+    while ((c = reader_getc(reader)) != EOF && c != '"' && c != ']') {
+        if (!is_pgn_space(c) && len < (int)sizeof(name) - 1) name[len++] = (char)c;
+    }
+    name[len] = '\0';
+    if (c != '"') return;
+
+    len = 0;
+    while ((c = reader_getc(reader)) != EOF && c != '"') {
+        if (c == '\\') c = reader_getc(reader);     // Comillas escapadas dentro del valor
+        if (c == EOF) break;
+        if (len < (int)sizeof(value) - 1) value[len++] = (char)c;
+    }
+    value[len] = '\0';
+    skip_until(reader, ']');
+
+    if (reader->on_tag) reader->on_tag(name, value, reader->tag_user);
+
+    if (strcmp(name, "Result") == 0) {
+        game->result = parse_result(value);
+    } else if (strcmp(name, "FEN") == 0) {
+        strncpy(game->fen, value, PGN_MAX_FEN - 1);
+        game->fen[PGN_MAX_FEN - 1] = '\0';
+    }
+}
+
+// Caracteres que terminan un token del movetext
+static inline bool is_token_end(int c) {
+    return is_pgn_space(c) || c == '{' || c == '}' || c == '(' || c == ')' ||
+           c == '[' || c == ']' || c == ';' || c == '$';
+}
+
+/**
+ * Lee la siguiente partida del archivo. Los comentarios, variantes y NAGs ($n) se descartan.
+ * @param reader: lector abierto con pgn_reader_open.
+ * @param game: partida donde se guardan el resultado, el FEN inicial y las jugadas SAN (se reutiliza entre llamadas).
+ * @return true si se leyó una partida, false al llegar al final del archivo.
+ */
+bool pgn_next_game(pgn_reader_t *reader, pgn_game_t *game) {
+    bool started = false;       // Se leyó al menos un tag o jugada
+    bool in_movetext = false;   // Ya se está leyendo la lista de jugadas
+    char token[64];
+    int c;
+
+    game->result = PGN_RESULT_UNKNOWN;
+    game->fen[0] = '\0';
+    game->move_count = 0;
+
+    while ((c = reader_getc(reader)) != EOF) {
+        if (is_pgn_space(c)) continue;
+
+        if (c == '[') {
+            // Un tag después de las jugadas indica que comenzó otra partida (la anterior no tenía resultado)
+            if (in_movetext) {
+                reader_ungetc(reader, c);
+                break;
+            }
+            read_tag(reader, game);
+            started = true;
+            continue;
+        }
+        if (c == '{') { skip_until(reader, '}'); continue; }
+        if (c == ';' || c == '%') { skip_until(reader, '\n'); continue; }
+        if (c == '(') { skip_variation(reader); continue; }
+        if (c == ')' || c == '}' || c == ']') continue;
+        if (c == '$') {
+            while ((c = reader_getc(reader)) != EOF && isdigit(c));
+            reader_ungetc(reader, c);
+            continue;
+        }
+
+        // Token del movetext: número de jugada, jugada SAN o resultado
+        int len = 0;
+        token[len++] = (char)c;
+        while ((c = reader_getc(reader)) != EOF && !is_token_end(c)) {
+            if (len < (int)sizeof(token) - 1) token[len++] = (char)c;
+        }
+        if (!is_pgn_space(c)) reader_ungetc(reader, c);
+        token[len] = '\0';
+        started = true;
+        in_movetext = true;
+
+        // Resultados ("1-0", "0-1", "1/2-1/2", "*")
+        if (token[0] == '*' && len == 1) {
+            game->result = PGN_RESULT_UNKNOWN;
+            break;
+        }
+        if (token[0] == '0' || token[0] == '1') {
+            pgn_result_t result = parse_result(token);
+            if (result != PGN_RESULT_UNKNOWN) {
+                game->result = result;
+                break;
+            }
+        }
+
+        // Quitar el número de jugada ("12." o "12...") si viene pegado a la jugada ("12.e4")
+        char *san = token;
+        while (isdigit((unsigned char)*san)) san++;
+        if (san != token && *san == '.') {
+            while (*san == '.') san++;
+        } else {
+            san = token;
+        }
+        // Algunos archivos anotan la captura al paso como "exd6 e.p."
+        if (*san == '\0' || strcmp(san, "e.p.") == 0) continue;
+
+        if (!pgn_game_append(game, san, len - (int)(san - token))) return false;
+    }
+
+    if (!started) return false;
+    reader->games_read++;
+    return true;
+}
+
+/**
+ * Prepara el tablero en la posición inicial de la partida (tag FEN o posición estándar).
+ * No modifica game->move_history.
+ */
+bool pgn_start_position(const pgn_game_t *pgn, gamestate_t *game) {
+    const char *fen = pgn->fen[0] ? pgn->fen : START_FEN;
+    game->castling_rights = 0;
+    game->en_passant_square = -1;
+    return init_board_fen(game, fen) == 0;
+}
+
+static int san_piece_type(char c) {
+    switch (c) {
+        case 'N': return KNIGHT;
+        case 'B': return BISHOP;
+        case 'R': return ROOK;
+        case 'Q': return QUEEN;
+        case 'K': return KING;
+        default: return EMPTY;
+    }
+}
+
+// Verifica si la pieza en 'from' coincide con la desambiguación del SAN y, si es legal, construye el movimiento
+static bool san_try_candidate(gamestate_t *game, int from, int to, int promotion,
+                              int from_file, int from_rank, move_t *move) {
+    if (from_file != -1 && FILE(from) != from_file) return false;
+    if (from_rank != -1 && RANK(from) != from_rank) return false;
+
+    int piece = game->board[from];
+    int color = COLOR(piece);
+    move->from = from;
+    move->to = to;
+    move->piece = piece;
+    move->captured = game->board[to];
+    move->promotion = 0;
+    move->flags = (move->captured != EMPTY) ? MOVE_CAPTURE : MOVE_NORMAL;
+
+    if (PIECE_TYPE(piece) == PAWN) {
+        if (RANK(to) == (color == WHITE ? 7 : 0)) {
+            move->flags = MOVE_PROMOTION;
+            move->promotion = promotion ? promotion : QUEEN;
+        } else if (promotion) {
+            return false;
+        } else if (to == game->en_passant_square && FILE(from) != FILE(to)) {
+            move->flags = MOVE_EN_PASSANT;
+            move->captured = MAKE_PIECE(PAWN, color ^ BLACK);
+        }
+    }
+
+    // is_legal_move valida la geometría del movimiento, bloqueos y que el rey no quede en jaque
+    return is_legal_move(move, game);
+}
+
+/**
+ * Convierte una jugada en notación algebraica estándar (SAN) a un move_t legal.
+ * Soporta desambiguación ("Nbd7", "R1e2", "Qh4e1"), capturas ("exd6"), enroques ("O-O", "O-O-O")
+ * y promociones ("e8=Q+", "e8Q"). Los sufijos de jaque y anotaciones (+, #, !, ?) se ignoran.
+ * En vez de generar todos los movimientos, solo se revisan las casillas desde donde una pieza
+ * del tipo indicado podría llegar a la casilla destino.
+ * @param game: estado del juego donde se realiza la jugada.
+ * @param san: jugada en SAN.
+ * @param move: movimiento resultante.
+ * @return true si la jugada corresponde a un movimiento legal.
+ */
+bool pgn_san_to_move(gamestate_t *game, const char *san, move_t *move) {
+    char buf[PGN_MAX_SAN];
+    int len = 0;
+    for (int i = 0; san[i] != '\0' && len < PGN_MAX_SAN - 1; i++) {
+        if (san[i] != '+' && san[i] != '#' && san[i] != '!' && san[i] != '?') buf[len++] = san[i];
+    }
+    buf[len] = '\0';
+    if (len < 2) return false;
+
+    int color = game->to_move;
+
+    // Enroques (se acepta tanto "O-O" como "0-0")
+    if (buf[0] == 'O' || buf[0] == '0') {
+        int castles = 0;
+        for (int i = 0; i < len; i++) {
+            if (buf[i] == 'O' || buf[i] == '0') castles++;
+        }
+        int king_from = (color == WHITE) ? SQUARE(0, 4) : SQUARE(7, 4);
+        move->from = king_from;
+        move->to = (castles == 3) ? king_from - 2 : king_from + 2;
+        move->piece = MAKE_PIECE(KING, color);
+        move->captured = EMPTY;
+        move->promotion = 0;
+        move->flags = (castles == 3) ? MOVE_CASTLE_QUEEN : MOVE_CASTLE_KING;
+        return is_legal_move(move, game);
+    }
+
+    int piece_type = PAWN;
+    int start = 0;
+    if (san_piece_type(buf[0]) != EMPTY) {
+        piece_type = san_piece_type(buf[0]);
+        start = 1;
+    }
+
+    // Promoción: "e8=Q" o "e8Q"
+    int promotion = 0;
+    if (piece_type == PAWN && len >= 2 && buf[len - 2] == '=') {
+        promotion = san_piece_type(buf[len - 1]);
+        len -= 2;
+    } else if (piece_type == PAWN && san_piece_type(buf[len - 1]) != EMPTY) {
+        promotion = san_piece_type(buf[len - 1]);
+        len -= 1;
+    }
+    if (promotion == KING || len - start < 2) return false;
+
+    int to_file = buf[len - 2] - 'a';
+    int to_rank = buf[len - 1] - '1';
+    if (to_file < 0 || to_file > 7 || to_rank < 0 || to_rank > 7) return false;
+    int to = SQUARE(to_rank, to_file);
+
+    // Desambiguación opcional entre la pieza y la casilla destino
+    int from_file = -1, from_rank = -1;
+    for (int i = start; i < len - 2; i++) {
+        char c = buf[i];
+        if (c >= 'a' && c <= 'h') from_file = c - 'a';
+        else if (c >= '1' && c <= '8') from_rank = c - '1';
+        else if (c != 'x' && c != ':' && c != '-') return false;
+    }
+
+    int own_piece = MAKE_PIECE(piece_type, color);
+    switch (piece_type) {
+        case PAWN: {
+            int back = (color == WHITE) ? -16 : 16;
+            if (from_file != -1 && from_file != to_file) {
+                // Captura: el peón viene de la columna indicada, una fila atrás
+                int from = to + back + (from_file - to_file);
+                if (IS_VALID_SQUARE(from) && game->board[from] == own_piece)
+                    return san_try_candidate(game, from, to, promotion, from_file, from_rank, move);
+                return false;
+            }
+            // Avance simple o doble
+            int from = to + back;
+            if (IS_VALID_SQUARE(from) && game->board[from] == own_piece)
+                return san_try_candidate(game, from, to, promotion, from_file, from_rank, move);
+            if (IS_VALID_SQUARE(from) && game->board[from] == EMPTY) {
+                from += back;
+                if (IS_VALID_SQUARE(from) && game->board[from] == own_piece)
+                    return san_try_candidate(game, from, to, promotion, from_file, from_rank, move);
+            }
+            return false;
+        }
+        case KNIGHT:
+        case KING: {
+            int *offsets = (piece_type == KNIGHT) ? knight_moves : king_moves;
+            for (int i = 0; i < 8; i++) {
+                int from = to + offsets[i];
+                if (IS_VALID_SQUARE(from) && game->board[from] == own_piece &&
+                    san_try_candidate(game, from, to, 0, from_file, from_rank, move))
+                    return true;
+            }
+            return false;
+        }
+        default: {
+            // Piezas deslizantes: recorrer los rayos desde la casilla destino hasta la primera pieza
+            for (int i = 0; i < 8; i++) {
+                int dir = (i < 4) ? bishop_dirs[i] : rook_dirs[i - 4];
+                bool diagonal = (i < 4);
+                if (piece_type == BISHOP && !diagonal) continue;
+                if (piece_type == ROOK && diagonal) continue;
+                for (int from = to + dir; IS_VALID_SQUARE(from); from += dir) {
+                    if (game->board[from] == EMPTY) continue;
+                    if (game->board[from] == own_piece &&
+                        san_try_candidate(game, from, to, 0, from_file, from_rank, move))
+                        return true;
+                    break;
+                }
+            }
+            return false;
+        }
+    }
+}
+
+/**
+ * Convierte un movimiento legal a notación SAN (ej: "Nbd7", "exd8=Q+", "O-O#").
+ * @param game: posición en la que se juega el movimiento (no se modifica).
+ * @param move: movimiento legal.
+ * @param san: buffer de al menos PGN_MAX_SAN caracteres.
+ */
+void pgn_move_to_san(const gamestate_t *game, const move_t *move, char *san) {
+    static const char piece_letters[] = " PNBRQK";
+    gamestate_t position = *game;
+    int type = PIECE_TYPE(move->piece);
+    int len = 0;
+
+    if (move->flags == MOVE_CASTLE_KING || move->flags == MOVE_CASTLE_QUEEN) {
+        strcpy(san, move->flags == MOVE_CASTLE_KING ? "O-O" : "O-O-O");
+        len = (int)strlen(san);
+    } else {
+        bool capture = move->captured != EMPTY || move->flags == MOVE_EN_PASSANT;
+        if (type == PAWN) {
+            if (capture) san[len++] = 'a' + FILE(move->from);
+        } else {
+            san[len++] = piece_letters[type];
+            // Desambiguación: otra pieza del mismo tipo que también puede llegar a la casilla destino
+            move_list_t moves;
+            bool same_file = false, same_rank = false, ambiguous = false;
+            generate_moves(&position, &moves);
+            for (int i = 0; i < moves.count; i++) {
+                move_t *other = &moves.moves[i];
+                if (other->to != move->to || other->from == move->from || other->piece != move->piece) continue;
+                if (!is_legal_move(other, &position)) continue;
+                ambiguous = true;
+                if (FILE(other->from) == FILE(move->from)) same_file = true;
+                if (RANK(other->from) == RANK(move->from)) same_rank = true;
+            }
+            if (ambiguous) {
+                if (!same_file) {
+                    san[len++] = 'a' + FILE(move->from);
+                } else if (!same_rank) {
+                    san[len++] = '1' + RANK(move->from);
+                } else {
+                    san[len++] = 'a' + FILE(move->from);
+                    san[len++] = '1' + RANK(move->from);
+                }
+            }
+        }
+        if (capture) san[len++] = 'x';
+        san[len++] = 'a' + FILE(move->to);
+        san[len++] = '1' + RANK(move->to);
+        if (move->flags == MOVE_PROMOTION) {
+            san[len++] = '=';
+            san[len++] = piece_letters[move->promotion];
+        }
+    }
+
+    // Jaque (+) o jaque mate (#)
+    move_t played = *move;
+    make_move(&played, &position, false);
+    if (is_in_check(&position, position.to_move)) {
+        san[len++] = has_legal_moves(&position) ? '+' : '#';
+    }
+    san[len] = '\0';
+}
+
+/**
+ * Reproduce una partida desde su posición inicial, llamando a on_move antes de cada jugada.
+ * @param pgn: partida leída con pgn_next_game.
+ * @param game: estado donde se reproduce la partida (queda en la posición final).
+ * @param callbacks: callbacks opcionales (puede ser NULL).
+ * @param moves: si no es NULL, se le suma la cantidad de jugadas reproducidas.
+ * @return true si todas las jugadas eran legales.
+ */
+bool pgn_replay_game(const pgn_game_t *pgn, gamestate_t *game, const pgn_callbacks_t *callbacks, void *user, long *moves) {
+    if (!pgn_start_position(pgn, game)) return false;
+
+    for (int ply = 0; ply < pgn->move_count; ply++) {
+        move_t move;
+        if (!pgn_san_to_move(game, pgn->moves[ply], &move)) return false;
+        if (moves) (*moves)++;
+        if (callbacks && callbacks->on_move && !callbacks->on_move(game, &move, ply, user)) break;
+        make_move(&move, game, false);
+    }
+    return true;
+}
+
+// Lee y reproduce todas las partidas de un archivo, acumulando estadísticas
+static bool pgn_process_file(const char *filename, const pgn_callbacks_t *callbacks, void *user, pgn_stats_t *stats) {
+    pgn_reader_t reader;
+    if (!pgn_reader_open(&reader, filename)) return false;
+    if (callbacks) {
+        reader.on_tag = callbacks->on_tag;
+        reader.tag_user = user;
+    }
+
+    pgn_game_t pgn;
+    pgn_game_init(&pgn);
+    gamestate_t game;
+    memset(&game, 0, sizeof(game));
+
+    while (pgn_next_game(&reader, &pgn)) {
+        stats->games++;
+        if (callbacks && callbacks->on_game_start && !callbacks->on_game_start(&pgn, user)) continue;
+        bool valid = pgn_replay_game(&pgn, &game, callbacks, user, &stats->moves);
+        if (!valid) stats->invalid_games++;
+        if (callbacks && callbacks->on_game_end) callbacks->on_game_end(&pgn, &game, valid, user);
+    }
+
+    stats->bytes += reader.bytes_read;
+    pgn_game_free(&pgn);
+    pgn_reader_close(&reader);
+    return true;
+}
+
+/**
+ * Lee y reproduce todas las partidas de un archivo PGN.
+ * @param filename: archivo PGN.
+ * @param callbacks: funciones a llamar por tag, partida y jugada (puede ser NULL para solo validar).
+ * @param user: puntero que se entrega a los callbacks.
+ * @param stats: estadísticas de la lectura (puede ser NULL).
+ * @return true si el archivo se pudo leer.
+ */
+bool pgn_parse_file(const char *filename, const pgn_callbacks_t *callbacks, void *user, pgn_stats_t *stats) {
+    pgn_stats_t local;
+    memset(&local, 0, sizeof(local));
+    int64_t start = platform_time_ms();
+    bool ok = pgn_process_file(filename, callbacks, user, &local);
+    local.seconds = (platform_time_ms() - start) / 1000.0;
+    if (stats) *stats = local;
+    return ok;
+}
+
+// Estado compartido por los hilos de pgn_parse_files_parallel
+typedef struct {
+    const char **filenames;
+    int file_count;
+    int next_file;
+    const pgn_callbacks_t *callbacks;
+    pthread_mutex_t lock;
+    pgn_stats_t stats;
+    bool ok;
+} pgn_parallel_t;
+
+typedef struct {
+    pgn_parallel_t *shared;
+    void *user;
+} pgn_worker_t;
+
+static void* pgn_parallel_worker(void *arg) {
+    pgn_worker_t *worker = arg;
+    pgn_parallel_t *shared = worker->shared;
+    pgn_stats_t local;
+    memset(&local, 0, sizeof(local));
+    bool ok = true;
+
+    while (true) {
+        pthread_mutex_lock(&shared->lock);
+        int index = shared->next_file++;
+        pthread_mutex_unlock(&shared->lock);
+        if (index >= shared->file_count) break;
+        ok = pgn_process_file(shared->filenames[index], shared->callbacks, worker->user, &local) && ok;
+    }
+
+    pthread_mutex_lock(&shared->lock);
+    shared->stats.games += local.games;
+    shared->stats.invalid_games += local.invalid_games;
+    shared->stats.moves += local.moves;
+    shared->stats.bytes += local.bytes;
+    shared->ok = shared->ok && ok;
+    pthread_mutex_unlock(&shared->lock);
+    return NULL;
+}
+
+/**
+ * Procesa varios archivos PGN en paralelo: cada hilo toma el siguiente archivo pendiente
+ * y lo lee con su propio lector y tablero, así que no se comparte estado entre partidas.
+ * @param filenames: archivos a procesar.
+ * @param file_count: cantidad de archivos.
+ * @param threads: cantidad de hilos (0 = todos los núcleos).
+ * @param callbacks: funciones a llamar (se llaman desde varios hilos a la vez).
+ * @param users: users[i] se entrega a los callbacks del hilo i (puede ser NULL).
+ * @param stats: estadísticas totales (puede ser NULL).
+ * @return true si todos los archivos se pudieron leer (false también si no se pudo crear ningún hilo).
+ */
+bool pgn_parse_files_parallel(const char **filenames, int file_count, int threads,
+                              const pgn_callbacks_t *callbacks, void **users, pgn_stats_t *stats) {
+    if (threads <= 0) threads = platform_cpu_count();
+    if (threads > file_count) threads = file_count;
+    if (threads < 1) threads = 1;
+
+    pgn_parallel_t shared;
+    memset(&shared, 0, sizeof(shared));
+    shared.filenames = filenames;
+    shared.file_count = file_count;
+    shared.callbacks = callbacks;
+    shared.ok = true;
+    pthread_mutex_init(&shared.lock, NULL);
+
+    pthread_t *thread_ids = malloc(threads * sizeof(pthread_t));
+    pgn_worker_t *workers = malloc(threads * sizeof(pgn_worker_t));
+    if (!thread_ids || !workers) {
+        free(thread_ids);
+        free(workers);
+        pthread_mutex_destroy(&shared.lock);
+        return false;
+    }
+
+    int64_t start = platform_time_ms();
+    // Los hilos toman los archivos de un contador compartido: si no se puede crear alguno, los leen los demás
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[started].shared = &shared;
+        workers[started].user = users ? users[started] : NULL;
+        if (pthread_create(&thread_ids[started], NULL, pgn_parallel_worker, &workers[started]) == 0) started++;
+    }
+    if (started == 0) {
+        fprintf(stderr, "[ PGN ] No se pudo crear ningún hilo\n");
+        shared.ok = false;
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(thread_ids[t], NULL);
+    }
+    shared.stats.seconds = (platform_time_ms() - start) / 1000.0;
+
+    if (stats) *stats = shared.stats;
+    free(thread_ids);
+    free(workers);
+    pthread_mutex_destroy(&shared.lock);
+    return shared.ok;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "chess.h"
+
+// Lectura de partidas en formato PGN (Portable Game Notation)
+// https://www.chessprogramming.org/Portable_Game_Notation
+// El archivo se procesa por bloques de tamaño fijo (PGN_CHUNK_SIZE), así que la memoria usada no depende
+// del tamaño del archivo: solo del bloque actual y de la partida que se está leyendo.
+
+#define PGN_MAX_SAN 16              // Largo máximo de un movimiento en notación SAN (ej: "exd8=Q+")
+#define PGN_MAX_FEN 128             // Largo máximo del tag [FEN "..."]
+#define PGN_CHUNK_SIZE (1 << 20)    // Tamaño del bloque de lectura (1 MB)
+
+// Resultado de una partida según el tag [Result] o el token final del movetext
+typedef enum {
+    PGN_RESULT_UNKNOWN,     // "*" o sin resultado
+    PGN_RESULT_WHITE_WINS,  // "1-0"
+    PGN_RESULT_BLACK_WINS,  // "0-1"
+    PGN_RESULT_DRAW         // "1/2-1/2"
+} pgn_result_t;
+
+// Partida leída desde el archivo: solo se guardan los datos necesarios para reproducirla
+typedef struct {
+    pgn_result_t result;
+    char fen[PGN_MAX_FEN];              // Posición inicial (vacío si es la posición estándar)
+    char (*moves)[PGN_MAX_SAN];         // Jugadas en SAN, en orden (sin variantes ni comentarios)
+    int move_count;
+    int move_capacity;
+} pgn_game_t;
+
+// Lector secuencial de un archivo PGN
+typedef struct {
+    FILE *file;
+    char *buffer;                       // Bloque actual del archivo
+    size_t pos;
+    size_t len;
+    long games_read;
+    uint64_t bytes_read;
+    // Opcional: se llama por cada tag leído (ej: "White", "Magnus Carlsen")
+    void (*on_tag)(const char *name, const char *value, void *user);
+    void *tag_user;
+} pgn_reader_t;
+
+// Funciones que se llaman durante el procesamiento de un archivo. Cualquiera puede ser NULL
+typedef struct {
+    void (*on_tag)(const char *name, const char *value, void *user);
+    // Antes de reproducir la partida. Retornar false para saltarla
+    bool (*on_game_start)(const pgn_game_t *pgn, void *user);
+    // Antes de realizar cada jugada (position es la posición en la que se juega). Retornar false para detener la partida
+    bool (*on_move)(const gamestate_t *position, const move_t *move, int ply, void *user);
+    // Al terminar la partida. valid es false si alguna jugada SAN no era legal
+    void (*on_game_end)(const pgn_game_t *pgn, const gamestate_t *final_position, bool valid, void *user);
+} pgn_callbacks_t;
+
+// Estadísticas de procesamiento (partidas/segundo es la métrica principal)
+typedef struct {
+    long games;
+    long invalid_games;
+    long moves;
+    uint64_t bytes;
+    double seconds;
+} pgn_stats_t;
+
+// Lectura
+bool pgn_reader_open(pgn_reader_t *reader, const char *filename);
+void pgn_reader_close(pgn_reader_t *reader);
+void pgn_game_init(pgn_game_t *game);
+void pgn_game_free(pgn_game_t *game);
+bool pgn_next_game(pgn_reader_t *reader, pgn_game_t *game);
+// Reproducción
+bool pgn_start_position(const pgn_game_t *pgn, gamestate_t *game);
+bool pgn_san_to_move(gamestate_t *game, const char *san, move_t *move);
+void pgn_move_to_san(const gamestate_t *game, const move_t *move, char *san);
+bool pgn_replay_game(const pgn_game_t *pgn, gamestate_t *game, const pgn_callbacks_t *callbacks, void *user, long *moves);
+// Procesamiento completo de archivos (users[i] se entrega a los callbacks del hilo i)
+bool pgn_parse_file(const char *filename, const pgn_callbacks_t *callbacks, void *user, pgn_stats_t *stats);
+bool pgn_parse_files_parallel(const char **filenames, int file_count, int threads,
+                              const pgn_callbacks_t *callbacks, void **users, pgn_stats_t *stats);
@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Funciones que dependen del sistema operativo (tiempo de reloj, cantidad de núcleos y archivos)
+// Se agrupan aquí para que el resto del código no tenga que preocuparse de #ifdef _WIN32
+
+int platform_cpu_count(void);
+int64_t platform_time_ms(void);    // Reloj monotónico en milisegundos
+int64_t platform_time_ns(void);    // Reloj monotónico en nanosegundos
+const void* platform_map_file(const char *path, size_t *size);    // Archivo completo en memoria, solo lectura
+void platform_unmap_file(const void *data, size_t size);
+bool platform_make_dir(const char *path);                         // true si la carpeta ya existía o se creó
@@ -6,58 +6,60 @@ chess_stack_t* stack_create(size_t data_size) {
     chess_stack_t *stack = malloc(sizeof(chess_stack_t));
     if (!stack) return NULL;
 
-    stack->top = NULL;
+    stack->data = malloc(STACK_INITIAL_CAPACITY * data_size);
+    if (!stack->data) {
+        free(stack);
+        return NULL;
+    }
     stack->size = 0;
+    stack->capacity = STACK_INITIAL_CAPACITY;
     stack->data_size = data_size;
     return stack;
 }
 
 void stack_destroy(chess_stack_t *stack) {
     if (!stack) return;
-    stack_clear(stack);
+    free(stack->data);
     free(stack);
 }
 
 bool stack_push(chess_stack_t *stack, const void *data) {
     if (!stack || !data) return false;
 
-    stack_node_t *new_node = malloc(sizeof(stack_node_t));
-    if (!new_node) return false;
-
-    new_node->data = malloc(stack->data_size);
-    if (!new_node->data) {
-        free(new_node);
-        return false;
+    if (stack->size == stack->capacity) {
+        int capacity = stack->capacity * 2;
+        unsigned char *grown = realloc(stack->data, (size_t)capacity * stack->data_size);
+        if (!grown) return false;
+        stack->data = grown;
+        stack->capacity = capacity;
     }
 
-    memcpy(new_node->data, data, stack->data_size);
-    new_node->next = stack->top;
-    stack->top = new_node;
+    memcpy(stack->data + (size_t)stack->size * stack->data_size, data, stack->data_size);
     stack->size++;
     return true;
 }
 
 bool stack_pop(chess_stack_t *stack, void *out) {
-    if (!stack || !stack->top || !out) return false;
+    if (!stack || stack->size == 0 || !out) return false;
 
-    stack_node_t *top_node = stack->top;
-    memcpy(out, top_node->data, stack->data_size);
-
-    stack->top = top_node->next;
     stack->size--;
-
-    free(top_node->data);
-    free(top_node);
+    memcpy(out, stack->data + (size_t)stack->size * stack->data_size, stack->data_size);
     return true;
 }
 
 void* stack_peek(chess_stack_t *stack) {
-    if (!stack || !stack->top) return NULL;
-    return stack->top->data;
+    if (!stack || stack->size == 0) return NULL;
+    return stack->data + (size_t)(stack->size - 1) * stack->data_size;
+}
+
+// Elemento en la posición 'index', contando desde el fondo de la pila (0 = el primero que se agregó)
+void* stack_get(chess_stack_t *stack, int index) {
+    if (!stack || index < 0 || index >= stack->size) return NULL;
+    return stack->data + (size_t)index * stack->data_size;
 }
 
 bool stack_is_empty(chess_stack_t *stack) {
-    return (stack == NULL || stack->top == NULL);
+    return (stack == NULL || stack->size == 0);
 }
 
 int stack_size(chess_stack_t *stack) {
@@ -66,11 +68,5 @@ int stack_size(chess_stack_t *stack) {
 
 void stack_clear(chess_stack_t *stack) {
     if (!stack) return;
-    while (stack->top) {
-        stack_node_t *temp = stack->top;
-        stack->top = temp->next;
-        free(temp->data);
-        free(temp);
-    }
     stack->size = 0;
-}
\ No newline at end of file
+}
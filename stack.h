@@ -2,15 +2,15 @@
 #include <stdbool.h>
 #include <stddef.h>
 
-typedef struct stack_node {
-    void *data;
-    struct stack_node *next;
-} stack_node_t;
+#define STACK_INITIAL_CAPACITY 64   // Elementos reservados al crear la pila (luego crece al doble)
 
+// Pila sobre un arreglo contiguo que crece al doble cuando se llena
+// push y pop no reservan memoria (salvo al crecer), y los elementos se pueden leer por índice
 typedef struct {
-    stack_node_t *top;
+    unsigned char *data;    // Elementos, desde el más antiguo (índice 0) hasta el tope
     int size;
-    size_t data_size;   // Para saber cuanto copiar
+    int capacity;
+    size_t data_size;       // Para saber cuanto copiar
 } chess_stack_t;
 // 17/05/25: Se cambió de stack_t a chess_stack_t
 // Ya que algunos OS (como macOS) tienen definido su propio stack_t
@@ -21,6 +21,7 @@ void stack_destroy(chess_stack_t *stack);
 bool stack_push(chess_stack_t *stack, const void *data);
 bool stack_pop(chess_stack_t *stack, void *out);
 void* stack_peek(chess_stack_t *stack);
+void* stack_get(chess_stack_t *stack, int index);
 bool stack_is_empty(chess_stack_t *stack);
 int stack_size(chess_stack_t *stack);
-void stack_clear(chess_stack_t *stack);
\ No newline at end of file
+void stack_clear(chess_stack_t *stack);
@@ -0,0 +1,66 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "stats.h"
+
+#ifdef FORTUNA_STATS
+_Thread_local search_stats_t thread_stats;
+#endif
+
+static pthread_mutex_t report_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE *report_file = NULL;
+
+void stats_reset(search_stats_t *stats) {
+    memset(stats, 0, sizeof(search_stats_t));
+}
+
+void stats_merge(search_stats_t *into, const search_stats_t *from) {
+    into->nodes += from->nodes;
+    into->qnodes += from->qnodes;
+    into->tt_probes += from->tt_probes;
+    into->tt_hits += from->tt_hits;
+    into->tt_cutoffs += from->tt_cutoffs;
+    into->beta_cutoffs += from->beta_cutoffs;
+    for (int i = 0; i < STATS_CUTOFF_SLOTS; i++) into->cutoff_index[i] += from->cutoff_index[i];
+    into->eval_calls += from->eval_calls;
+    into->movegen_calls += from->movegen_calls;
+    into->legality_checks += from->legality_checks;
+    into->make_moves += from->make_moves;
+    into->unmake_moves += from->unmake_moves;
+    into->pawn_probes += from->pawn_probes;
+    into->pawn_hits += from->pawn_hits;
+    if (from->memory_peak > into->memory_peak) into->memory_peak = from->memory_peak;
+}
+
+/**
+ * Escribe una línea JSON con los contadores de una búsqueda.
+ * @param scope: "thread" (un hilo) o "total" (suma de todos los hilos).
+ * @param thread_id: hilo al que corresponden los contadores (-1 para el total).
+ * @param depth: última profundidad completada.
+ * @param time_ms: duración de la búsqueda.
+ */
+void stats_report(const char *scope, int thread_id, int depth, int64_t time_ms, const search_stats_t *stats) {
+    pthread_mutex_lock(&report_lock);
+    if (!report_file) {
+        const char *path = getenv("FORTUNA_STATS_FILE");
+        report_file = path ? fopen(path, "a") : NULL;
+        if (!report_file) report_file = stderr;
+    }
+    FILE *out = report_file;
+    fprintf(out, "{\"scope\":\"%s\",\"thread\":%d,\"depth\":%d,\"time_ms\":%" PRId64, scope, thread_id, depth, time_ms);
+    fprintf(out, ",\"nodes\":%" PRIu64 ",\"qnodes\":%" PRIu64, stats->nodes, stats->qnodes);
+    fprintf(out, ",\"tt_probes\":%" PRIu64 ",\"tt_hits\":%" PRIu64 ",\"tt_cutoffs\":%" PRIu64,
+            stats->tt_probes, stats->tt_hits, stats->tt_cutoffs);
+    fprintf(out, ",\"beta_cutoffs\":%" PRIu64 ",\"cutoff_index\":[", stats->beta_cutoffs);
+    for (int i = 0; i < STATS_CUTOFF_SLOTS; i++) {
+        fprintf(out, "%s%" PRIu64, i > 0 ? "," : "", stats->cutoff_index[i]);
+    }
+    fprintf(out, "],\"eval_calls\":%" PRIu64 ",\"movegen_calls\":%" PRIu64 ",\"legality_checks\":%" PRIu64,
+            stats->eval_calls, stats->movegen_calls, stats->legality_checks);
+    fprintf(out, ",\"make_moves\":%" PRIu64 ",\"unmake_moves\":%" PRIu64, stats->make_moves, stats->unmake_moves);
+    fprintf(out, ",\"pawn_probes\":%" PRIu64 ",\"pawn_hits\":%" PRIu64, stats->pawn_probes, stats->pawn_hits);
+    fprintf(out, ",\"memory_peak\":%" PRIu64 "}\n", stats->memory_peak);
+    fflush(out);
+    pthread_mutex_unlock(&report_lock);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+
+// Contadores de la búsqueda y de las funciones más usadas (generación de jugadas, legalidad, make/unmake)
+// Solo existen si se compila con -DFORTUNA_STATS; si no, las macros STATS_* no generan código.
+// Cada hilo cuenta en su propia copia (thread_stats), sin sincronización. Al terminar una búsqueda los contadores
+// se juntan y se escribe un reporte en formato JSON (una línea por hilo y una con el total) en la salida de error,
+// o al final del archivo indicado en la variable de entorno FORTUNA_STATS_FILE.
+
+#define STATS_CUTOFF_SLOTS 8        // Cortes beta según el índice de la jugada (el último agrupa el resto)
+
+typedef struct {
+    uint64_t nodes;
+    uint64_t qnodes;                // Nodos de quiescencia (0 mientras la búsqueda no la tenga)
+    uint64_t tt_probes;
+    uint64_t tt_hits;
+    uint64_t tt_cutoffs;
+    uint64_t beta_cutoffs;
+    uint64_t cutoff_index[STATS_CUTOFF_SLOTS];
+    uint64_t eval_calls;
+    uint64_t movegen_calls;
+    uint64_t legality_checks;
+    uint64_t make_moves;
+    uint64_t unmake_moves;
+    uint64_t pawn_probes;           // Consultas a la tabla de peones (ver pawns.h)
+    uint64_t pawn_hits;
+    uint64_t memory_peak;           // Bytes de memoria temporal (arena) de la búsqueda; al juntar hilos, el máximo
+} search_stats_t;
+
+#ifdef FORTUNA_STATS
+extern _Thread_local search_stats_t thread_stats;
+#define STATS_INC(field) (thread_stats.field++)
+#define STATS_CUTOFF(index) (thread_stats.beta_cutoffs++, \
+                             thread_stats.cutoff_index[(index) < STATS_CUTOFF_SLOTS ? (index) : STATS_CUTOFF_SLOTS - 1]++)
+#define STATS_RESET() stats_reset(&thread_stats)
+#define STATS_COLLECT(out) (*(out) = thread_stats)
+#else
+#define STATS_INC(field) ((void)0)
+#define STATS_CUTOFF(index) ((void)0)
+#define STATS_RESET() ((void)0)
+#define STATS_COLLECT(out) ((void)0)
+#endif
+
+void stats_reset(search_stats_t *stats);
+void stats_merge(search_stats_t *into, const search_stats_t *from);
+void stats_report(const char *scope, int thread_id, int depth, int64_t time_ms, const search_stats_t *stats);
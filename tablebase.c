@@ -0,0 +1,475 @@
+#include <stdio.h>
+#include <string.h>
+#include "tablebase.h"
+#include "platform.h"
+
+#define TB_MAX_TABLES 512
+
+// Tabla cargada (mapeada en memoria, solo lectura)
+typedef struct {
+    tb_material_t material;
+    const uint8_t *data;
+    size_t size;
+    uint32_t block_size;
+    uint32_t block_count;
+    const uint8_t *wdl_offsets;     // (block_count + 1) desplazamientos u32 dentro de wdl_data
+    const uint8_t *wdl_data;
+    const uint8_t *dtz_offsets;
+    const uint8_t *dtz_data;
+} tb_table_t;
+
+// Tablas disponibles. Solo cambian con tb_init/tb_add_table/tb_free (sin búsquedas en curso), así que las
+// consultas no necesitan sincronización
+static tb_table_t tables[TB_MAX_TABLES];
+static int table_count = 0;
+static int max_pieces = 0;
+
+// Orden de las piezas de cada bando en la firma (después del rey) y sus letras
+static const int side_order[5] = {QUEEN, ROOK, BISHOP, KNIGHT, PAWN};
+static const char piece_letters[7] = {'?', 'P', 'N', 'B', 'R', 'Q', 'K'};
+static const int piece_strength[7] = {0, 1, 3, 3, 5, 9, 0};
+
+// Triángulo a1-d1-d4: casillas del rey blanco en las tablas sin peones
+static const int8_t triangle_index[64] = {
+     0,  1,  2,  3, -1, -1, -1, -1,
+    -1,  4,  5,  6, -1, -1, -1, -1,
+    -1, -1,  7,  8, -1, -1, -1, -1,
+    -1, -1, -1,  9, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1,
+};
+static const int triangle_squares[10] = {0, 1, 2, 3, 9, 10, 11, 18, 19, 27};
+
+static inline uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t read_u64(const uint8_t *p) {
+    return (uint64_t)read_u32(p) | ((uint64_t)read_u32(p + 4) << 32);
+}
+
+/**
+ * Clave de material: cantidad de piezas de cada tipo y color (4 bits por combinación).
+ * @param flip: contar las piezas con los colores invertidos.
+ */
+uint64_t tb_material_key(const int *pieces, int count, bool flip) {
+    uint64_t key = 0;
+    for (int i = 0; i < count; i++) {
+        int color = COLOR(pieces[i]) ^ (flip ? 1 : 0);
+        key += 1ULL << (4 * (color * 8 + PIECE_TYPE(pieces[i])));
+    }
+    return key;
+}
+
+// Compara el material de dos bandos: el que tiene más valor (y si no, más piezas fuertes) va primero
+static int compare_sides(const int a[7], const int b[7]) {
+    int strength_a = 0, strength_b = 0;
+    for (int type = PAWN; type <= QUEEN; type++) {
+        strength_a += a[type] * piece_strength[type];
+        strength_b += b[type] * piece_strength[type];
+    }
+    if (strength_a != strength_b) return strength_a - strength_b;
+    for (int i = 0; i < 5; i++) {
+        if (a[side_order[i]] != b[side_order[i]]) return a[side_order[i]] - b[side_order[i]];
+    }
+    return 0;
+}
+
+/**
+ * Arma el material canónico de una tabla a partir de una lista de piezas (en cualquier orden y con cualquier
+ * asignación de colores): el bando más fuerte queda como blancas y las piezas en el orden de la firma.
+ * @return false si no hay exactamente un rey por bando o hay más de TB_MAX_PIECES piezas.
+ */
+bool tb_material_from_pieces(const int *pieces, int count, tb_material_t *material) {
+    int counts[2][7] = {{0}};
+    if (count > TB_MAX_PIECES) return false;
+    for (int i = 0; i < count; i++) counts[COLOR(pieces[i])][PIECE_TYPE(pieces[i])]++;
+    if (counts[WHITE][KING] != 1 || counts[BLACK][KING] != 1) return false;
+
+    int strong = compare_sides(counts[WHITE], counts[BLACK]) >= 0 ? WHITE : BLACK;
+    memset(material, 0, sizeof(tb_material_t));
+    int length = 0;
+    for (int side = 0; side < 2; side++) {
+        int color = side == 0 ? strong : 1 - strong;
+        if (side == 1) material->name[length++] = 'v';
+        material->name[length++] = 'K';
+        material->piece[material->count++] = MAKE_PIECE(KING, side == 0 ? WHITE : BLACK);
+        for (int i = 0; i < 5; i++) {
+            int type = side_order[i];
+            for (int k = 0; k < counts[color][type]; k++) {
+                material->name[length++] = piece_letters[type];
+                material->piece[material->count++] = MAKE_PIECE(type, side == 0 ? WHITE : BLACK);
+                if (type == PAWN) material->has_pawns = true;
+            }
+        }
+    }
+    material->name[length] = '\0';
+    material->key = tb_material_key(material->piece, material->count, false);
+
+    material->size = material->has_pawns ? 32 : 10;
+    for (int i = 1; i < material->count; i++) material->size *= PIECE_TYPE(material->piece[i]) == PAWN ? 48 : 64;
+    material->size *= 2;
+    return true;
+}
+
+/**
+ * Lee una firma como "KRPvKR" (se acepta cualquier orden de bandos y piezas).
+ * @return false si la firma no es válida.
+ */
+bool tb_parse_material(const char *name, tb_material_t *material) {
+    int pieces[TB_MAX_PIECES + 1];
+    int count = 0, color = WHITE;
+    for (const char *p = name; *p; p++) {
+        if (*p == 'v' || *p == 'V') {
+            if (color == BLACK) return false;
+            color = BLACK;
+            continue;
+        }
+        int type = 0;
+        for (int t = PAWN; t <= KING; t++) {
+            if (piece_letters[t] == *p) type = t;
+        }
+        if (!type || count > TB_MAX_PIECES) return false;
+        pieces[count++] = MAKE_PIECE(type, color);
+    }
+    return color == BLACK && tb_material_from_pieces(pieces, count, material);
+}
+
+/**
+ * Índice de una posición en su tabla. Primero se lleva a su forma canónica: el rey blanco a las columnas a-d y,
+ * sin peones, al triángulo a1-d1-d4 (si queda en la diagonal, la primera pieza fuera de ella queda bajo la diagonal).
+ * @param pos: piezas en el orden de material->piece.
+ * @return índice, o -1 si un peón está en la primera u octava fila.
+ */
+int64_t tb_index(const tb_material_t *material, const tb_position_t *pos) {
+    int sq[TB_MAX_PIECES] = {0};
+    int count = material->count;
+    for (int i = 0; i < count; i++) sq[i] = pos->square[i];
+
+    if ((sq[0] & 7) > 3) {
+        for (int i = 0; i < count; i++) sq[i] ^= 7;
+    }
+    if (!material->has_pawns) {
+        if ((sq[0] >> 3) > 3) {
+            for (int i = 0; i < count; i++) sq[i] ^= 56;
+        }
+        bool transpose = (sq[0] >> 3) > (sq[0] & 7);
+        if ((sq[0] >> 3) == (sq[0] & 7)) {
+            for (int i = 1; i < count; i++) {
+                if ((sq[i] >> 3) != (sq[i] & 7)) {
+                    transpose = (sq[i] >> 3) > (sq[i] & 7);
+                    break;
+                }
+            }
+        }
+        if (transpose) {
+            for (int i = 0; i < count; i++) sq[i] = ((sq[i] & 7) << 3) | (sq[i] >> 3);
+        }
+    }
+
+    uint64_t index = material->has_pawns ? (uint64_t)((sq[0] >> 3) * 4 + (sq[0] & 7)) : (uint64_t)triangle_index[sq[0]];
+    for (int i = 1; i < count; i++) {
+        if (PIECE_TYPE(material->piece[i]) == PAWN) {
+            if (sq[i] < 8 || sq[i] >= 56) return -1;
+            index = index * 48 + (uint64_t)(sq[i] - 8);
+        } else {
+            index = index * 64 + (uint64_t)sq[i];
+        }
+    }
+    return (int64_t)(index + (pos->to_move ? material->size / 2 : 0));
+}
+
+// Posición de un índice (la inversa de tb_index, sin verificar que sea legal o canónica)
+void tb_decode(const tb_material_t *material, uint64_t index, tb_position_t *pos) {
+    pos->count = material->count;
+    pos->to_move = index >= material->size / 2;
+    if (pos->to_move) index -= material->size / 2;
+    for (int i = material->count - 1; i >= 1; i--) {
+        pos->piece[i] = material->piece[i];
+        if (PIECE_TYPE(material->piece[i]) == PAWN) {
+            pos->square[i] = (int)(index % 48) + 8;
+            index /= 48;
+        } else {
+            pos->square[i] = (int)(index % 64);
+            index /= 64;
+        }
+    }
+    pos->piece[0] = material->piece[0];
+    pos->square[0] = material->has_pawns ? (int)(index / 4) * 8 + (int)(index % 4) : triangle_squares[index];
+}
+
+/**
+ * Agrega una tabla (archivo .ftb) a las disponibles. No se debe llamar mientras hay búsquedas en curso.
+ * @return false si el archivo no existe o no es una tabla válida.
+ */
+bool tb_add_table(const char *path) {
+    if (table_count >= TB_MAX_TABLES) return false;
+    size_t size;
+    const uint8_t *data = platform_map_file(path, &size);
+    if (!data) return false;
+
+    tb_table_t table;
+    memset(&table, 0, sizeof(tb_table_t));
+    char name[TB_MAX_NAME + 1];
+    bool ok = size >= TB_HEADER_SIZE && memcmp(data, "FTB1", 4) == 0 && read_u32(data + 4) == TB_VERSION;
+    if (ok) {
+        memcpy(name, data + 8, TB_MAX_NAME);
+        name[TB_MAX_NAME] = '\0';
+        ok = tb_parse_material(name, &table.material) && read_u64(data + 24) == table.material.size;
+    }
+    if (ok) {
+        table.block_size = read_u32(data + 32);
+        table.block_count = read_u32(data + 36);
+        uint64_t wdl_start = read_u64(data + 40), dtz_start = read_u64(data + 48);
+        uint64_t offsets_size = ((uint64_t)table.block_count + 1) * 4;
+        ok = table.block_size > 0 &&
+             (uint64_t)table.block_count * table.block_size >= table.material.size &&
+             wdl_start + offsets_size <= size && dtz_start + offsets_size <= size;
+        if (ok) {
+            table.wdl_offsets = data + wdl_start;
+            table.wdl_data = table.wdl_offsets + offsets_size;
+            table.dtz_offsets = data + dtz_start;
+            table.dtz_data = table.dtz_offsets + offsets_size;
+            ok = (uint64_t)(table.wdl_data - data) + read_u32(table.wdl_offsets + offsets_size - 4) <= size &&
+                 (uint64_t)(table.dtz_data - data) + read_u32(table.dtz_offsets + offsets_size - 4) <= size;
+        }
+    }
+    if (!ok) {
+        platform_unmap_file(data, size);
+        return false;
+    }
+
+    table.data = data;
+    table.size = size;
+    // Si ya había una tabla con el mismo material, se reemplaza
+    for (int i = 0; i < table_count; i++) {
+        if (tables[i].material.key == table.material.key) {
+            platform_unmap_file(tables[i].data, tables[i].size);
+            tables[i] = table;
+            return true;
+        }
+    }
+    tables[table_count++] = table;
+    if (table.material.count > max_pieces) max_pieces = table.material.count;
+    return true;
+}
+
+/**
+ * Carga todas las tablas de una carpeta (prueba cada combinación de material de hasta TB_MAX_PIECES piezas).
+ * Reemplaza las tablas cargadas antes. No se debe llamar mientras hay búsquedas en curso.
+ * @return cantidad de tablas cargadas.
+ */
+int tb_init(const char *dir) {
+    tb_free();
+    // Cada bando tiene hasta TB_MAX_PIECES - 2 piezas además del rey: se codifican en base 6 (0 = sin pieza,
+    // 1 a 5 = dama, torre, alfil, caballo, peón) y se descartan las combinaciones repetidas por la clave
+    int codes = 1;
+    for (int i = 0; i < TB_MAX_PIECES - 2; i++) codes *= 6;
+    for (int white = 0; white < codes; white++) {
+        for (int black = 0; black < codes; black++) {
+            int pieces[2 * TB_MAX_PIECES] = {MAKE_PIECE(KING, WHITE), MAKE_PIECE(KING, BLACK)};
+            int count = 2;
+            for (int side = 0; side < 2; side++) {
+                for (int code = side == 0 ? white : black; code > 0; code /= 6) {
+                    if (code % 6) pieces[count++] = MAKE_PIECE(side_order[code % 6 - 1], side == 0 ? WHITE : BLACK);
+                }
+            }
+            if (count == 2 || count > TB_MAX_PIECES) continue;
+            tb_material_t material;
+            if (!tb_material_from_pieces(pieces, count, &material)) continue;
+            bool loaded = false;
+            for (int i = 0; i < table_count; i++) {
+                if (tables[i].material.key == material.key) loaded = true;
+            }
+            if (loaded) continue;
+            char path[1024];
+            snprintf(path, sizeof(path), "%s/%s%s", dir, material.name, TB_EXTENSION);
+            tb_add_table(path);
+        }
+    }
+    return table_count;
+}
+
+void tb_free(void) {
+    for (int i = 0; i < table_count; i++) platform_unmap_file(tables[i].data, tables[i].size);
+    table_count = 0;
+    max_pieces = 0;
+}
+
+// Mayor cantidad de piezas de las tablas cargadas (0 = no hay tablas)
+int tb_max_pieces(void) {
+    return max_pieces;
+}
+
+// Valor de una posición dentro de una sección comprimida (recorre las secuencias de su bloque)
+static unsigned section_lookup(const tb_table_t *table, const uint8_t *offsets, const uint8_t *data,
+                               uint64_t index, int value_bytes) {
+    uint32_t block = (uint32_t)(index / table->block_size);
+    uint32_t offset = (uint32_t)(index % table->block_size);
+    const uint8_t *p = data + read_u32(offsets + 4 * (size_t)block);
+    uint32_t position = 0;
+    for (;;) {
+        unsigned value = value_bytes == 2 ? (unsigned)(p[0] | (p[1] << 8)) : p[0];
+        p += value_bytes;
+        uint32_t length = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            byte = *p++;
+            length |= (uint32_t)(byte & 127) << shift;
+            shift += 7;
+        } while (byte & 128);
+        position += length;
+        if (offset < position) return value;
+    }
+}
+
+/**
+ * Consulta una posición (las piezas pueden estar en cualquier orden y con cualquier asignación de colores).
+ * @param dtz: recibe la distancia en plies hasta la próxima captura o movimiento de peón, o hasta el mate
+ *             (0 en las tablas; puede ser NULL).
+ * @return false si no hay una tabla para ese material.
+ */
+bool tb_probe_position(const tb_position_t *pos, int *wdl, int *dtz) {
+    if (pos->count == 2) {
+        *wdl = TB_DRAW;
+        if (dtz) *dtz = 0;
+        return true;
+    }
+    uint64_t key = tb_material_key(pos->piece, pos->count, false);
+    uint64_t flipped_key = tb_material_key(pos->piece, pos->count, true);
+    const tb_table_t *table = NULL;
+    bool flip = false;
+    for (int i = 0; i < table_count && !table; i++) {
+        if (tables[i].material.key == key) {
+            table = &tables[i];
+        } else if (tables[i].material.key == flipped_key) {
+            table = &tables[i];
+            flip = true;
+        }
+    }
+    if (!table) return false;
+
+    // Piezas en el orden de la tabla (con los colores y las filas invertidas si el bando fuerte es el negro)
+    tb_position_t ordered;
+    bool used[TB_MAX_PIECES] = {false};
+    ordered.count = pos->count;
+    ordered.to_move = flip ? 1 - pos->to_move : pos->to_move;
+    for (int i = 0; i < table->material.count; i++) {
+        int wanted = table->material.piece[i];
+        if (flip) wanted ^= 8;
+        for (int j = 0; j < pos->count; j++) {
+            if (!used[j] && pos->piece[j] == wanted) {
+                used[j] = true;
+                ordered.piece[i] = table->material.piece[i];
+                ordered.square[i] = flip ? pos->square[j] ^ 56 : pos->square[j];
+                break;
+            }
+        }
+    }
+    int64_t index = tb_index(&table->material, &ordered);
+    if (index < 0) return false;
+
+    *wdl = (int)section_lookup(table, table->wdl_offsets, table->wdl_data, (uint64_t)index, 1) - 1;
+    if (dtz) *dtz = *wdl == TB_DRAW ? 0 : (int)section_lookup(table, table->dtz_offsets, table->dtz_data, (uint64_t)index, 2);
+    return true;
+}
+
+// Piezas de una posición del juego. Devuelve false si tiene más piezas que las tablas cargadas
+static bool position_from_game(const gamestate_t *game, tb_position_t *pos) {
+    pos->count = 0;
+    pos->to_move = game->to_move;
+    for (int sq = 0; sq < BOARD_SIZE; sq = (sq + 9) & ~8) {
+        int piece = game->board[sq];
+        if (piece == EMPTY) continue;
+        if (pos->count >= max_pieces) return false;
+        pos->piece[pos->count] = piece;
+        pos->square[pos->count] = RANK(sq) * 8 + FILE(sq);
+        pos->count++;
+    }
+    return true;
+}
+
+/**
+ * Resultado de una posición del juego, para la búsqueda. Las tablas no consideran enroques ni capturas al paso,
+ * así que esas posiciones no se consultan.
+ * @param wdl: recibe TB_WIN, TB_DRAW o TB_LOSS desde el punto de vista del que mueve.
+ * @return false si no hay tabla para la posición.
+ */
+bool tb_probe_wdl(const gamestate_t *game, int *wdl) {
+    if (max_pieces == 0 || game->castling_rights != 0 || game->en_passant_square != -1) return false;
+    tb_position_t pos;
+    return position_from_game(game, &pos) && tb_probe_position(&pos, wdl, NULL);
+}
+
+/**
+ * Resultado de la posición después de una jugada de la raíz. Las tablas ignoran la captura al paso, así que si el
+ * rival puede hacerla también se consulta la posición que deja, y el rival se queda con lo mejor de las dos.
+ * @param wdl, dtz: reciben el resultado y la distancia desde el punto de vista del rival.
+ * @return false si alguna de las posiciones no está en las tablas.
+ */
+static bool probe_child(gamestate_t *child, int *wdl, int *dtz) {
+    tb_position_t pos;
+    if (!position_from_game(child, &pos) || !tb_probe_position(&pos, wdl, dtz)) return false;
+    if (child->en_passant_square == -1) return true;
+
+    move_list_t replies;
+    generate_legal_moves(child, &replies);
+    for (int i = 0; i < replies.count; i++) {
+        if (replies.moves[i].flags != MOVE_EN_PASSANT) continue;
+        gamestate_t capture = *child;
+        make_move(&replies.moves[i], &capture, false);
+        int capture_wdl;
+        if (!position_from_game(&capture, &pos) || !tb_probe_position(&pos, &capture_wdl, NULL)) return false;
+        // La captura pone a cero el contador: si mejora el resultado del rival, la distancia pasa a ser 1
+        if (-capture_wdl > *wdl) {
+            *wdl = -capture_wdl;
+            *dtz = 1;
+        }
+    }
+    return true;
+}
+
+/**
+ * Jugada de la raíz según las tablas: si se gana, la que llega antes al mate o a una captura o movimiento de peón
+ * que mantiene la victoria (menor DTZ); si se pierde, la que más lo demora; si son tablas, una que las mantiene.
+ * Como en tb_probe_wdl, las posiciones con enroques o captura al paso no se consultan; las que quedan después de
+ * un avance doble sí, resolviendo la captura al paso con una jugada más. Si ninguna jugada mantiene el resultado
+ * devuelve false y decide la búsqueda.
+ * @param best: recibe la jugada.
+ * @param wdl, dtz: reciben el resultado y la distancia de la posición.
+ * @return false si la posición no está en las tablas.
+ */
+bool tb_probe_root(gamestate_t *game, move_t *best, int *wdl, int *dtz) {
+    tb_position_t pos;
+    if (max_pieces == 0 || game->castling_rights != 0 || game->en_passant_square != -1 ||
+        !position_from_game(game, &pos) || !tb_probe_position(&pos, wdl, dtz)) {
+        return false;
+    }
+
+    move_list_t moves;
+    generate_legal_moves(game, &moves);
+    int best_rank = 0;
+    bool found = false;
+    for (int i = 0; i < moves.count; i++) {
+        move_t *move = &moves.moves[i];
+        gamestate_t child = *game;
+        make_move(move, &child, false);
+        int child_wdl, child_dtz;
+        if (!probe_child(&child, &child_wdl, &child_dtz)) continue;
+        if (-child_wdl != *wdl) continue;
+
+        // Menor es mejor: el mate primero, después las jugadas que ponen a cero el contador y luego el DTZ del rival
+        bool zeroing = move->captured != EMPTY || PIECE_TYPE(move->piece) == PAWN;
+        int rank = child_dtz == 0 && child_wdl == TB_LOSS ? -1 : zeroing ? 0 : child_dtz;
+        if (*wdl == TB_LOSS) rank = -rank;
+        if (!found || rank < best_rank) {
+            found = true;
+            best_rank = rank;
+            *best = *move;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "chess.h"
+
+// Tablas de finales (tablebases) de hasta TB_MAX_PIECES piezas contando los reyes, generadas localmente con
+// tablebase_builder.h. Cada tabla cubre una combinación de material (su firma, ej: "KRPvKR", con el bando más
+// fuerte como blancas; las posiciones con los colores invertidos se consultan volteando el tablero).
+// Para cada posición guardan el resultado con juego perfecto desde el punto de vista del que mueve (WDL) y la
+// distancia en plies hasta la próxima jugada que pone a cero la regla de 50 movimientos (captura, promoción o
+// movimiento de peón) o hasta el mate (DTZ). No consideran la regla de 50 movimientos, enroques ni capturas al paso.
+// https://www.chessprogramming.org/Endgame_Tablebases
+//
+// Índice de una posición: turno, casilla del rey blanco reducida por simetría (10 casillas del triángulo a1-d1-d4
+// sin peones, 32 de las columnas a-d con peones) y casillas de las demás piezas en el orden de la firma (48 para
+// los peones). Así las posiciones vecinas en el archivo difieren en la casilla de la última pieza y sus valores
+// suelen repetirse. Los índices que no corresponden a una posición legal en su forma canónica no importan.
+//
+// Formato del archivo <firma>.ftb (enteros little-endian), mapeado en memoria para consultarlo:
+//   "FTB1", versión (u32), firma (16 bytes), posiciones (u64), posiciones por bloque (u32), bloques (u32),
+//   inicio de la sección WDL (u64), inicio de la sección DTZ (u64).
+//   Cada sección: (bloques + 1) desplazamientos u32 desde el final de la tabla de desplazamientos, y los bloques
+//   comprimidos con largo de secuencias: valor (WDL: 1 byte, 0 = pierde, 1 = tablas, 2 = gana; DTZ: u16) y
+//   largo (entero variable de 7 bits por byte). Las posiciones ilegales toman el valor anterior para alargar
+//   las secuencias, igual que el DTZ de las posiciones en tablas.
+
+#define TB_MAX_PIECES 5
+#define TB_DEFAULT_DIR "tablas"
+#define TB_EXTENSION ".ftb"
+#define TB_VERSION 1
+#define TB_BLOCK_SIZE 4096          // Posiciones por bloque comprimido (unidad de acceso aleatorio)
+#define TB_HEADER_SIZE 64
+#define TB_MAX_NAME 16
+
+// Resultado desde el punto de vista del que mueve
+#define TB_LOSS -1
+#define TB_DRAW 0
+#define TB_WIN 1
+
+// Posición reducida a sus piezas (en el orden de la firma de la tabla), para calcular su índice
+typedef struct {
+    int count;
+    int piece[TB_MAX_PIECES];       // Pieza con su color (ver MAKE_PIECE)
+    int square[TB_MAX_PIECES];      // Casilla de 0 a 63 (fila * 8 + columna)
+    int to_move;
+} tb_position_t;
+
+// Material de una tabla
+typedef struct {
+    char name[TB_MAX_NAME];         // Firma canónica, ej: "KRPvKR"
+    int count;
+    int piece[TB_MAX_PIECES];       // Rey blanco, piezas blancas, rey negro, piezas negras (dama, torre, alfil, caballo, peón)
+    bool has_pawns;
+    uint64_t key;                   // Cantidad de piezas de cada tipo y color (ver tb_material_key)
+    uint64_t size;                  // Cantidad de índices
+} tb_material_t;
+
+uint64_t tb_material_key(const int *pieces, int count, bool flip);
+bool tb_parse_material(const char *name, tb_material_t *material);
+bool tb_material_from_pieces(const int *pieces, int count, tb_material_t *material);
+int64_t tb_index(const tb_material_t *material, const tb_position_t *pos);
+void tb_decode(const tb_material_t *material, uint64_t index, tb_position_t *pos);
+
+int tb_init(const char *dir);
+bool tb_add_table(const char *path);
+void tb_free(void);
+int tb_max_pieces(void);
+bool tb_probe_position(const tb_position_t *pos, int *wdl, int *dtz);
+bool tb_probe_wdl(const gamestate_t *game, int *wdl);
+bool tb_probe_root(gamestate_t *game, move_t *best, int *wdl, int *dtz);
@@ -0,0 +1,682 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include "tablebase_builder.h"
+#include "platform.h"
+
+#define TBB_CHUNK 4096              // Posiciones por reparto entre hilos
+#define TBB_MAX_THREADS 256
+#define TBB_MAX_CHILDREN 256
+#define TBB_MAX_DONE 512
+
+// Estado de cada posición durante la generación
+enum {
+    TBB_UNKNOWN,                    // Todavía sin resultado
+    TBB_DRAWISH,                    // Sin resultado, pero tiene una jugada que sale de la tabla a tablas: no pierde
+    TBB_INVALID,                    // El índice no corresponde a una posición legal en forma canónica
+    TBB_DRAW,
+    TBB_WIN,
+    TBB_LOSS
+};
+
+// Tipo de jugada según a dónde lleva
+enum {
+    CHILD_INTERNAL,                 // A otra posición de la tabla
+    CHILD_PAWN,                     // Movimiento de peón sin coronar (interno en la primera pasada)
+    CHILD_EXIT                      // Captura o coronación: a otra tabla
+};
+
+enum { TASK_CLASSIFY, TASK_PROPAGATE };
+
+typedef struct {
+    tb_position_t pos;
+    int kind;
+} tbb_child_t;
+
+typedef struct {
+    tb_material_t material;
+    atomic_uchar *state;
+    atomic_uchar *count;            // Jugadas internas (sucesoras distintas) que todavía no se sabe que pierden
+    atomic_ushort *dtz;
+    uint8_t *wdl1;                  // Resultado de la primera pasada con peones (0 = pierde, 1 = tablas, 2 = gana)
+    int pass;                       // 1 = los avances de peón quedan dentro de la tabla, 2 = salen de la tabla
+    int task;
+    int level;                      // Distancia que se está propagando
+    int threads;
+    atomic_uint_fast64_t next;      // Próximo bloque de posiciones a repartir
+    atomic_uint_fast64_t resolved;  // Posiciones resueltas por la tarea en curso
+    atomic_bool missing;            // Faltó una tabla menor
+} tbb_builder_t;
+
+// Tablas ya disponibles durante una ejecución de tb_builder_run
+static uint64_t done_keys[TBB_MAX_DONE];
+static int done_count = 0;
+
+void tb_builder_default_options(tb_builder_options_t *options) {
+    options->material = NULL;
+    options->dir = TB_DEFAULT_DIR;
+    options->threads = 0;
+}
+
+static inline int to_0x88(int square) {
+    return SQUARE(square >> 3, square & 7);
+}
+
+static inline int to_64(int square) {
+    return RANK(square) * 8 + FILE(square);
+}
+
+// Coloca (o quita) las piezas de una posición en el tablero auxiliar
+static void place_pieces(gamestate_t *board, const tb_position_t *pos, bool place) {
+    for (int i = 0; i < pos->count; i++) {
+        int sq = to_0x88(pos->square[i]);
+        board->board[sq] = place ? pos->piece[i] : EMPTY;
+        if (place && PIECE_TYPE(pos->piece[i]) == KING) board->king_square[COLOR(pos->piece[i])] = sq;
+    }
+    board->to_move = pos->to_move;
+}
+
+/**
+ * Mueve una pieza en el tablero auxiliar y verifica si el rey de 'color' queda atacado por el rival.
+ * Deja el tablero como estaba.
+ */
+static bool king_attacked_after(gamestate_t *board, int from, int to, int piece_after, int color) {
+    int moved = board->board[from], captured = board->board[to];
+    int king = board->king_square[COLOR(moved)];
+    board->board[from] = EMPTY;
+    board->board[to] = piece_after;
+    if (PIECE_TYPE(moved) == KING) board->king_square[COLOR(moved)] = to;
+    bool attacked = is_square_attacked(board, board->king_square[color], 1 - color);
+    board->board[to] = captured;
+    board->board[from] = moved;
+    board->king_square[COLOR(moved)] = king;
+    return attacked;
+}
+
+// Casillas en la misma fila, columna o diagonal (una pieza que no está alineada con su rey no puede estar clavada)
+static inline bool aligned(int a, int b) {
+    int files = FILE(a) - FILE(b), ranks = RANK(a) - RANK(b);
+    return files == 0 || ranks == 0 || files == ranks || files == -ranks;
+}
+
+/**
+ * Agrega la posición que resulta de mover la pieza 'index' (si la jugada es legal).
+ * @param in_check: el bando que mueve está en jaque (si no lo está, solo se verifican las jugadas del rey y
+ *                  de las piezas alineadas con él).
+ */
+static void add_child(gamestate_t *board, const tb_position_t *pos, int index, int to, int promotion, bool in_check,
+                      tbb_child_t *children, int *count) {
+    int from = to_0x88(pos->square[index]);
+    int piece = pos->piece[index];
+    int piece_after = promotion ? MAKE_PIECE(promotion, COLOR(piece)) : piece;
+    int captured = board->board[to];
+    if ((in_check || PIECE_TYPE(piece) == KING || aligned(from, board->king_square[COLOR(piece)])) &&
+        king_attacked_after(board, from, to, piece_after, COLOR(piece))) {
+        return;
+    }
+
+    tbb_child_t *child = &children[(*count)++];
+    child->pos = *pos;
+    child->pos.to_move = 1 - pos->to_move;
+    child->pos.piece[index] = piece_after;
+    child->pos.square[index] = to_64(to);
+    if (captured != EMPTY) {
+        for (int i = 0; i < pos->count; i++) {
+            if (to_0x88(pos->square[i]) != to || i == index) continue;
+            for (int j = i; j < pos->count - 1; j++) {
+                child->pos.piece[j] = child->pos.piece[j + 1];
+                child->pos.square[j] = child->pos.square[j + 1];
+            }
+            child->pos.count--;
+            break;
+        }
+    }
+    child->kind = captured != EMPTY || promotion ? CHILD_EXIT : PIECE_TYPE(piece) == PAWN ? CHILD_PAWN : CHILD_INTERNAL;
+}
+
+static void add_pawn_child(gamestate_t *board, const tb_position_t *pos, int index, int to, bool in_check,
+                           tbb_child_t *children, int *count) {
+    if (RANK(to) == 0 || RANK(to) == 7) {
+        for (int promotion = QUEEN; promotion >= KNIGHT; promotion--) {
+            add_child(board, pos, index, to, promotion, in_check, children, count);
+        }
+    } else {
+        add_child(board, pos, index, to, 0, in_check, children, count);
+    }
+}
+
+// Jugadas legales del bando que mueve (sin enroques ni capturas al paso)
+static int generate_children(gamestate_t *board, const tb_position_t *pos, bool in_check, tbb_child_t *children) {
+    int count = 0;
+    int color = pos->to_move;
+    for (int i = 0; i < pos->count; i++) {
+        int piece = pos->piece[i];
+        if (COLOR(piece) != color) continue;
+        int from = to_0x88(pos->square[i]);
+        int type = PIECE_TYPE(piece);
+
+        if (type == PAWN) {
+            int dir = color == WHITE ? 16 : -16;
+            if (board->board[from + dir] == EMPTY) {
+                add_pawn_child(board, pos, i, from + dir, in_check, children, &count);
+                int start_rank = color == WHITE ? 1 : 6;
+                if (RANK(from) == start_rank && board->board[from + 2 * dir] == EMPTY) {
+                    add_child(board, pos, i, from + 2 * dir, 0, in_check, children, &count);
+                }
+            }
+            for (int side = -1; side <= 1; side += 2) {
+                int to = from + dir + side;
+                if (!IS_VALID_SQUARE(to)) continue;
+                int target = board->board[to];
+                if (target != EMPTY && COLOR(target) != color && PIECE_TYPE(target) != KING) {
+                    add_pawn_child(board, pos, i, to, in_check, children, &count);
+                }
+            }
+        } else if (type == KNIGHT || type == KING) {
+            int *offsets = type == KNIGHT ? knight_moves : king_moves;
+            for (int d = 0; d < 8; d++) {
+                int to = from + offsets[d];
+                if (!IS_VALID_SQUARE(to)) continue;
+                int target = board->board[to];
+                if (target == EMPTY || (COLOR(target) != color && PIECE_TYPE(target) != KING)) {
+                    add_child(board, pos, i, to, 0, in_check, children, &count);
+                }
+            }
+        } else {
+            for (int d = 0; d < 8; d++) {
+                int dir = d < 4 ? rook_dirs[d] : bishop_dirs[d - 4];
+                if ((d < 4 && type == BISHOP) || (d >= 4 && type == ROOK)) continue;
+                for (int to = from + dir; IS_VALID_SQUARE(to); to += dir) {
+                    int target = board->board[to];
+                    if (target == EMPTY || (COLOR(target) != color && PIECE_TYPE(target) != KING)) {
+                        add_child(board, pos, i, to, 0, in_check, children, &count);
+                    }
+                    if (target != EMPTY) break;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+// Agrega un índice a una lista si todavía no está
+static bool add_distinct(uint64_t *list, int *count, uint64_t index) {
+    for (int i = 0; i < *count; i++) {
+        if (list[i] == index) return false;
+    }
+    list[(*count)++] = index;
+    return true;
+}
+
+// Resultado inicial de una posición: mate, ahogado, jugadas que salen de la tabla y cantidad de jugadas internas
+static void classify_position(tbb_builder_t *b, gamestate_t *board, uint64_t index) {
+    tb_position_t pos;
+    tb_decode(&b->material, index, &pos);
+    for (int i = 0; i < pos.count; i++) {
+        for (int j = 0; j < i; j++) {
+            if (pos.square[i] == pos.square[j]) {
+                atomic_store_explicit(&b->state[index], TBB_INVALID, memory_order_relaxed);
+                return;
+            }
+        }
+    }
+    if (tb_index(&b->material, &pos) != (int64_t)index) {
+        atomic_store_explicit(&b->state[index], TBB_INVALID, memory_order_relaxed);
+        return;
+    }
+    place_pieces(board, &pos, true);
+    // El bando que no mueve no puede estar en jaque (esto también descarta los reyes vecinos)
+    if (is_square_attacked(board, board->king_square[1 - pos.to_move], pos.to_move)) {
+        place_pieces(board, &pos, false);
+        atomic_store_explicit(&b->state[index], TBB_INVALID, memory_order_relaxed);
+        return;
+    }
+
+    tbb_child_t children[TBB_MAX_CHILDREN];
+    bool in_check = is_square_attacked(board, board->king_square[pos.to_move], 1 - pos.to_move);
+    int child_count = generate_children(board, &pos, in_check, children);
+    place_pieces(board, &pos, false);
+
+    int state, dtz = -1;
+    if (child_count == 0) {
+        state = in_check ? TBB_LOSS : TBB_DRAW;
+        if (in_check) dtz = 0;
+    } else {
+        int best_exit = TB_LOSS - 1;
+        uint64_t internal[TBB_MAX_CHILDREN];
+        int internal_count = 0;
+        for (int c = 0; c < child_count; c++) {
+            int value;
+            if (children[c].kind == CHILD_EXIT) {
+                int wdl;
+                if (!tb_probe_position(&children[c].pos, &wdl, NULL)) {
+                    atomic_store(&b->missing, true);
+                    wdl = TB_DRAW;
+                }
+                value = -wdl;
+            } else if (children[c].kind == CHILD_PAWN && b->pass == 2) {
+                value = 1 - b->wdl1[tb_index(&b->material, &children[c].pos)];
+            } else {
+                add_distinct(internal, &internal_count, (uint64_t)tb_index(&b->material, &children[c].pos));
+                continue;
+            }
+            if (value > best_exit) best_exit = value;
+        }
+        atomic_store_explicit(&b->count[index], (unsigned char)internal_count, memory_order_relaxed);
+        if (best_exit == TB_WIN) {
+            state = TBB_WIN;
+            dtz = 1;
+        } else if (internal_count == 0) {
+            state = best_exit == TB_DRAW ? TBB_DRAW : TBB_LOSS;
+            if (state == TBB_LOSS) dtz = 1;
+        } else {
+            state = best_exit == TB_DRAW ? TBB_DRAWISH : TBB_UNKNOWN;
+        }
+    }
+    if (dtz >= 0) atomic_store_explicit(&b->dtz[index], (unsigned short)dtz, memory_order_relaxed);
+    atomic_store_explicit(&b->state[index], (unsigned char)state, memory_order_relaxed);
+}
+
+/**
+ * Agrega la posición anterior con la pieza 'index' en 'from' (si es legal).
+ * @param in_check: el bando que mueve está en jaque en esta posición (si no lo está, en la anterior solo puede
+ *                  estar en jaque por la pieza que se mueve o por una línea que pasa por la casilla que deja).
+ */
+static void add_parent(tbb_builder_t *b, gamestate_t *board, const tb_position_t *pos, int index, int from, bool in_check,
+                       uint64_t *parents, int *count) {
+    int to = to_0x88(pos->square[index]);
+    int piece = pos->piece[index];
+    int king = board->king_square[pos->to_move];
+    // En la posición anterior el que no mueve es el que mueve ahora: no puede estar en jaque
+    if ((in_check || PIECE_TYPE(piece) == KNIGHT || aligned(from, king) || aligned(to, king)) &&
+        king_attacked_after(board, to, from, piece, pos->to_move)) {
+        return;
+    }
+    tb_position_t parent = *pos;
+    parent.square[index] = to_64(from);
+    parent.to_move = 1 - pos->to_move;
+    add_distinct(parents, count, (uint64_t)tb_index(&b->material, &parent));
+}
+
+// Posiciones de la tabla desde las que se llega a esta con una jugada interna
+static int generate_parents(tbb_builder_t *b, gamestate_t *board, const tb_position_t *pos, uint64_t *parents) {
+    int count = 0;
+    int color = 1 - pos->to_move;
+    bool in_check = is_square_attacked(board, board->king_square[pos->to_move], color);
+    for (int i = 0; i < pos->count; i++) {
+        int piece = pos->piece[i];
+        if (COLOR(piece) != color) continue;
+        int sq = to_0x88(pos->square[i]);
+        int type = PIECE_TYPE(piece);
+
+        if (type == PAWN) {
+            if (b->pass != 1) continue;
+            int dir = color == WHITE ? -16 : 16;
+            int from = sq + dir;
+            int first_rank = color == WHITE ? 0 : 7;
+            if (board->board[from] != EMPTY || RANK(from) == first_rank) continue;
+            add_parent(b, board, pos, i, from, in_check, parents, &count);
+            int double_rank = color == WHITE ? 3 : 4;
+            if (RANK(sq) == double_rank && board->board[from + dir] == EMPTY) {
+                add_parent(b, board, pos, i, from + dir, in_check, parents, &count);
+            }
+        } else if (type == KNIGHT || type == KING) {
+            int *offsets = type == KNIGHT ? knight_moves : king_moves;
+            for (int d = 0; d < 8; d++) {
+                int from = sq + offsets[d];
+                if (IS_VALID_SQUARE(from) && board->board[from] == EMPTY) add_parent(b, board, pos, i, from, in_check, parents, &count);
+            }
+        } else {
+            for (int d = 0; d < 8; d++) {
+                int dir = d < 4 ? rook_dirs[d] : bishop_dirs[d - 4];
+                if ((d < 4 && type == BISHOP) || (d >= 4 && type == ROOK)) continue;
+                for (int from = sq + dir; IS_VALID_SQUARE(from) && board->board[from] == EMPTY; from += dir) {
+                    add_parent(b, board, pos, i, from, in_check, parents, &count);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * Propaga un resultado a distancia b->level hacia las posiciones anteriores: si esta pierde, las anteriores
+ * ganan; si gana, las anteriores descuentan una jugada y pierden cuando ya no les queda ninguna.
+ */
+static void propagate_position(tbb_builder_t *b, gamestate_t *board, uint64_t index) {
+    int state = atomic_load_explicit(&b->state[index], memory_order_relaxed);
+    if ((state != TBB_WIN && state != TBB_LOSS) ||
+        atomic_load_explicit(&b->dtz[index], memory_order_relaxed) != b->level) {
+        return;
+    }
+    tb_position_t pos;
+    tb_decode(&b->material, index, &pos);
+    place_pieces(board, &pos, true);
+    uint64_t parents[TBB_MAX_CHILDREN];
+    int parent_count = generate_parents(b, board, &pos, parents);
+    place_pieces(board, &pos, false);
+
+    unsigned short dtz = (unsigned short)(b->level + 1);
+    for (int p = 0; p < parent_count; p++) {
+        uint64_t parent = parents[p];
+        unsigned char current = atomic_load_explicit(&b->state[parent], memory_order_relaxed);
+        if (current != TBB_UNKNOWN && current != TBB_DRAWISH) continue;
+        if (state == TBB_LOSS) {
+            // Las dos escrituras posibles de la distancia en este nivel tienen el mismo valor
+            atomic_store_explicit(&b->dtz[parent], dtz, memory_order_relaxed);
+            while ((current == TBB_UNKNOWN || current == TBB_DRAWISH) &&
+                   !atomic_compare_exchange_weak(&b->state[parent], &current, TBB_WIN)) {
+            }
+            if (current == TBB_UNKNOWN || current == TBB_DRAWISH) atomic_fetch_add(&b->resolved, 1);
+        } else if (atomic_fetch_sub(&b->count[parent], 1) == 1 && current == TBB_UNKNOWN) {
+            atomic_store_explicit(&b->dtz[parent], dtz, memory_order_relaxed);
+            unsigned char expected = TBB_UNKNOWN;
+            if (atomic_compare_exchange_strong(&b->state[parent], &expected, TBB_LOSS)) atomic_fetch_add(&b->resolved, 1);
+        }
+    }
+}
+
+static void *worker_main(void *arg) {
+    tbb_builder_t *b = arg;
+    gamestate_t *board = calloc(1, sizeof(gamestate_t));
+    if (!board) {
+        atomic_store(&b->missing, true);
+        return NULL;
+    }
+    board->en_passant_square = -1;
+    for (;;) {
+        uint64_t start = atomic_fetch_add(&b->next, 1) * TBB_CHUNK;
+        if (start >= b->material.size) break;
+        uint64_t end = start + TBB_CHUNK < b->material.size ? start + TBB_CHUNK : b->material.size;
+        for (uint64_t index = start; index < end; index++) {
+            if (b->task == TASK_CLASSIFY) classify_position(b, board, index);
+            else propagate_position(b, board, index);
+        }
+    }
+    free(board);
+    return NULL;
+}
+
+// Ejecuta la tarea en curso sobre todas las posiciones, repartidas entre los hilos
+static void run_task(tbb_builder_t *b, int task) {
+    pthread_t thread_ids[TBB_MAX_THREADS];
+    b->task = task;
+    atomic_store(&b->next, 0);
+    atomic_store(&b->resolved, 0);
+    // Si no se puede crear un hilo, los demás (y el actual) toman sus posiciones del contador compartido
+    int started = 0;
+    for (int t = 1; t < b->threads; t++) {
+        if (pthread_create(&thread_ids[started], NULL, worker_main, b) == 0) started++;
+    }
+    worker_main(b);
+    for (int t = 0; t < started; t++) pthread_join(thread_ids[t], NULL);
+}
+
+// Una pasada completa: clasificación y propagación por niveles hasta que ningún nivel resuelve posiciones
+static int solve(tbb_builder_t *b, int pass) {
+    b->pass = pass;
+    for (uint64_t i = 0; i < b->material.size; i++) atomic_init(&b->dtz[i], 0xFFFF);
+    run_task(b, TASK_CLASSIFY);
+    // La clasificación deja posiciones en los niveles 0 (mates) y 1 (salidas ganadoras o todas perdedoras)
+    int level = 0;
+    for (;; level++) {
+        b->level = level;
+        run_task(b, TASK_PROPAGATE);
+        if (atomic_load(&b->resolved) == 0 && level >= 1) break;
+    }
+    return level;
+}
+
+// Buffer de bytes que crece según se necesita
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} tbb_buffer_t;
+
+static bool buffer_put(tbb_buffer_t *buffer, const void *bytes, size_t size) {
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : 65536;
+        while (capacity < buffer->size + size) capacity *= 2;
+        uint8_t *data = realloc(buffer->data, capacity);
+        if (!data) return false;
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, bytes, size);
+    buffer->size += size;
+    return true;
+}
+
+static void put_u32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(value >> (8 * i));
+}
+
+static void put_u64(uint8_t *p, uint64_t value) {
+    put_u32(p, (uint32_t)value);
+    put_u32(p + 4, (uint32_t)(value >> 32));
+}
+
+// Escribe una secuencia de valores iguales: valor y largo en bytes de 7 bits
+static bool put_run(tbb_buffer_t *buffer, unsigned value, int value_bytes, uint32_t length) {
+    uint8_t bytes[8];
+    int size = 0;
+    bytes[size++] = (uint8_t)value;
+    if (value_bytes == 2) bytes[size++] = (uint8_t)(value >> 8);
+    do {
+        bytes[size++] = (uint8_t)((length & 127) | (length > 127 ? 128 : 0));
+        length >>= 7;
+    } while (length);
+    return buffer_put(buffer, bytes, (size_t)size);
+}
+
+// Valor a guardar de una posición: las que no importan repiten el anterior para alargar las secuencias
+static unsigned section_value(const tbb_builder_t *b, uint64_t index, bool dtz, unsigned previous) {
+    int state = atomic_load_explicit(&b->state[index], memory_order_relaxed);
+    if (state == TBB_INVALID) return previous;
+    if (!dtz) return state == TBB_WIN ? 2 : state == TBB_LOSS ? 0 : 1;
+    return state == TBB_WIN || state == TBB_LOSS ? atomic_load_explicit(&b->dtz[index], memory_order_relaxed) : previous;
+}
+
+// Sección comprimida: desplazamientos de los bloques y bloques con largo de secuencias
+static bool build_section(const tbb_builder_t *b, bool dtz, uint32_t block_count, tbb_buffer_t *section) {
+    size_t offsets_size = ((size_t)block_count + 1) * 4;
+    tbb_buffer_t data = {0};
+    uint8_t *offsets = calloc(offsets_size, 1);
+    bool ok = offsets != NULL;
+    unsigned previous = dtz ? 0 : 1;
+    for (uint32_t block = 0; block < block_count && ok; block++) {
+        put_u32(offsets + 4 * (size_t)block, (uint32_t)data.size);
+        uint64_t start = (uint64_t)block * TB_BLOCK_SIZE;
+        uint64_t end = start + TB_BLOCK_SIZE < b->material.size ? start + TB_BLOCK_SIZE : b->material.size;
+        unsigned run_value = section_value(b, start, dtz, previous);
+        uint32_t run_length = 0;
+        for (uint64_t index = start; index < end && ok; index++) {
+            unsigned value = section_value(b, index, dtz, previous);
+            if (value != run_value) {
+                ok = put_run(&data, run_value, dtz ? 2 : 1, run_length);
+                run_value = value;
+                run_length = 0;
+            }
+            run_length++;
+            previous = value;
+        }
+        if (ok) ok = put_run(&data, run_value, dtz ? 2 : 1, run_length);
+    }
+    if (ok) {
+        put_u32(offsets + 4 * (size_t)block_count, (uint32_t)data.size);
+        ok = data.size <= UINT32_MAX && buffer_put(section, offsets, offsets_size) && buffer_put(section, data.data, data.size);
+    }
+    free(offsets);
+    free(data.data);
+    return ok;
+}
+
+// Escribe la tabla (primero a un archivo temporal, así una tabla a medio escribir nunca queda con su nombre)
+static bool write_table(const tbb_builder_t *b, const char *path, size_t *file_size) {
+    uint32_t block_count = (uint32_t)((b->material.size + TB_BLOCK_SIZE - 1) / TB_BLOCK_SIZE);
+    tbb_buffer_t wdl = {0}, dtz = {0};
+    bool ok = build_section(b, false, block_count, &wdl) && build_section(b, true, block_count, &dtz);
+
+    uint8_t header[TB_HEADER_SIZE] = {0};
+    memcpy(header, "FTB1", 4);
+    put_u32(header + 4, TB_VERSION);
+    memcpy(header + 8, b->material.name, strlen(b->material.name));
+    put_u64(header + 24, b->material.size);
+    put_u32(header + 32, TB_BLOCK_SIZE);
+    put_u32(header + 36, block_count);
+    put_u64(header + 40, TB_HEADER_SIZE);
+    put_u64(header + 48, TB_HEADER_SIZE + wdl.size);
+
+    char temp_path[1100];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE *f = ok ? fopen(temp_path, "wb") : NULL;
+    if (f) {
+        ok = fwrite(header, 1, sizeof(header), f) == sizeof(header) &&
+             fwrite(wdl.data, 1, wdl.size, f) == wdl.size &&
+             fwrite(dtz.data, 1, dtz.size, f) == dtz.size;
+        ok = fclose(f) == 0 && ok;
+        remove(path);
+        ok = ok && rename(temp_path, path) == 0;
+        if (!ok) remove(temp_path);
+    } else {
+        ok = false;
+    }
+    *file_size = sizeof(header) + wdl.size + dtz.size;
+    free(wdl.data);
+    free(dtz.data);
+    return ok;
+}
+
+// Genera una tabla (sus tablas menores ya tienen que estar cargadas)
+static bool generate_table(const tb_material_t *material, const char *path, int threads) {
+    int64_t start = platform_time_ms();
+    tbb_builder_t *b = calloc(1, sizeof(tbb_builder_t));
+    if (!b) return false;
+    b->material = *material;
+    b->threads = threads;
+    b->state = malloc(material->size * sizeof(atomic_uchar));
+    b->count = malloc(material->size * sizeof(atomic_uchar));
+    b->dtz = malloc(material->size * sizeof(atomic_ushort));
+    b->wdl1 = material->has_pawns ? malloc(material->size) : NULL;
+    bool ok = b->state && b->count && b->dtz && (b->wdl1 || !material->has_pawns);
+    if (!ok) fprintf(stderr, "[ TBGEN ] No hay memoria suficiente para %s (%" PRIu64 " posiciones)\n", material->name, material->size);
+
+    int levels = 0;
+    uint64_t mismatches = 0;
+    if (ok) {
+        levels = solve(b, 1);
+        if (material->has_pawns) {
+            for (uint64_t i = 0; i < material->size; i++) {
+                int state = atomic_load_explicit(&b->state[i], memory_order_relaxed);
+                b->wdl1[i] = state == TBB_WIN ? 2 : state == TBB_LOSS ? 0 : 1;
+            }
+            levels = solve(b, 2);
+            // Las dos pasadas tienen que coincidir en el resultado
+            for (uint64_t i = 0; i < material->size; i++) {
+                int state = atomic_load_explicit(&b->state[i], memory_order_relaxed);
+                if (state != TBB_INVALID && b->wdl1[i] != (state == TBB_WIN ? 2 : state == TBB_LOSS ? 0 : 1)) mismatches++;
+            }
+        }
+        if (atomic_load(&b->missing)) {
+            fprintf(stderr, "[ TBGEN ] Faltan tablas menores para %s\n", material->name);
+            ok = false;
+        }
+    }
+
+    size_t file_size = 0;
+    if (ok) {
+        uint64_t legal = 0, wins = 0, draws = 0, losses = 0;
+        int max_dtz = 0;
+        for (uint64_t i = 0; i < material->size; i++) {
+            int state = atomic_load_explicit(&b->state[i], memory_order_relaxed);
+            if (state == TBB_INVALID) continue;
+            legal++;
+            if (state == TBB_WIN || state == TBB_LOSS) {
+                int dtz = atomic_load_explicit(&b->dtz[i], memory_order_relaxed);
+                if (dtz > max_dtz) max_dtz = dtz;
+                if (state == TBB_WIN) wins++;
+                else losses++;
+            } else {
+                atomic_store_explicit(&b->state[i], TBB_DRAW, memory_order_relaxed);
+                draws++;
+            }
+        }
+        ok = write_table(b, path, &file_size);
+        if (!ok) fprintf(stderr, "[ TBGEN ] No se pudo escribir %s\n", path);
+        printf("[ TBGEN ] %s: %" PRIu64 " posiciones legales | Ganan: %" PRIu64 " | Tablas: %" PRIu64 " | Pierden: %" PRIu64
+               " | DTZ máximo: %d (%d niveles) | %.1f s | %.1f KB\n",
+               material->name, legal, wins, draws, losses, max_dtz, levels, (platform_time_ms() - start) / 1000.0,
+               file_size / 1024.0);
+        if (mismatches) fprintf(stderr, "[ TBGEN ] %s: %" PRIu64 " posiciones con resultados distintos entre pasadas\n",
+                                material->name, mismatches);
+    }
+    free(b->state);
+    free(b->count);
+    free(b->dtz);
+    free(b->wdl1);
+    free(b);
+    return ok;
+}
+
+// Carga la tabla si ya existe en la carpeta; si no, genera primero las tablas menores y después esta
+static bool ensure_table(const tb_material_t *material, const tb_builder_options_t *options, int threads) {
+    if (material->count <= 2) return true;
+    for (int i = 0; i < done_count; i++) {
+        if (done_keys[i] == material->key) return true;
+    }
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s%s", options->dir, material->name, TB_EXTENSION);
+    if (!tb_add_table(path)) {
+        for (int i = 0; i < material->count; i++) {
+            int type = PIECE_TYPE(material->piece[i]);
+            if (type == KING) continue;
+            int pieces[TB_MAX_PIECES];
+            tb_material_t sub;
+            // Captura de la pieza
+            int count = 0;
+            for (int j = 0; j < material->count; j++) {
+                if (j != i) pieces[count++] = material->piece[j];
+            }
+            if (!tb_material_from_pieces(pieces, count, &sub) || !ensure_table(&sub, options, threads)) return false;
+            // Coronación del peón
+            if (type != PAWN) continue;
+            memcpy(pieces, material->piece, sizeof(pieces));
+            for (int promotion = KNIGHT; promotion <= QUEEN; promotion++) {
+                pieces[i] = MAKE_PIECE(promotion, COLOR(material->piece[i]));
+                if (!tb_material_from_pieces(pieces, material->count, &sub) || !ensure_table(&sub, options, threads)) return false;
+            }
+        }
+        if (!generate_table(material, path, threads) || !tb_add_table(path)) return false;
+    }
+    if (done_count < TBB_MAX_DONE) done_keys[done_count++] = material->key;
+    return true;
+}
+
+/**
+ * Genera la tabla de options->material y las que necesita, salvo las que ya están en la carpeta.
+ * Deja cargadas en tablebase.h todas las tablas que usó.
+ * @return false si la firma no es válida o no se pudo generar o escribir alguna tabla.
+ */
+bool tb_builder_run(const tb_builder_options_t *options) {
+    tb_material_t material;
+    if (!options->material || !tb_parse_material(options->material, &material) || material.count < 3) {
+        fprintf(stderr, "[ TBGEN ] Firma inválida: %s (ej: KRPvKR, hasta %d piezas)\n",
+                options->material ? options->material : "", TB_MAX_PIECES);
+        return false;
+    }
+    if (!platform_make_dir(options->dir)) {
+        fprintf(stderr, "[ TBGEN ] No se pudo crear la carpeta %s\n", options->dir);
+        return false;
+    }
+    int threads = options->threads > 0 ? options->threads : platform_cpu_count();
+    if (threads > TBB_MAX_THREADS) threads = TBB_MAX_THREADS;
+    done_count = 0;
+    int64_t start = platform_time_ms();
+    bool ok = ensure_table(&material, options, threads);
+    if (ok) printf("[ TBGEN ] Tablas listas en %s (%.1f s)\n", options->dir, (platform_time_ms() - start) / 1000.0);
+    return ok;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdbool.h>
+#include "tablebase.h"
+
+// Generador de tablas de finales por análisis retrógrado
+// https://www.chessprogramming.org/Retrograde_Analysis
+// Primero genera (o carga) las tablas a las que se llega con una captura o una coronación. Luego clasifica cada
+// posición de la tabla: mate, ahogado o jugadas que salen de la tabla (valoradas con las tablas menores) y cuenta
+// sus jugadas que quedan dentro. A partir de los mates se recorre hacia atrás por niveles de distancia: la
+// posición que llega a una derrota del rival gana, y la que ve que todas sus jugadas internas llevan a victorias
+// del rival (cuando su contador llega a cero) pierde. Lo que no se resuelve son tablas.
+// Con peones se hace en dos pasadas: la primera obtiene el resultado (los avances de peón quedan dentro de la
+// tabla) y la segunda la distancia hasta la próxima jugada que pone a cero la regla de 50 movimientos (los
+// movimientos de peón salen de la tabla con el resultado de la primera pasada).
+// Cada posición ocupa 4 bytes durante la generación (5 con peones): una tabla de 5 piezas necesita varios GB.
+
+typedef struct {
+    const char *material;           // Firma de la tabla, ej: "KRPvKR"
+    const char *dir;                // Carpeta donde se leen y escriben las tablas
+    int threads;                    // 0 = todos los núcleos
+} tb_builder_options_t;
+
+void tb_builder_default_options(tb_builder_options_t *options);
+bool tb_builder_run(const tb_builder_options_t *options);
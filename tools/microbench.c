@@ -0,0 +1,416 @@
+// Microbenchmarks de las funciones básicas de chess.c, zobrist.c y kpk.c
+// Es un ejecutable aparte (no forma parte de fortunachess). Compilar desde la raíz del proyecto con:
+//   gcc -O2 -I. tools/microbench.c chess.c nnue.c kpk.c zobrist.c stack.c stats.c platform.c -pthread -lm -o microbench
+// Uso: ./microbench [-reps N] [-time ms] [-filter nombre] [-epd posiciones.epd]
+//                   [-save base.txt] [-baseline base.txt] [-threshold %]
+// Cada función se ejecuta sobre un conjunto de posiciones: primero un calentamiento que también calibra cuántas
+// operaciones caben en una muestra de '-time' ms, y luego '-reps' muestras. Se informa la mediana de ns/op,
+// la desviación estándar entre muestras y (en x86) los ciclos por operación medidos con rdtsc.
+// Con -baseline se compara la mediana contra un archivo guardado con -save y se marcan las regresiones.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "chess.h"
+#include "zobrist.h"
+#include "kpk.h"
+#include "platform.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+static inline uint64_t read_cycles(void) { return __rdtsc(); }
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define HAVE_RDTSC 1
+static inline uint64_t read_cycles(void) { return __rdtsc(); }
+#else
+#define HAVE_RDTSC 0
+static inline uint64_t read_cycles(void) { return 0; }
+#endif
+
+#define MAX_POSITIONS 256
+#define MAX_REPS 101
+#define MAX_FEN 128
+#define MAX_BENCHES 16
+
+// Posiciones por defecto: apertura, medio juego, finales y posiciones con enroques, en passant y promociones
+static const char *default_positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+    "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 9",
+    "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+    "8/5pk1/6p1/8/3R4/6P1/5PKP/3r4 w - - 0 40",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+};
+
+typedef struct {
+    int count;
+    char fen[MAX_POSITIONS][MAX_FEN];
+    gamestate_t game[MAX_POSITIONS];
+    move_list_t moves[MAX_POSITIONS];   // Jugadas pseudo-legales de cada posición
+} corpus_t;
+
+// Cada función de benchmark ejecuta 'ops' operaciones y devuelve un valor que depende del resultado,
+// para que el compilador no pueda eliminar el trabajo
+typedef uint64_t (*bench_fn_t)(corpus_t *corpus, uint64_t ops);
+
+typedef struct {
+    const char *name;
+    bench_fn_t run;
+} microbench_t;
+
+typedef struct {
+    double median_ns;
+    double stddev_ns;
+    double cycles;
+} measurement_t;
+
+static volatile uint64_t sink;
+
+static uint64_t bench_generate_moves(corpus_t *corpus, uint64_t ops) {
+    uint64_t total = 0;
+    move_list_t list;
+    for (uint64_t i = 0; i < ops; i++) {
+        generate_moves(&corpus->game[i % corpus->count], &list);
+        total += list.count;
+    }
+    return total;
+}
+
+static uint64_t bench_is_square_attacked(corpus_t *corpus, uint64_t ops) {
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        gamestate_t *game = &corpus->game[(i / 64) % corpus->count];
+        int square = SQUARE((int)(i / 8) % 8, (int)i % 8);
+        total += is_square_attacked(game, square, game->to_move ^ BLACK);
+    }
+    return total;
+}
+
+static uint64_t bench_is_legal_move(corpus_t *corpus, uint64_t ops) {
+    uint64_t total = 0;
+    int position = 0, index = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        if (index >= corpus->moves[position].count) {
+            position = (position + 1) % corpus->count;
+            index = 0;
+            continue;
+        }
+        total += is_legal_move(&corpus->moves[position].moves[index++], &corpus->game[position]);
+    }
+    return total;
+}
+
+static uint64_t bench_make_unmake(corpus_t *corpus, uint64_t ops) {
+    uint64_t total = 0;
+    int position = 0, index = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        if (index >= corpus->moves[position].count) {
+            position = (position + 1) % corpus->count;
+            index = 0;
+            continue;
+        }
+        gamestate_t *game = &corpus->game[position];
+        move_t *move = &corpus->moves[position].moves[index++];
+        fast_undo_t undo_info;
+        prepare_fast_undo(game, move, &undo_info);
+        make_move(move, game, false);
+        total += game->key;
+        fast_unmake_move(game, move, &undo_info);
+    }
+    return total;
+}
+
+static uint64_t bench_init_board_fen(corpus_t *corpus, uint64_t ops) {
+    uint64_t total = 0;
+    gamestate_t game;
+    for (uint64_t i = 0; i < ops; i++) {
+        memset(&game, 0, sizeof(gamestate_t));
+        game.en_passant_square = -1;
+        init_board_fen(&game, corpus->fen[i % corpus->count]);
+        total += game.key;
+    }
+    return total;
+}
+
+static uint64_t bench_gamestate_to_fen(corpus_t *corpus, uint64_t ops) {
+    uint64_t total = 0;
+    char fen[MAX_FEN];
+    for (uint64_t i = 0; i < ops; i++) {
+        gamestate_to_fen(&corpus->game[i % corpus->count], fen);
+        total += (uint64_t)fen[0];
+    }
+    return total;
+}
+
+static uint64_t bench_polyglot_hash_position(corpus_t *corpus, uint64_t ops) {
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        total += polyglot_hash_position(&corpus->game[i % corpus->count]);
+    }
+    return total;
+}
+
+static uint64_t bench_polyglot_hash(corpus_t *corpus, uint64_t ops) {
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        total += polyglot_hash(corpus->fen[i % corpus->count]);
+    }
+    return total;
+}
+
+// Lo que paga la búsqueda en cada nodo para saber si la posición es KPK
+static uint64_t bench_kpk_find_pawn(corpus_t *corpus, uint64_t ops) {
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        total += (uint64_t)kpk_find_pawn(&corpus->game[i % corpus->count]);
+    }
+    return total;
+}
+
+// Consultas al bitbase sobre posiciones KPK con los reyes y el peón en casillas variadas (el bitbase se genera
+// durante el calentamiento)
+static uint64_t bench_kpk_probe(corpus_t *corpus, uint64_t ops) {
+    static gamestate_t positions[64];
+    static int pawns[64];
+    static bool ready = false;
+    (void)corpus;
+    if (!ready) {
+        for (int i = 0; i < 64; i++) {
+            gamestate_t *game = &positions[i];
+            memset(game, 0, sizeof(gamestate_t));
+            for (int sq = 0; sq < BOARD_SIZE; sq++) game->board[sq] = EMPTY;
+            int color = i & 1;
+            pawns[i] = SQUARE(1 + (i / 8) % 6, i % 8);
+            game->king_square[color] = SQUARE((i * 5) % 8, (i * 3) % 8);
+            game->king_square[1 - color] = SQUARE(7 - (i * 5) % 8, 7 - (i * 3) % 8);
+            if (game->king_square[color] == pawns[i] || game->king_square[1 - color] == pawns[i]) pawns[i] = SQUARE(3, 3);
+            game->board[pawns[i]] = MAKE_PIECE(PAWN, color);
+            game->board[game->king_square[color]] = MAKE_PIECE(KING, color);
+            game->board[game->king_square[1 - color]] = MAKE_PIECE(KING, 1 - color);
+            game->to_move = (i >> 1) & 1;
+        }
+        ready = true;
+    }
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < ops; i++) {
+        total += kpk_probe(&positions[i & 63], pawns[i & 63]);
+    }
+    return total;
+}
+
+static const microbench_t benches[] = {
+    {"generate_moves", bench_generate_moves},
+    {"is_square_attacked", bench_is_square_attacked},
+    {"is_legal_move", bench_is_legal_move},
+    {"make_unmake", bench_make_unmake},
+    {"init_board_fen", bench_init_board_fen},
+    {"gamestate_to_fen", bench_gamestate_to_fen},
+    {"polyglot_hash_position", bench_polyglot_hash_position},
+    {"polyglot_hash", bench_polyglot_hash},
+    {"kpk_find_pawn", bench_kpk_find_pawn},
+    {"kpk_probe", bench_kpk_probe},
+};
+
+// Agrega una posición al corpus (acepta FEN completo o EPD con operaciones después de los 4 campos)
+static bool corpus_add(corpus_t *corpus, const char *line) {
+    if (corpus->count == MAX_POSITIONS) return false;
+    char fen[MAX_FEN];
+    int len = 0, fields = 0;
+    const char *p = line;
+    while (fields < 6) {
+        while (*p == ' ' || *p == '\t') p++;
+        const char *start = p;
+        while (*p && !isspace((unsigned char)*p) && *p != ';') p++;
+        int token_len = (int)(p - start);
+        if (token_len == 0) break;
+        // Los contadores de jugadas son opcionales: un token no numérico es una operación EPD
+        if (fields >= 4 && !isdigit((unsigned char)*start)) break;
+        if (len + token_len + 2 >= MAX_FEN) return false;
+        if (fields > 0) fen[len++] = ' ';
+        memcpy(fen + len, start, token_len);
+        len += token_len;
+        fields++;
+    }
+    fen[len] = '\0';
+    if (fields < 4) return false;
+
+    gamestate_t *game = &corpus->game[corpus->count];
+    memset(game, 0, sizeof(gamestate_t));
+    game->en_passant_square = -1;
+    if (init_board_fen(game, fen) != 0) return false;
+    snprintf(corpus->fen[corpus->count], MAX_FEN, "%s", fen);
+    generate_moves(game, &corpus->moves[corpus->count]);
+    corpus->count++;
+    return true;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Calentamiento + calibración: se duplica la cantidad de operaciones hasta que una muestra dure lo pedido
+static uint64_t calibrate(const microbench_t *bench, corpus_t *corpus, int64_t sample_ns) {
+    uint64_t ops = 64;
+    while (true) {
+        int64_t start = platform_time_ns();
+        sink += bench->run(corpus, ops);
+        int64_t elapsed = platform_time_ns() - start;
+        if (elapsed >= sample_ns || ops >= (1ULL << 34)) return ops;
+        ops = elapsed > sample_ns / 64 ? (uint64_t)((double)ops * sample_ns / elapsed) + 1 : ops * 8;
+    }
+}
+
+static measurement_t measure(const microbench_t *bench, corpus_t *corpus, int reps, int64_t sample_ns) {
+    uint64_t ops = calibrate(bench, corpus, sample_ns);
+    double samples[MAX_REPS];
+    double cycles[MAX_REPS];
+    for (int r = 0; r < reps; r++) {
+        uint64_t cycle_start = read_cycles();
+        int64_t start = platform_time_ns();
+        sink += bench->run(corpus, ops);
+        int64_t elapsed = platform_time_ns() - start;
+        uint64_t cycle_end = read_cycles();
+        samples[r] = (double)elapsed / ops;
+        cycles[r] = (double)(cycle_end - cycle_start) / ops;
+    }
+
+    double mean = 0;
+    for (int r = 0; r < reps; r++) mean += samples[r];
+    mean /= reps;
+    double variance = 0;
+    for (int r = 0; r < reps; r++) variance += (samples[r] - mean) * (samples[r] - mean);
+
+    measurement_t result;
+    result.stddev_ns = reps > 1 ? sqrt(variance / (reps - 1)) : 0;
+    qsort(samples, reps, sizeof(double), compare_double);
+    qsort(cycles, reps, sizeof(double), compare_double);
+    result.median_ns = samples[reps / 2];
+    result.cycles = cycles[reps / 2];
+    return result;
+}
+
+// Busca el valor guardado para una función en el archivo de referencia (formato: "<nombre> <ns/op>")
+static bool baseline_lookup(const char *path, const char *name, double *value) {
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    char line_name[64];
+    double line_value;
+    bool found = false;
+    while (fscanf(file, "%63s %lf", line_name, &line_value) == 2) {
+        if (strcmp(line_name, name) == 0) {
+            *value = line_value;
+            found = true;
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+int main(int argc, char *argv[]) {
+    int reps = 15;
+    int64_t sample_ms = 20;
+    double threshold = 5.0;
+    const char *filter = NULL;
+    const char *epd_path = NULL;
+    const char *save_path = NULL;
+    const char *baseline_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-time") == 0 && i + 1 < argc) {
+            sample_ms = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "-epd") == 0 && i + 1 < argc) {
+            epd_path = argv[++i];
+        } else if (strcmp(argv[i], "-save") == 0 && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (strcmp(argv[i], "-baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else {
+            fprintf(stderr, "Uso: %s [-reps N] [-time ms] [-filter nombre] [-epd posiciones.epd] "
+                            "[-save base.txt] [-baseline base.txt] [-threshold %%]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1) reps = 1;
+    if (reps > MAX_REPS) reps = MAX_REPS;
+    if (sample_ms < 1) sample_ms = 1;
+
+    corpus_t *corpus = calloc(1, sizeof(corpus_t));
+    if (!corpus) return 1;
+    if (epd_path) {
+        FILE *file = fopen(epd_path, "r");
+        if (!file) {
+            perror("[ MICROBENCH ] Error al abrir el archivo de posiciones");
+            free(corpus);
+            return 1;
+        }
+        char line[1024];
+        while (fgets(line, sizeof(line), file) && corpus->count < MAX_POSITIONS) {
+            if (line[0] != '#') corpus_add(corpus, line);
+        }
+        fclose(file);
+    } else {
+        for (size_t i = 0; i < sizeof(default_positions) / sizeof(default_positions[0]); i++) {
+            corpus_add(corpus, default_positions[i]);
+        }
+    }
+    if (corpus->count == 0) {
+        fprintf(stderr, "[ MICROBENCH ] No hay posiciones válidas\n");
+        free(corpus);
+        return 1;
+    }
+
+    FILE *save = save_path ? fopen(save_path, "w") : NULL;
+    if (save_path && !save) {
+        perror("[ MICROBENCH ] Error al abrir el archivo de salida");
+        free(corpus);
+        return 1;
+    }
+
+    printf("[ MICROBENCH ] Posiciones: %d | Muestras: %d x %lld ms%s\n", corpus->count, reps, (long long)sample_ms,
+           HAVE_RDTSC ? " | ciclos con rdtsc" : "");
+    printf("%-24s %12s %10s %10s", "función", "ns/op", "desv.", "ciclos/op");
+    if (baseline_path) printf(" %12s %9s", "referencia", "cambio");
+    printf("\n");
+
+    int regressions = 0;
+    for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        const microbench_t *bench = &benches[b];
+        if (filter && !strstr(bench->name, filter)) continue;
+        measurement_t m = measure(bench, corpus, reps, sample_ms * 1000000);
+
+        printf("%-24s %12.2f %10.2f %10.1f", bench->name, m.median_ns, m.stddev_ns, m.cycles);
+        double reference;
+        if (baseline_path && baseline_lookup(baseline_path, bench->name, &reference) && reference > 0) {
+            double change = 100.0 * (m.median_ns - reference) / reference;
+            bool regressed = change > threshold;
+            regressions += regressed;
+            printf(" %12.2f %+8.1f%%%s", reference, change, regressed ? "  REGRESIÓN" : "");
+        }
+        printf("\n");
+        fflush(stdout);
+        if (save) fprintf(save, "%s %.4f\n", bench->name, m.median_ns);
+    }
+
+    if (save) fclose(save);
+    free(corpus);
+    if (baseline_path) {
+        printf("[ MICROBENCH ] Regresiones (más de %.1f%% más lento): %d\n", threshold, regressions);
+    }
+    return regressions > 0 ? 1 : 0;
+}
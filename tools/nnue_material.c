@@ -0,0 +1,62 @@
+// Genera una red NNUE de prueba que solo cuenta material (sin entrenamiento)
+// Es un ejecutable aparte (no forma parte de fortunachess). Compilar desde la raíz del proyecto con:
+//   gcc -O2 -I. tools/nnue_material.c nnue.c -o nnue_material
+// Uso: ./nnue_material [red.nnue]   (por defecto, fortuna.nnue)
+// Sirve para verificar la carga de pesos, la actualización incremental y la inferencia, y para medir la velocidad
+// de la evaluación con red contra la clásica. Su evaluación es solo el material, así que juega peor que la clásica.
+//
+// Construcción (material en unidades de 16 centipeones):
+// - Acumulador: las neuronas 0-3 suman el material propio (peones, piezas menores, torres, damas) y las 4-7 el del
+//   rival, en grupos separados para que ninguna pase de 127 con el material normal de una partida.
+// - Capa 1: con d = material propio - rival, las neuronas 0-3 valen min(max(d - 127k, 0), 127) y las 4-7 lo mismo
+//   con -d, así la suma de las primeras menos las segundas reproduce d sin recortes.
+// - Salida: 64 * d, que dividido por NNUE_OUTPUT_SCALE da 16 * d centipeones.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nnue.h"
+
+#define GROUPS 4
+#define UNIT_WEIGHT 64              // Peso de la capa 1 para que (64 * d) >> NNUE_L1_SHIFT = d
+
+// Valor de cada tipo de pieza (PEÓN..DAMA) en unidades de 16 centipeones, y su grupo en el acumulador
+static const int unit_values[5] = {6, 20, 21, 31, 56};
+static const int piece_group[5] = {0, 1, 1, 2, 3};
+
+int main(int argc, char *argv[]) {
+    const char *path = argc >= 2 ? argv[1] : NNUE_DEFAULT_FILE;
+    nnue_network_t *network = calloc(1, sizeof(nnue_network_t));
+    if (!network) return 1;
+
+    // Características: (color relativo * 6 + tipo - 1) * 64 + casilla; el rey no suma material
+    for (int relative_color = 0; relative_color < 2; relative_color++) {
+        for (int type = 0; type < 5; type++) {
+            int neuron = relative_color * GROUPS + piece_group[type];
+            for (int square = 0; square < 64; square++) {
+                network->ft_weights[(relative_color * 6 + type) * 64 + square][neuron] = (int16_t)unit_values[type];
+            }
+        }
+    }
+
+    // Solo se usa la perspectiva del jugador que mueve (la primera mitad de la entrada)
+    for (int k = 0; k < GROUPS; k++) {
+        for (int neuron = 0; neuron < 2 * GROUPS; neuron++) {
+            int sign = neuron < GROUPS ? 1 : -1;
+            network->l1_weights[k][neuron] = (int8_t)(sign * UNIT_WEIGHT);
+            network->l1_weights[GROUPS + k][neuron] = (int8_t)(-sign * UNIT_WEIGHT);
+        }
+        network->l1_bias[k] = -UNIT_WEIGHT * 127 * k;
+        network->l1_bias[GROUPS + k] = -UNIT_WEIGHT * 127 * k;
+        network->out_weights[k] = UNIT_WEIGHT;
+        network->out_weights[GROUPS + k] = -UNIT_WEIGHT;
+    }
+
+    bool ok = nnue_save(network, path);
+    free(network);
+    if (!ok) {
+        fprintf(stderr, "No se pudo escribir %s\n", path);
+        return 1;
+    }
+    printf("Red de material guardada en %s\n", path);
+    return 0;
+}
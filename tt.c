@@ -0,0 +1,140 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tt.h"
+
+// Formato de los datos (64 bits):
+// bits 0-15: jugada, bits 16-31: puntaje (int16), bits 32-39: profundidad, bits 40-41: cota, bits 42-49: edad
+static inline uint64_t pack_data(uint16_t move, int score, int depth, int bound, uint8_t age) {
+    return (uint64_t)move
+         | ((uint64_t)(uint16_t)(int16_t)score << 16)
+         | ((uint64_t)(uint8_t)depth << 32)
+         | ((uint64_t)(bound & 3) << 40)
+         | ((uint64_t)age << 42);
+}
+
+static inline void unpack_data(uint64_t data, tt_data_t *out) {
+    out->move = (uint16_t)(data & 0xFFFF);
+    out->score = (int16_t)((data >> 16) & 0xFFFF);
+    out->depth = (int)((data >> 32) & 0xFF);
+    out->bound = (int)((data >> 40) & 3);
+}
+
+static inline uint8_t data_age(uint64_t data) {
+    return (uint8_t)((data >> 42) & 0xFF);
+}
+
+/**
+ * Reserva la tabla con el tamaño indicado (se redondea hacia abajo a una potencia de 2 de buckets).
+ * @param tt: tabla a inicializar (si ya tenía memoria, se debe liberar antes con tt_free).
+ * @param mb: tamaño en megabytes.
+ * @return false si no hay memoria suficiente.
+ */
+bool tt_init(tt_t *tt, size_t mb) {
+    size_t bytes = (mb > 0 ? mb : 1) * 1024 * 1024;
+    size_t buckets = 1;
+    while (buckets * 2 * TT_BUCKET_SIZE * sizeof(tt_entry_t) <= bytes) buckets *= 2;
+
+    tt->entries = calloc(buckets * TT_BUCKET_SIZE, sizeof(tt_entry_t));
+    tt->bucket_count = tt->entries ? buckets : 0;
+    tt->age = 0;
+    return tt->entries != NULL;
+}
+
+void tt_free(tt_t *tt) {
+    free(tt->entries);
+    tt->entries = NULL;
+    tt->bucket_count = 0;
+}
+
+void tt_clear(tt_t *tt) {
+    if (tt->entries) memset(tt->entries, 0, tt->bucket_count * TT_BUCKET_SIZE * sizeof(tt_entry_t));
+    tt->age = 0;
+}
+
+// Se llama antes de cada búsqueda: las entradas de búsquedas anteriores pasan a tener menor prioridad
+void tt_new_search(tt_t *tt) {
+    if (tt) tt->age++;
+}
+
+static inline tt_entry_t* bucket_for(tt_t *tt, uint64_t key) {
+    return &tt->entries[(key & (tt->bucket_count - 1)) * TT_BUCKET_SIZE];
+}
+
+bool tt_probe(tt_t *tt, uint64_t key, tt_data_t *out) {
+    if (!tt || !tt->entries) return false;
+    tt_entry_t *bucket = bucket_for(tt, key);
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        uint64_t data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&bucket[i].check, memory_order_relaxed);
+        if ((check ^ data) == key && data != 0) {
+            unpack_data(data, out);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Guarda el resultado de una posición. Si la posición ya está en el bucket se sobrescribe;
+ * si no, se reemplaza la entrada menos valiosa (más antigua y de menor profundidad).
+ */
+void tt_store(tt_t *tt, uint64_t key, uint16_t move, int score, int depth, int bound) {
+    if (!tt || !tt->entries) return;
+    tt_entry_t *bucket = bucket_for(tt, key);
+    tt_entry_t *replace = &bucket[0];
+    int replace_value = 1 << 30;
+
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        uint64_t data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&bucket[i].check, memory_order_relaxed);
+        if ((check ^ data) == key && data != 0) {
+            // Misma posición: se conserva la jugada anterior si la nueva búsqueda no encontró ninguna
+            if (move == 0) move = (uint16_t)(data & 0xFFFF);
+            replace = &bucket[i];
+            break;
+        }
+        if (data == 0) {
+            replace = &bucket[i];
+            replace_value = -(1 << 30);
+            continue;
+        }
+        int age_diff = (uint8_t)(tt->age - data_age(data));
+        int value = (int)((data >> 32) & 0xFF) - 8 * age_diff;
+        if (value < replace_value) {
+            replace_value = value;
+            replace = &bucket[i];
+        }
+    }
+
+    uint64_t data = pack_data(move, score, depth, bound, tt->age);
+    atomic_store_explicit(&replace->check, key ^ data, memory_order_relaxed);
+    atomic_store_explicit(&replace->data, data, memory_order_relaxed);
+}
+
+// Uso de la tabla en permil (según UCI): se cuentan las entradas de esta búsqueda entre las primeras 1000
+int tt_hashfull(tt_t *tt) {
+    if (!tt || !tt->entries) return 0;
+    size_t total = tt->bucket_count * TT_BUCKET_SIZE;
+    size_t sample = total < 1000 ? total : 1000;
+    int used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        uint64_t data = atomic_load_explicit(&tt->entries[i].data, memory_order_relaxed);
+        if (data != 0 && data_age(data) == tt->age) used++;
+    }
+    return (int)(used * 1000 / sample);
+}
+
+// Casilla 0x88 -> índice 0..63
+static inline int square64(int square) {
+    return RANK(square) * 8 + FILE(square);
+}
+
+// bits 0-5: origen, bits 6-11: destino, bits 12-14: pieza de promoción. Nunca es 0 para una jugada real
+uint16_t tt_pack_move(const move_t *move) {
+    int promotion = move->flags == MOVE_PROMOTION ? move->promotion : 0;
+    return (uint16_t)(square64(move->from) | (square64(move->to) << 6) | (promotion << 12));
+}
+
+bool tt_move_matches(uint16_t packed, const move_t *move) {
+    return packed != 0 && packed == tt_pack_move(move);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "chess.h"
+
+// Tabla de transposición: guarda el resultado de posiciones ya buscadas (indexadas por su clave Zobrist)
+// https://www.chessprogramming.org/Transposition_Table
+// La tabla se comparte entre todos los hilos de búsqueda sin usar locks: cada entrada guarda
+// (clave XOR datos, datos), así que una entrada escrita a medias por otro hilo simplemente no coincide.
+// https://www.chessprogramming.org/Shared_Hash_Table#Lockless
+
+#define TT_DEFAULT_MB 16
+#define TT_BUCKET_SIZE 4            // Entradas por bucket (4 x 16 bytes = una línea de caché)
+
+// Tipo de cota del puntaje guardado
+#define TT_BOUND_NONE  0
+#define TT_BOUND_UPPER 1            // El puntaje real es <= score (ninguna jugada superó alpha)
+#define TT_BOUND_LOWER 2            // El puntaje real es >= score (corte beta)
+#define TT_BOUND_EXACT 3
+
+typedef struct {
+    atomic_uint_least64_t check;    // key ^ data
+    atomic_uint_least64_t data;
+} tt_entry_t;
+
+// Datos de una entrada ya decodificados
+typedef struct {
+    uint16_t move;                  // Jugada en formato tt_pack_move (0 = sin jugada)
+    int score;
+    int depth;
+    int bound;
+} tt_data_t;
+
+typedef struct {
+    tt_entry_t *entries;
+    size_t bucket_count;            // Potencia de 2
+    uint8_t age;                    // Se incrementa en cada búsqueda nueva, para reemplazar entradas antiguas
+} tt_t;
+
+bool tt_init(tt_t *tt, size_t mb);
+void tt_free(tt_t *tt);
+void tt_clear(tt_t *tt);
+void tt_new_search(tt_t *tt);
+bool tt_probe(tt_t *tt, uint64_t key, tt_data_t *out);
+void tt_store(tt_t *tt, uint64_t key, uint16_t move, int score, int depth, int bound);
+int tt_hashfull(tt_t *tt);
+// Conversión entre move_t y la jugada de 16 bits guardada en la tabla
+uint16_t tt_pack_move(const move_t *move);
+bool tt_move_matches(uint16_t packed, const move_t *move);
@@ -0,0 +1,514 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <inttypes.h>
+#include "tuner.h"
+#include "analysis.h"
+#include "platform.h"
+
+#define TUNER_BLOCK 4096            // Posiciones por bloque (unidad de reparto entre hilos)
+#define TUNER_LOAD_LINES 65536      // Líneas que se leen antes de repartirlas entre los hilos
+#define TUNER_MAX_PARAMS 64
+#define TUNER_MAX_THREADS 256
+#define TUNER_REPORT_EVERY 25       // Iteraciones entre cada línea de progreso
+
+// Encabezado de cada posición en memoria; le siguen term_count términos
+typedef struct {
+    uint8_t result;                 // 0 = ganan las negras, 1 = tablas, 2 = ganan las blancas
+    uint8_t phase;
+    uint8_t term_count;
+    uint8_t king_attackers[2];      // Por color atacante (ver eval_trace_t)
+    uint8_t king_hits[2];
+    uint8_t king_pieces[2][4];      // Caballos, alfiles, torres y damas que atacan la zona del rey
+} tuner_header_t;
+
+// Aporte de un parámetro a la evaluación de una posición
+typedef struct {
+    uint8_t index;                  // Índice del parámetro en tuner_model_t
+    int8_t coef;
+} tuner_term_t;
+
+// Posiciones cargadas: encabezados y términos seguidos en un solo arreglo de bytes
+typedef struct {
+    unsigned char *bytes;
+    size_t size;
+    size_t capacity;
+    size_t count;
+    size_t *blocks;                 // Posición en 'bytes' de la posición b * TUNER_BLOCK
+    size_t block_count;
+    size_t block_capacity;
+} tuner_data_t;
+
+// Parámetros ajustables en un solo vector (uno por cada valor de eval_param_info)
+typedef struct {
+    int count;
+    const eval_param_info_t *info[TUNER_MAX_PARAMS];
+    int element[TUNER_MAX_PARAMS];  // Índice del valor dentro de su grupo
+    double scale[TUNER_MAX_PARAMS]; // Factor fijo del término (ej: peso de movilidad de la búsqueda)
+    int king_index[4];              // Parámetro de las unidades de ataque de caballo, alfil, torre y dama
+} tuner_model_t;
+
+// Trabajo de un hilo: cargar un lote de líneas o calcular el error (y el gradiente) de un rango de bloques
+typedef struct {
+    const tuner_model_t *model;
+    const double *params;
+    // Carga
+    char (*lines)[TUNER_MAX_LINE];
+    int first_line;
+    int last_line;
+    tuner_data_t loaded;
+    size_t skipped;
+    double eval_error;              // Suma de |evaluación del modelo - evaluación del motor|
+    // Error y gradiente
+    const tuner_data_t *data;
+    size_t first_block;
+    size_t last_block;
+    double k;
+    bool gradient;
+    double loss;
+    double grad[TUNER_MAX_PARAMS];
+} tuner_job_t;
+
+void tuner_default_options(tuner_options_t *options) {
+    options->input_path = NULL;
+    options->output_path = EVAL_DEFAULT_PARAMS_FILE;
+    options->threads = 0;
+    options->iterations = TUNER_DEFAULT_ITERATIONS;
+    options->rate = TUNER_DEFAULT_RATE;
+}
+
+static void model_init(tuner_model_t *model, double *params) {
+    model->count = 0;
+    for (int i = 0; i < eval_param_info_count; i++) {
+        const eval_param_info_t *info = &eval_param_info[i];
+        const int *values = eval_param_values(&eval_params, info);
+        for (int k = 0; k < info->count && model->count < TUNER_MAX_PARAMS; k++) {
+            int index = model->count++;
+            model->info[index] = info;
+            model->element[index] = k;
+            model->scale[index] = info->offset == offsetof(eval_params_t, mobility) ? EVAL_DEFAULT_MOBILITY_WEIGHT / 4.0 : 1.0;
+            if (info->taper == EVAL_TAPER_KING) model->king_index[info->first + k - KNIGHT] = index;
+            params[index] = values[k];
+        }
+    }
+}
+
+// Peso de un parámetro según la fase de la posición
+static inline double taper_weight(const tuner_model_t *model, int index, double mg) {
+    switch (model->info[index]->taper) {
+        case EVAL_TAPER_MG: return model->scale[index] * mg;
+        case EVAL_TAPER_EG: return model->scale[index] * (1.0 - mg);
+        default: return model->scale[index];
+    }
+}
+
+/**
+ * Evaluación de una posición con el modelo (desde la perspectiva de las blancas).
+ * @param grad: si no es NULL, se le suma factor * derivada de la evaluación respecto de cada parámetro.
+ */
+static double model_evaluate(const tuner_model_t *model, const double *params, const tuner_header_t *header,
+                             const tuner_term_t *terms, double *grad, double factor) {
+    double mg = header->phase / (double)EVAL_PHASE_MAX;
+    double score = 0;
+    for (int t = 0; t < header->term_count; t++) {
+        double weight = terms[t].coef * taper_weight(model, terms[t].index, mg);
+        score += weight * params[terms[t].index];
+        if (grad) grad[terms[t].index] += factor * weight;
+    }
+
+    // Seguridad del rey: min(unidades^2 / 2, máximo) con al menos dos atacantes, escalado por la fase
+    for (int color = WHITE; color <= BLACK; color++) {
+        if (header->king_attackers[color] < 2) continue;
+        double sign = color == WHITE ? 1.0 : -1.0;
+        double units = header->king_hits[color];
+        for (int p = 0; p < 4; p++) units += header->king_pieces[color][p] * params[model->king_index[p]];
+        double danger = units * units / 2;
+        if (danger >= EVAL_KING_DANGER_MAX) {
+            score += sign * EVAL_KING_DANGER_MAX * mg;
+            continue;
+        }
+        score += sign * danger * mg;
+        if (grad) {
+            for (int p = 0; p < 4; p++) grad[model->king_index[p]] += factor * sign * units * header->king_pieces[color][p] * mg;
+        }
+    }
+    return score;
+}
+
+// Resultado de la partida: "1-0", "0-1", "1/2-1/2" o [1.0], [0.5], [0.0] después de los campos del FEN
+static bool parse_result(const char *line, int *result) {
+    const char *p = line;
+    for (int field = 0; field < 4; field++) {
+        while (*p == ' ' || *p == '\t') p++;
+        while (*p && *p != ' ' && *p != '\t') p++;
+    }
+    const char *bracket = strchr(p, '[');
+    if (strstr(p, "1/2")) *result = 1;
+    else if (strstr(p, "1-0")) *result = 2;
+    else if (strstr(p, "0-1")) *result = 0;
+    else if (bracket) {
+        double value = atof(bracket + 1);
+        *result = value > 0.75 ? 2 : value > 0.25 ? 1 : 0;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Posición legal y tranquila: sin jaque y sin capturas que ganen material a simple vista ni promociones
+static bool is_quiet(gamestate_t *game) {
+    if (is_in_check(game, game->to_move) || is_in_check(game, 1 - game->to_move)) return false;
+    move_list_t moves;
+    generate_moves(game, &moves);
+    for (int i = 0; i < moves.count; i++) {
+        const move_t *move = &moves.moves[i];
+        if (move->flags == MOVE_PROMOTION) return false;
+        if (move->captured == EMPTY) continue;
+        int victim = eval_params.piece_values[PIECE_TYPE(move->captured)];
+        int attacker = eval_params.piece_values[PIECE_TYPE(move->piece)];
+        if (victim > attacker || !is_square_attacked(game, move->to, 1 - game->to_move)) return false;
+    }
+    return true;
+}
+
+static bool data_reserve(tuner_data_t *data, size_t bytes) {
+    if (data->size + bytes <= data->capacity) return true;
+    size_t capacity = data->capacity ? data->capacity : 1 << 20;
+    while (capacity < data->size + bytes) capacity *= 2;
+    unsigned char *grown = realloc(data->bytes, capacity);
+    if (!grown) return false;
+    data->bytes = grown;
+    data->capacity = capacity;
+    return true;
+}
+
+// Agrega una posición (encabezado y términos) y anota dónde empieza cada bloque
+static bool data_append(tuner_data_t *data, const unsigned char *entry, size_t bytes) {
+    if (data->count % TUNER_BLOCK == 0) {
+        if (data->block_count == data->block_capacity) {
+            size_t capacity = data->block_capacity ? data->block_capacity * 2 : 256;
+            size_t *grown = realloc(data->blocks, capacity * sizeof(size_t));
+            if (!grown) return false;
+            data->blocks = grown;
+            data->block_capacity = capacity;
+        }
+        data->blocks[data->block_count++] = data->size;
+    }
+    if (!data_reserve(data, bytes)) return false;
+    memcpy(data->bytes + data->size, entry, bytes);
+    data->size += bytes;
+    data->count++;
+    return true;
+}
+
+static void data_free(tuner_data_t *data) {
+    free(data->bytes);
+    free(data->blocks);
+    memset(data, 0, sizeof(tuner_data_t));
+}
+
+static inline size_t entry_size(const tuner_header_t *header) {
+    return sizeof(tuner_header_t) + header->term_count * sizeof(tuner_term_t);
+}
+
+/**
+ * Convierte una línea en una posición compacta (encabezado + términos).
+ * @param entry: recibe la posición (espacio para el encabezado y TUNER_MAX_PARAMS términos).
+ * @param engine_eval: recibe la evaluación del motor (para comparar con el modelo).
+ * @return false si la línea no es válida, la posición no es tranquila o un coeficiente no cabe en 8 bits.
+ */
+static bool encode_position(const tuner_model_t *model, const char *line, unsigned char *entry, int *engine_eval) {
+    char fen[ANALYSIS_MAX_LINE], id[ANALYSIS_MAX_ID];
+    int result;
+    if (!analysis_parse_epd(line, fen, id) || !parse_result(line, &result)) return false;
+    gamestate_t game;
+    memset(&game, 0, sizeof(gamestate_t));
+    game.en_passant_square = -1;
+    if (init_board_fen(&game, fen) != 0 || !is_quiet(&game)) return false;
+
+    eval_trace_t trace;
+    *engine_eval = evaluate_position_traced(&game, &trace);
+
+    tuner_header_t *header = (tuner_header_t *)entry;
+    tuner_term_t *terms = (tuner_term_t *)(entry + sizeof(tuner_header_t));
+    header->result = (uint8_t)result;
+    header->phase = (uint8_t)trace.phase;
+    header->term_count = 0;
+    for (int color = WHITE; color <= BLACK; color++) {
+        if (trace.king_attackers[color] > 255 || trace.king_hits[color] > 255) return false;
+        header->king_attackers[color] = (uint8_t)trace.king_attackers[color];
+        header->king_hits[color] = (uint8_t)trace.king_hits[color];
+        for (int p = 0; p < 4; p++) header->king_pieces[color][p] = (uint8_t)trace.king_pieces[color][KNIGHT + p];
+    }
+    for (int i = 0; i < model->count; i++) {
+        if (model->info[i]->taper == EVAL_TAPER_KING) continue;
+        int coef = eval_param_values(&trace.coefs, model->info[i])[model->element[i]];
+        if (coef == 0) continue;
+        if (coef < -128 || coef > 127) return false;
+        terms[header->term_count].index = (uint8_t)i;
+        terms[header->term_count].coef = (int8_t)coef;
+        header->term_count++;
+    }
+    return true;
+}
+
+static void* load_worker_main(void *arg) {
+    tuner_job_t *job = arg;
+    unsigned char entry[sizeof(tuner_header_t) + TUNER_MAX_PARAMS * sizeof(tuner_term_t)];
+    for (int i = job->first_line; i < job->last_line; i++) {
+        int engine_eval;
+        if (!encode_position(job->model, job->lines[i], entry, &engine_eval)) {
+            job->skipped++;
+            continue;
+        }
+        const tuner_header_t *header = (const tuner_header_t *)entry;
+        double model_eval = model_evaluate(job->model, job->params, header,
+                                           (const tuner_term_t *)(entry + sizeof(tuner_header_t)), NULL, 0);
+        job->eval_error += fabs(model_eval - engine_eval);
+        if (!data_append(&job->loaded, entry, entry_size(header))) job->skipped++;
+    }
+    return NULL;
+}
+
+static inline double sigmoid(double k, double score) {
+    return 1.0 / (1.0 + exp(-k * score));
+}
+
+static void* pass_worker_main(void *arg) {
+    tuner_job_t *job = arg;
+    const tuner_data_t *data = job->data;
+    job->loss = 0;
+    memset(job->grad, 0, sizeof(job->grad));
+    for (size_t b = job->first_block; b < job->last_block; b++) {
+        const unsigned char *p = data->bytes + data->blocks[b];
+        size_t count = b + 1 < data->block_count ? TUNER_BLOCK : data->count - b * TUNER_BLOCK;
+        for (size_t i = 0; i < count; i++) {
+            const tuner_header_t *header = (const tuner_header_t *)p;
+            const tuner_term_t *terms = (const tuner_term_t *)(p + sizeof(tuner_header_t));
+            p += entry_size(header);
+
+            double target = header->result / 2.0;
+            double score = model_evaluate(job->model, job->params, header, terms, NULL, 0);
+            double s = sigmoid(job->k, score);
+            job->loss += (target - s) * (target - s);
+            if (job->gradient) {
+                // d(error)/d(eval) = 2 (s - resultado) s (1 - s) k; el resto es la derivada de la evaluación
+                double factor = 2.0 * (s - target) * s * (1.0 - s) * job->k;
+                model_evaluate(job->model, job->params, header, terms, job->grad, factor);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Calcula el error medio (y opcionalmente su gradiente) sobre todas las posiciones, repartiendo los bloques entre hilos.
+ * @param k: escala de la sigmoide (en unidades naturales por centipeón).
+ * @param grad: recibe el gradiente promedio (NULL = solo el error).
+ */
+static double full_pass(const tuner_data_t *data, const tuner_model_t *model, const double *params, double k,
+                        tuner_job_t *jobs, int threads, double *grad) {
+    pthread_t thread_ids[TUNER_MAX_THREADS];
+    bool started[TUNER_MAX_THREADS];
+    size_t per_thread = (data->block_count + threads - 1) / threads;
+    for (int t = 0; t < threads; t++) {
+        tuner_job_t *job = &jobs[t];
+        job->data = data;
+        job->model = model;
+        job->params = params;
+        job->k = k;
+        job->gradient = grad != NULL;
+        job->first_block = t * per_thread < data->block_count ? t * per_thread : data->block_count;
+        job->last_block = job->first_block + per_thread < data->block_count ? job->first_block + per_thread : data->block_count;
+        // El primer rango lo calcula el hilo actual, igual que los de los hilos que no se pudieron crear
+        started[t] = t > 0 && pthread_create(&thread_ids[t], NULL, pass_worker_main, job) == 0;
+    }
+    for (int t = 0; t < threads; t++) {
+        if (!started[t]) pass_worker_main(&jobs[t]);
+    }
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) pthread_join(thread_ids[t], NULL);
+    }
+
+    double loss = 0;
+    if (grad) memset(grad, 0, model->count * sizeof(double));
+    for (int t = 0; t < threads; t++) {
+        loss += jobs[t].loss;
+        if (grad) {
+            for (int i = 0; i < model->count; i++) grad[i] += jobs[t].grad[i] / data->count;
+        }
+    }
+    return loss / data->count;
+}
+
+/**
+ * Lee el archivo de posiciones por lotes y los convierte en paralelo.
+ * @return false si no se pudo abrir el archivo o no hay memoria.
+ */
+static bool load_positions(const tuner_options_t *options, const tuner_model_t *model, const double *params,
+                           tuner_job_t *jobs, int threads, tuner_data_t *data) {
+    FILE *in = fopen(options->input_path, "r");
+    if (!in) {
+        fprintf(stderr, "[ TUNER ] No se pudo abrir %s\n", options->input_path);
+        return false;
+    }
+    char (*lines)[TUNER_MAX_LINE] = malloc(TUNER_LOAD_LINES * sizeof(*lines));
+    if (!lines) {
+        fclose(in);
+        return false;
+    }
+
+    size_t read = 0, skipped = 0;
+    double eval_error = 0;
+    bool ok = true;
+    int64_t start = platform_time_ms();
+    while (ok) {
+        int count = 0;
+        while (count < TUNER_LOAD_LINES && fgets(lines[count], TUNER_MAX_LINE, in)) count++;
+        if (count == 0) break;
+        read += count;
+
+        pthread_t thread_ids[TUNER_MAX_THREADS];
+        bool started[TUNER_MAX_THREADS];
+        int per_thread = (count + threads - 1) / threads;
+        for (int t = 0; t < threads; t++) {
+            tuner_job_t *job = &jobs[t];
+            job->model = model;
+            job->params = params;
+            job->lines = lines;
+            job->first_line = t * per_thread < count ? t * per_thread : count;
+            job->last_line = job->first_line + per_thread < count ? job->first_line + per_thread : count;
+            job->loaded.size = 0;
+            job->loaded.count = 0;
+            job->loaded.block_count = 0;
+            // Como en full_pass, el hilo actual convierte las líneas de los hilos que no se pudieron crear
+            started[t] = t > 0 && pthread_create(&thread_ids[t], NULL, load_worker_main, job) == 0;
+        }
+        for (int t = 0; t < threads; t++) {
+            if (!started[t]) load_worker_main(&jobs[t]);
+        }
+        for (int t = 1; t < threads; t++) {
+            if (started[t]) pthread_join(thread_ids[t], NULL);
+        }
+
+        // Se agregan en el orden del archivo
+        for (int t = 0; t < threads && ok; t++) {
+            const unsigned char *p = jobs[t].loaded.bytes;
+            for (size_t i = 0; i < jobs[t].loaded.count && ok; i++) {
+                size_t bytes = entry_size((const tuner_header_t *)p);
+                ok = data_append(data, p, bytes);
+                p += bytes;
+            }
+        }
+        if (count < TUNER_LOAD_LINES) break;
+    }
+    for (int t = 0; t < threads; t++) {
+        skipped += jobs[t].skipped;
+        eval_error += jobs[t].eval_error;
+        data_free(&jobs[t].loaded);
+    }
+    free(lines);
+    fclose(in);
+    if (!ok) {
+        fprintf(stderr, "[ TUNER ] No hay memoria suficiente para las posiciones\n");
+        return false;
+    }
+
+    printf("[ TUNER ] Líneas: %zu | Posiciones tranquilas: %zu | Descartadas: %zu | %.1f s\n",
+           read, data->count, skipped, (platform_time_ms() - start) / 1000.0);
+    if (data->count > 0) {
+        printf("[ TUNER ] Memoria: %.1f MB (%.1f bytes por posición) | Diferencia media con la evaluación del motor: %.2f cp\n",
+               data->size / (1024.0 * 1024.0), (double)data->size / data->count, eval_error / data->count);
+    }
+    return true;
+}
+
+/**
+ * Escala K de la sigmoide que mejor explica los resultados con los parámetros actuales (búsqueda de la sección áurea).
+ * @return K en unidades naturales por centipeón.
+ */
+static double fit_k(const tuner_data_t *data, const tuner_model_t *model, const double *params, tuner_job_t *jobs, int threads) {
+    const double ratio = (sqrt(5.0) - 1) / 2;
+    double low = 0.0001, high = 0.05;
+    double a = high - ratio * (high - low), b = low + ratio * (high - low);
+    double loss_a = full_pass(data, model, params, a, jobs, threads, NULL);
+    double loss_b = full_pass(data, model, params, b, jobs, threads, NULL);
+    for (int i = 0; i < 40; i++) {
+        if (loss_a < loss_b) {
+            high = b;
+            b = a;
+            loss_b = loss_a;
+            a = high - ratio * (high - low);
+            loss_a = full_pass(data, model, params, a, jobs, threads, NULL);
+        } else {
+            low = a;
+            a = b;
+            loss_a = loss_b;
+            b = low + ratio * (high - low);
+            loss_b = full_pass(data, model, params, b, jobs, threads, NULL);
+        }
+    }
+    return (low + high) / 2;
+}
+
+/**
+ * Ajusta los parámetros de la evaluación (partiendo de eval_params) y los escribe en options->output_path.
+ * @return false si no se pudieron leer las posiciones o escribir el archivo.
+ */
+bool tuner_run(const tuner_options_t *options) {
+    int threads = options->threads > 0 ? options->threads : platform_cpu_count();
+    if (threads > TUNER_MAX_THREADS) threads = TUNER_MAX_THREADS;
+    tuner_model_t model;
+    double params[TUNER_MAX_PARAMS];
+    model_init(&model, params);
+    tuner_job_t *jobs = calloc(threads, sizeof(tuner_job_t));
+    tuner_data_t data;
+    memset(&data, 0, sizeof(tuner_data_t));
+    if (!jobs || !load_positions(options, &model, params, jobs, threads, &data) || data.count == 0) {
+        if (jobs && data.count == 0) fprintf(stderr, "[ TUNER ] No hay posiciones para ajustar\n");
+        free(jobs);
+        data_free(&data);
+        return false;
+    }
+
+    double k = fit_k(&data, &model, params, jobs, threads);
+    int64_t start = platform_time_ms();
+    double loss = full_pass(&data, &model, params, k, jobs, threads, NULL);
+    printf("[ TUNER ] Parámetros: %d | Hilos: %d | K: %.3f | Error inicial: %.6f | Pasada: %" PRId64 " ms\n",
+           model.count, threads, k * 400 / log(10.0), loss, platform_time_ms() - start);
+
+    // Descenso de gradiente con Adam (https://arxiv.org/abs/1412.6980)
+    double grad[TUNER_MAX_PARAMS], m[TUNER_MAX_PARAMS] = {0}, v[TUNER_MAX_PARAMS] = {0};
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    start = platform_time_ms();
+    for (int iteration = 1; iteration <= options->iterations; iteration++) {
+        loss = full_pass(&data, &model, params, k, jobs, threads, grad);
+        for (int i = 0; i < model.count; i++) {
+            m[i] = beta1 * m[i] + (1 - beta1) * grad[i];
+            v[i] = beta2 * v[i] + (1 - beta2) * grad[i] * grad[i];
+            double m_hat = m[i] / (1 - pow(beta1, iteration));
+            double v_hat = v[i] / (1 - pow(beta2, iteration));
+            params[i] -= options->rate * m_hat / (sqrt(v_hat) + epsilon);
+        }
+        if (iteration % TUNER_REPORT_EVERY == 0 || iteration == options->iterations) {
+            int64_t elapsed = platform_time_ms() - start;
+            printf("[ TUNER ] Iteración %d: error %.6f | %.1f ms por pasada\n", iteration, loss, (double)elapsed / iteration);
+        }
+    }
+    loss = full_pass(&data, &model, params, k, jobs, threads, NULL);
+    printf("[ TUNER ] Error final: %.6f\n", loss);
+
+    eval_params_t tuned = eval_params;
+    for (int i = 0; i < model.count; i++) {
+        eval_param_values(&tuned, model.info[i])[model.element[i]] = (int)lround(params[i]);
+    }
+    bool saved = eval_params_save(&tuned, options->output_path);
+    if (saved) printf("[ TUNER ] Parámetros guardados en %s\n", options->output_path);
+    else fprintf(stderr, "[ TUNER ] No se pudo escribir %s\n", options->output_path);
+
+    free(jobs);
+    data_free(&data);
+    return saved;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdbool.h>
+#include "eval.h"
+
+// Ajuste de los parámetros de la evaluación con el método de Texel
+// https://www.chessprogramming.org/Texel%27s_Tuning_Method
+// Lee posiciones etiquetadas con el resultado de su partida (una por línea: FEN y "1-0", "0-1", "1/2-1/2",
+// o [1.0], [0.5], [0.0]), descarta las que no son tranquilas (jaque o capturas ganadoras pendientes) y guarda
+// de cada una solo los coeficientes de la evaluación (ver eval_trace_t) en un formato compacto. Así cada
+// evaluación es una suma de unos pocos productos y el error y su gradiente se calculan en paralelo sin volver
+// a evaluar el tablero. Se minimiza el error cuadrático medio entre el resultado y sigmoid(K * eval) con
+// descenso de gradiente (Adam) y se escriben los parámetros en un archivo que el motor carga con eval_params_load.
+
+#define TUNER_DEFAULT_ITERATIONS 300
+#define TUNER_DEFAULT_RATE 1.0      // Paso de Adam, en centipeones
+#define TUNER_MAX_LINE 512
+
+typedef struct {
+    const char *input_path;
+    const char *output_path;        // Archivo de parámetros a escribir
+    int threads;                    // 0 = todos los núcleos
+    int iterations;
+    double rate;
+} tuner_options_t;
+
+void tuner_default_options(tuner_options_t *options);
+bool tuner_run(const tuner_options_t *options);
@@ -0,0 +1,425 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "uci.h"
+#include "bot.h"
+#include "mcts.h"
+
+// Estado del motor en modo UCI
+typedef struct {
+    gamestate_t game;                       // Posición actual (comando "position")
+    uint64_t history[UCI_MAX_HISTORY];      // Claves de las posiciones anteriores a game
+    int history_count;
+    tt_t tt;
+    size_t hash_mb;
+    evalcache_t eval_cache;                 // Compartida por todos los hilos de búsqueda
+    int threads;
+    search_params_t params;                 // Opciones de la búsqueda (ej: MCTS en vez de alfa-beta)
+    // Búsqueda en curso
+    search_limits_t limits;
+    bool infinite;                          // "go infinite": bestmove solo se envía después de "stop"
+    bool pondering;                         // "go ponder": se busca en el tiempo del rival hasta "ponderhit" o "stop"
+    int64_t ponder_movetime;                // Tiempo de la jugada si llega "ponderhit"
+    bool searching;
+    atomic_bool stop;
+    pthread_t search_thread;
+    search_context_t *ctx;
+    pthread_mutex_t lock;                   // Protege la salida estándar y la espera de "stop"
+    pthread_cond_t stop_signal;
+} uci_engine_t;
+
+// Envía una línea a la interfaz. Se usa desde ambos hilos, así que la salida se protege con el lock
+static void uci_send(uci_engine_t *engine, const char *format, ...) {
+    va_list args;
+    pthread_mutex_lock(&engine->lock);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    putchar('\n');
+    fflush(stdout);
+    pthread_mutex_unlock(&engine->lock);
+}
+
+// Línea "info" al terminar cada iteración de la búsqueda
+static void uci_send_info(const search_result_t *result, void *user) {
+    uci_engine_t *engine = user;
+    char score[16];
+    char pv[MAX_PLY * 6 + 1];
+    int len = 0;
+
+    search_score_to_string(result->score, score);
+    for (int i = 0; i < result->pv_length; i++) {
+        if (i > 0) pv[len++] = ' ';
+        move_to_string(&result->pv[i], pv + len);
+        len += (int)strlen(pv + len);
+    }
+    pv[len] = '\0';
+
+    int64_t time = result->time_ms > 0 ? result->time_ms : 1;
+    uci_send(engine, "info depth %d score %s nodes %" PRIu64 " nps %" PRIu64 " hashfull %d time %" PRId64 " pv %s",
+             result->depth, score, result->nodes, result->nodes * 1000 / (uint64_t)time,
+             tt_hashfull(&engine->tt), result->time_ms, pv);
+}
+
+static void* uci_search_main(void *arg) {
+    uci_engine_t *engine = arg;
+    search_context_t *ctx = engine->ctx;
+    gamestate_t game = engine->game;
+    search_result_t result;
+
+    bool found = search_run_threads(ctx, &game, engine->threads, &result);
+    // Con MCTS se informan las simulaciones por segundo de cada hilo
+    int64_t time = result.time_ms > 0 ? result.time_ms : 1;
+    for (int i = 0; i < result.threads; i++) {
+        uci_send(engine, "info string hilo %d: %" PRIu64 " simulaciones (%" PRIu64 "/s)", i, result.thread_playouts[i],
+                 result.thread_playouts[i] * 1000 / (uint64_t)time);
+    }
+
+    // En modo infinito (o mientras se hace pondering) la interfaz espera bestmove solo después de "stop" o "ponderhit"
+    pthread_mutex_lock(&engine->lock);
+    while ((engine->infinite || engine->pondering) && !atomic_load(&engine->stop)) {
+        pthread_cond_wait(&engine->stop_signal, &engine->lock);
+    }
+    pthread_mutex_unlock(&engine->lock);
+
+    if (!found) {
+        uci_send(engine, "bestmove 0000");
+    } else if (result.pv_length > 1) {
+        char best[6], ponder[6];
+        move_to_string(&result.best_move, best);
+        move_to_string(&result.pv[1], ponder);
+        uci_send(engine, "bestmove %s ponder %s", best, ponder);
+    } else {
+        char best[6];
+        move_to_string(&result.best_move, best);
+        uci_send(engine, "bestmove %s", best);
+    }
+    return NULL;
+}
+
+// Detiene la búsqueda en curso (si existe) y espera a que el hilo termine
+static void uci_stop_search(uci_engine_t *engine) {
+    if (!engine->searching) return;
+    pthread_mutex_lock(&engine->lock);
+    atomic_store(&engine->stop, true);
+    pthread_cond_broadcast(&engine->stop_signal);
+    pthread_mutex_unlock(&engine->lock);
+    pthread_join(engine->search_thread, NULL);
+    engine->searching = false;
+}
+
+// Retorna el siguiente token separado por espacios y avanza el cursor (NULL si no quedan tokens)
+// Se usa en vez de strtok_r, que no está disponible en todos los compiladores de Windows
+static char* next_token(char **cursor) {
+    char *p = *cursor;
+    while (isspace((unsigned char)*p)) p++;
+    if (*p == '\0') return NULL;
+    char *start = p;
+    while (*p && !isspace((unsigned char)*p)) p++;
+    if (*p) *p++ = '\0';
+    *cursor = p;
+    return start;
+}
+
+// Compara el nombre de una opción sin distinguir mayúsculas (ej: "hash" == "Hash")
+static bool option_is(const char *name, const char *option) {
+    size_t len = strlen(option);
+    for (size_t i = 0; i < len; i++) {
+        if (tolower((unsigned char)name[i]) != tolower((unsigned char)option[i])) return false;
+    }
+    return name[len] == '\0' || isspace((unsigned char)name[len]);
+}
+
+// Busca entre las jugadas legales la que corresponde a la notación UCI (ej: "e2e4", "e7e8q")
+static bool uci_parse_move(gamestate_t *game, const char *str, move_t *move) {
+    move_list_t moves;
+    generate_moves(game, &moves);
+    filter_legal_moves(game, &moves);
+    for (int i = 0; i < moves.count; i++) {
+        char move_str[6];
+        move_to_string(&moves.moves[i], move_str);
+        if (strcmp(move_str, str) == 0) {
+            *move = moves.moves[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+// Hace una jugada en la posición actual, guardando la clave anterior para detectar repeticiones
+static void uci_push_move(uci_engine_t *engine, move_t *move) {
+    if (engine->history_count == UCI_MAX_HISTORY) {
+        memmove(engine->history, engine->history + 1, (UCI_MAX_HISTORY - 1) * sizeof(uint64_t));
+        engine->history_count--;
+    }
+    engine->history[engine->history_count++] = engine->game.key;
+    make_move(move, &engine->game, false);
+}
+
+static void uci_set_position(uci_engine_t *engine, const char *game_fen) {
+    memset(&engine->game, 0, sizeof(gamestate_t));
+    engine->game.en_passant_square = -1;
+    init_board_fen(&engine->game, game_fen);
+    engine->history_count = 0;
+}
+
+// position [startpos | fen <fen>] [moves <jugada1> <jugada2> ...]
+static void uci_position(uci_engine_t *engine, char *args) {
+    char *moves = strstr(args, "moves");
+    if (moves) *moves = '\0';
+
+    if (strncmp(args, "startpos", 8) == 0) {
+        uci_set_position(engine, START_FEN);
+    } else if (strncmp(args, "fen", 3) == 0) {
+        uci_set_position(engine, args + 3);
+    } else {
+        return;
+    }
+
+    if (!moves) return;
+    char *cursor = moves + 5;
+    for (char *token = next_token(&cursor); token; token = next_token(&cursor)) {
+        move_t move;
+        if (!uci_parse_move(&engine->game, token, &move)) {
+            uci_send(engine, "info string jugada ilegal: %s", token);
+            return;
+        }
+        uci_push_move(engine, &move);
+    }
+}
+
+// go [depth N] [movetime ms] [nodes N] [wtime ms] [btime ms] [winc ms] [binc ms] [movestogo N] [infinite] [ponder]
+static void uci_go(uci_engine_t *engine, char *args) {
+    int64_t time_left[2] = {0, 0};
+    int64_t increment[2] = {0, 0};
+    int moves_to_go = 0;
+    search_limits_t limits = {0};
+    bool infinite = false;
+    bool ponder = false;
+
+    char *cursor = args;
+    for (char *token = next_token(&cursor); token; token = next_token(&cursor)) {
+        char *value = NULL;
+        if (strcmp(token, "infinite") == 0 || strcmp(token, "ponder") == 0) {
+            if (token[0] == 'i') infinite = true;
+            else ponder = true;
+            continue;
+        }
+        if (!(value = next_token(&cursor))) break;
+        if (strcmp(token, "depth") == 0) limits.depth = atoi(value);
+        else if (strcmp(token, "movetime") == 0) limits.movetime_ms = atoll(value);
+        else if (strcmp(token, "nodes") == 0) limits.nodes = strtoull(value, NULL, 10);
+        else if (strcmp(token, "wtime") == 0) time_left[WHITE] = atoll(value);
+        else if (strcmp(token, "btime") == 0) time_left[BLACK] = atoll(value);
+        else if (strcmp(token, "winc") == 0) increment[WHITE] = atoll(value);
+        else if (strcmp(token, "binc") == 0) increment[BLACK] = atoll(value);
+        else if (strcmp(token, "movestogo") == 0) moves_to_go = atoi(value);
+    }
+
+    // Con reloj, el tiempo de la jugada se calcula a partir del tiempo restante (si no se entregó movetime)
+    int side = engine->game.to_move;
+    if (!infinite && limits.movetime_ms == 0 && time_left[side] > 0) {
+        limits.movetime_ms = search_time_for_move(time_left[side], increment[side], moves_to_go);
+    }
+
+    // Durante el pondering no hay límite de tiempo: el tiempo calculado se aplica al recibir "ponderhit"
+    engine->ponder_movetime = 0;
+    if (ponder) {
+        engine->ponder_movetime = limits.movetime_ms;
+        limits.movetime_ms = 0;
+    }
+
+    uci_stop_search(engine);
+    engine->limits = limits;
+    engine->infinite = infinite;
+    engine->pondering = ponder;
+    atomic_store(&engine->stop, false);
+
+    // El contexto se inicializa antes de crear el hilo, para que "ponderhit" pueda fijar el tiempo en cualquier momento
+    search_context_t *ctx = engine->ctx;
+    search_init(ctx, &engine->limits, &engine->stop);
+    ctx->params = engine->params;
+    ctx->tt = &engine->tt;
+    if (engine->eval_cache.entries) ctx->eval_cache = &engine->eval_cache;
+    ctx->history_keys = engine->history;
+    ctx->history_count = engine->history_count;
+    ctx->on_iteration = uci_send_info;
+    ctx->callback_user = engine;
+    engine->searching = pthread_create(&engine->search_thread, NULL, uci_search_main, engine) == 0;
+}
+
+// ponderhit: el rival jugó la jugada esperada, así que la búsqueda en curso pasa a ser la búsqueda normal
+static void uci_ponderhit(uci_engine_t *engine) {
+    if (!engine->searching || !engine->pondering) return;
+    pthread_mutex_lock(&engine->lock);
+    if (engine->ponder_movetime > 0) search_set_deadline(engine->ctx, engine->ponder_movetime);
+    engine->pondering = false;
+    pthread_cond_broadcast(&engine->stop_signal);
+    pthread_mutex_unlock(&engine->lock);
+}
+
+// setoption name <nombre> value <valor>
+static void uci_setoption(uci_engine_t *engine, char *args) {
+    char *name = strstr(args, "name");
+    char *value = strstr(args, "value");
+    if (!name || !value) return;
+    name += 4;
+    while (isspace((unsigned char)*name)) name++;
+    value += 5;
+    while (isspace((unsigned char)*value)) value++;
+
+    uci_stop_search(engine);
+    if (option_is(name, "Hash")) {
+        long mb = atol(value);
+        if (mb < 1) mb = 1;
+        if (mb > UCI_MAX_HASH_MB) mb = UCI_MAX_HASH_MB;
+        tt_free(&engine->tt);
+        if (!tt_init(&engine->tt, (size_t)mb)) {
+            uci_send(engine, "info string no hay memoria para %ld MB, se usan %d MB", mb, TT_DEFAULT_MB);
+            mb = TT_DEFAULT_MB;
+            tt_init(&engine->tt, TT_DEFAULT_MB);
+        }
+        engine->hash_mb = (size_t)mb;
+    } else if (option_is(name, "EvalCache")) {
+        long mb = atol(value);
+        if (mb < 1) mb = 1;
+        if (mb > EVAL_CACHE_MAX_MB) mb = EVAL_CACHE_MAX_MB;
+        evalcache_free(&engine->eval_cache);
+        if (!evalcache_init(&engine->eval_cache, (size_t)mb)) {
+            uci_send(engine, "info string no hay memoria para %ld MB, se usan %d MB", mb, EVAL_CACHE_DEFAULT_MB);
+            evalcache_init(&engine->eval_cache, EVAL_CACHE_DEFAULT_MB);
+        }
+    } else if (option_is(name, "PawnHash")) {
+        // Cada hilo de búsqueda tiene su propia tabla de peones de este tamaño
+        pawn_hash_set_size((size_t)(atol(value) > 0 ? atol(value) : 1));
+    } else if (option_is(name, "EvalFile")) {
+        // Archivo de pesos de la red neuronal; vacío = evaluación clásica
+        if (*value == '\0' || strcmp(value, "<empty>") == 0) {
+            nnue_unload();
+        } else if (!nnue_load(value)) {
+            uci_send(engine, "info string no se pudo cargar la red %s", value);
+        }
+        // Las evaluaciones guardadas son de la evaluación anterior
+        evalcache_clear(&engine->eval_cache);
+    } else if (option_is(name, "EvalParams")) {
+        // Parámetros de la evaluación clásica generados por el tuner; vacío = valores por defecto
+        if (*value == '\0' || strcmp(value, "<empty>") == 0) {
+            eval_params = eval_default_params;
+            pawn_hash_clear();
+        } else if (!eval_params_load(value)) {
+            uci_send(engine, "info string no se pudieron cargar los parámetros de %s", value);
+        }
+        evalcache_clear(&engine->eval_cache);
+    } else if (option_is(name, "TablebasePath")) {
+        // Carpeta con tablas de finales generadas con "tbgen"; vacío = sin tablas
+        if (*value == '\0' || strcmp(value, "<empty>") == 0) {
+            tb_free();
+        } else if (tb_init(value) > 0) {
+            uci_send(engine, "info string tablas de finales de hasta %d piezas", tb_max_pieces());
+        } else {
+            uci_send(engine, "info string no hay tablas de finales en %s", value);
+        }
+    } else if (option_is(name, "Threads")) {
+        int threads = atoi(value);
+        if (threads < 1) threads = 1;
+        if (threads > UCI_MAX_THREADS) threads = UCI_MAX_THREADS;
+        engine->threads = threads;
+    } else if (option_is(name, "MCTS")) {
+        // Búsqueda de árbol Monte Carlo en vez de alfa-beta (ver mcts.h)
+        engine->params.use_mcts = strcmp(value, "true") == 0;
+    } else if (option_is(name, "MCTSExploration")) {
+        engine->params.mcts_exploration = atoi(value) > 0 ? atoi(value) : 1;
+    } else if (option_is(name, "MCTSLeafDepth")) {
+        engine->params.mcts_leaf_depth = atoi(value) > 0 ? atoi(value) : 0;
+    }
+}
+
+/**
+ * Bucle del modo UCI: lee comandos de la entrada estándar hasta recibir "quit" (o fin de archivo).
+ * @return código de salida del programa.
+ */
+int uci_loop(void) {
+    uci_engine_t *engine = calloc(1, sizeof(uci_engine_t));
+    char *line = malloc(UCI_MAX_LINE);
+    if (!engine || !line) {
+        free(engine);
+        free(line);
+        return 1;
+    }
+    engine->ctx = malloc(sizeof(search_context_t));
+    engine->hash_mb = TT_DEFAULT_MB;
+    engine->threads = 1;
+    engine->params = search_default_params;
+    if (!engine->ctx || !tt_init(&engine->tt, engine->hash_mb)) {
+        free(engine->ctx);
+        free(engine);
+        free(line);
+        return 1;
+    }
+    evalcache_init(&engine->eval_cache, EVAL_CACHE_DEFAULT_MB);
+    pthread_mutex_init(&engine->lock, NULL);
+    pthread_cond_init(&engine->stop_signal, NULL);
+    uci_set_position(engine, START_FEN);
+
+    while (fgets(line, UCI_MAX_LINE, stdin)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *command = line;
+        while (isspace((unsigned char)*command)) command++;
+        char *args = command + strcspn(command, " \t");
+        if (*args) *args++ = '\0';
+        while (isspace((unsigned char)*args)) args++;
+
+        if (strcmp(command, "uci") == 0) {
+            uci_send(engine, "id name %s", UCI_ENGINE_NAME);
+            uci_send(engine, "id author %s", UCI_ENGINE_AUTHOR);
+            uci_send(engine, "option name Hash type spin default %d min 1 max %d", TT_DEFAULT_MB, UCI_MAX_HASH_MB);
+            uci_send(engine, "option name EvalCache type spin default %d min 1 max %d", EVAL_CACHE_DEFAULT_MB, EVAL_CACHE_MAX_MB);
+            uci_send(engine, "option name PawnHash type spin default %d min 1 max %d", PAWN_HASH_DEFAULT_MB, PAWN_HASH_MAX_MB);
+            uci_send(engine, "option name EvalFile type string default <empty>");
+            uci_send(engine, "option name EvalParams type string default <empty>");
+            uci_send(engine, "option name TablebasePath type string default <empty>");
+            uci_send(engine, "option name Threads type spin default 1 min 1 max %d", UCI_MAX_THREADS);
+            uci_send(engine, "option name Ponder type check default false");
+            uci_send(engine, "option name MCTS type check default false");
+            uci_send(engine, "option name MCTSExploration type spin default %d min 1 max 1000", MCTS_DEFAULT_EXPLORATION);
+            uci_send(engine, "option name MCTSLeafDepth type spin default %d min 0 max %d", MCTS_DEFAULT_LEAF_DEPTH,
+                     MAX_PLY - 2);
+            uci_send(engine, "uciok");
+        } else if (strcmp(command, "isready") == 0) {
+            uci_send(engine, "readyok");
+        } else if (strcmp(command, "ucinewgame") == 0) {
+            uci_stop_search(engine);
+            tt_clear(&engine->tt);
+            evalcache_clear(&engine->eval_cache);
+            uci_set_position(engine, START_FEN);
+        } else if (strcmp(command, "position") == 0) {
+            uci_stop_search(engine);
+            uci_position(engine, args);
+        } else if (strcmp(command, "go") == 0) {
+            uci_go(engine, args);
+        } else if (strcmp(command, "ponderhit") == 0) {
+            uci_ponderhit(engine);
+        } else if (strcmp(command, "stop") == 0) {
+            uci_stop_search(engine);
+        } else if (strcmp(command, "setoption") == 0) {
+            uci_setoption(engine, args);
+        } else if (strcmp(command, "quit") == 0) {
+            break;
+        } else if (*command) {
+            uci_send(engine, "info string comando desconocido: %s", command);
+        }
+    }
+
+    uci_stop_search(engine);
+    pthread_mutex_destroy(&engine->lock);
+    pthread_cond_destroy(&engine->stop_signal);
+    tt_free(&engine->tt);
+    evalcache_free(&engine->eval_cache);
+    free(engine->ctx);
+    free(engine);
+    free(line);
+    return 0;
+}
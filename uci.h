@@ -0,0 +1,17 @@
+#pragma once
+#include <stdio.h>
+#include <stdbool.h>
+
+// Modo UCI (Universal Chess Interface), para usar el motor desde interfaces gráficas y herramientas externas
+// https://www.chessprogramming.org/UCI
+// El hilo principal lee los comandos de la entrada estándar mientras la búsqueda corre en su propio hilo,
+// así que "stop" e "isready" se responden de inmediato incluso durante una búsqueda.
+
+#define UCI_ENGINE_NAME "FortunaChess"
+#define UCI_ENGINE_AUTHOR "Benjamin Bustos, Esteban Schanze, Isabot Sonnier"
+#define UCI_MAX_LINE 8192           // Largo máximo de un comando (position puede traer muchas jugadas)
+#define UCI_MAX_HISTORY 1024        // Posiciones anteriores que se recuerdan para detectar repeticiones
+#define UCI_MAX_THREADS 64
+#define UCI_MAX_HASH_MB 4096
+
+int uci_loop(void);
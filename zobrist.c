@@ -223,78 +223,95 @@ static uint64_t *RandomCastle    = Random64 + 768;
 static uint64_t *RandomEnPassant = Random64 + 772;
 static uint64_t *RandomTurn      = Random64 + 780;
 
-static const char *piece_names = "pPnNbBrRqQkK";
+// Índice de cada pieza en RandomPiece según PolyGlot: p=0, P=1, n=2, N=3, ..., k=10, K=11
+// Se indexa con la pieza interna (tipo | color << 3), así que no es necesario buscar caracteres
+static const int polyglot_piece_index[16] = {
+    -1, 1, 3, 5, 7, 9, 11, -1,     // Blancas: -, P, N, B, R, Q, K
+    -1, 0, 2, 4, 6, 8, 10, -1      // Negras:  -, p, n, b, r, q, k
+};
 
-uint64_t polyglot_hash(const char *fen) {
-    char board_s[73];
-    char to_move_c;
-    char castle_flags_s[5];
-    char ep_square_s[3];
-    char board[8][8];
-    char c;
-    int p, r, f, i, p_enc;
+// Clave de una pieza en una casilla (en formato 0x88)
+uint64_t zobrist_piece_key(int piece, int square) {
+    return RandomPiece[64 * polyglot_piece_index[piece] + 8 * RANK(square) + FILE(square)];
+}
+
+// Clave combinada de los derechos de enroque
+uint64_t zobrist_castling_key(int castling_rights) {
     uint64_t key = 0;
+    if (castling_rights & CASTLE_WHITE_KING)  key ^= RandomCastle[0];
+    if (castling_rights & CASTLE_WHITE_QUEEN) key ^= RandomCastle[1];
+    if (castling_rights & CASTLE_BLACK_KING)  key ^= RandomCastle[2];
+    if (castling_rights & CASTLE_BLACK_QUEEN) key ^= RandomCastle[3];
+    return key;
+}
 
-    sscanf(fen, "%72s %c %4s %2s",
-           board_s,
-           &to_move_c,
-           castle_flags_s,
-           ep_square_s);
+// Clave de la casilla en passant. PolyGlot solo la considera si hay un peón que realmente pueda capturar al paso
+uint64_t zobrist_en_passant_key(const gamestate_t *game) {
+    if (game->en_passant_square == -1) return 0;
 
-    r = 7;
-    f = 0;
-    p = 0;
-    while (p < strlen(board_s)) {
-        c = board_s[p++];
-        if (c == '/') {
-            r--;
-            f = 0;
-        } else if (c >= '1' && c <= '8') {
-            for (i = 0; i < c - '0'; i++) {
-                board[f++][r] = '-';
-            }
-        } else {
-            board[f++][r] = c;
-        }
+    int file = FILE(game->en_passant_square);
+    int rank = (game->to_move == WHITE) ? 4 : 3;
+    int pawn = MAKE_PIECE(PAWN, game->to_move);
+    if ((file > 0 && game->board[SQUARE(rank, file - 1)] == pawn) ||
+        (file < 7 && game->board[SQUARE(rank, file + 1)] == pawn)) {
+        return RandomEnPassant[file];
     }
+    return 0;
+}
+
+// Clave del turno (PolyGlot la aplica cuando mueven las blancas, así que basta con alternarla en cada jugada)
+uint64_t zobrist_turn_key(void) {
+    return RandomTurn[0];
+}
 
-    for (f = 0; f < 8; f++) {
-        for (r = 0; r < 8; r++) {
-            c = board[f][r];
-            if (c != '-') {
-                p_enc = strchr(piece_names, c) - piece_names;
-                key ^= RandomPiece[64 * p_enc + 8 * r + f];
+/**
+ * Calcula la clave Zobrist (compatible con PolyGlot) directamente desde el estado del juego,
+ * sin construir un string FEN intermedio.
+ * make_move mantiene esta misma clave de forma incremental en game->key.
+ * @param game: puntero al estado del juego.
+ * @return clave de 64 bits de la posición.
+ */
+uint64_t polyglot_hash_position(const gamestate_t *game) {
+    uint64_t key = 0;
+
+    for (int rank = 0; rank < 8; rank++) {
+        for (int file = 0; file < 8; file++) {
+            int piece = game->board[SQUARE(rank, file)];
+            if (piece != EMPTY) {
+                key ^= zobrist_piece_key(piece, SQUARE(rank, file));
             }
         }
     }
 
-    for (p = 0; p < strlen(castle_flags_s); p++) {
-        switch (castle_flags_s[p]) {
-            case 'K': key ^= RandomCastle[0]; break;
-            case 'Q': key ^= RandomCastle[1]; break;
-            case 'k': key ^= RandomCastle[2]; break;
-            case 'q': key ^= RandomCastle[3]; break;
-        }
+    key ^= zobrist_castling_key(game->castling_rights);
+    key ^= zobrist_en_passant_key(game);
+
+    if (game->to_move == WHITE) {
+        key ^= zobrist_turn_key();
     }
 
-    if (ep_square_s[0] != '-') {
-        f = ep_square_s[0] - 'a';
-        if (to_move_c == 'b') {
-            if ((f > 0 && board[f - 1][3] == 'p') ||
-                (f < 7 && board[f + 1][3] == 'p')) {
-                key ^= RandomEnPassant[f];
-            }
-        } else {
-            if ((f > 0 && board[f - 1][4] == 'P') ||
-                (f < 7 && board[f + 1][4] == 'P')) {
-                key ^= RandomEnPassant[f];
+    return key;
+}
+
+// Clave de la estructura de peones: solo las claves de los peones de ambos colores (make_move la mantiene en game->pawn_key)
+uint64_t zobrist_pawn_key(const gamestate_t *game) {
+    uint64_t key = 0;
+    for (int rank = 0; rank < 8; rank++) {
+        for (int file = 0; file < 8; file++) {
+            int piece = game->board[SQUARE(rank, file)];
+            if (piece != EMPTY && PIECE_TYPE(piece) == PAWN) {
+                key ^= zobrist_piece_key(piece, SQUARE(rank, file));
             }
         }
     }
-
-    if (to_move_c == 'w') {
-        key ^= RandomTurn[0];
-    }
-
     return key;
-}
\ No newline at end of file
+}
+
+// Versión a partir de un string FEN. Se mantiene por compatibilidad, y solo delega a polyglot_hash_position
+uint64_t polyglot_hash(const char *fen) {
+    gamestate_t game;
+    memset(&game, 0, sizeof(game));
+    game.en_passant_square = -1;
+    init_board_fen(&game, fen);
+    return polyglot_hash_position(&game);
+}
@@ -6,4 +6,10 @@
 // https://www.chessprogramming.org/Zobrist_Hashing
 
 // Funciones
+uint64_t zobrist_piece_key(int piece, int square);
+uint64_t zobrist_castling_key(int castling_rights);
+uint64_t zobrist_en_passant_key(const gamestate_t *game);
+uint64_t zobrist_turn_key(void);
+uint64_t polyglot_hash_position(const gamestate_t *game);
+uint64_t zobrist_pawn_key(const gamestate_t *game);
 uint64_t polyglot_hash(const char *fen);
\ No newline at end of file